@@ -100,7 +100,8 @@ void TemplightAction::ExecuteAction() {
     EnsureHasSema(CI);
 
     std::unique_ptr<TemplightTracer> p_t(new TemplightTracer(CI.getSema(), OutputFilename,
-      MemoryProfile, OutputInSafeMode, IgnoreSystemInst));
+      MemoryProfile, OutputInSafeMode, IgnoreSystemInst, CompressNames,
+      StreamTrace));
     p_t->readBlacklists(BlackListFilename);
     CI.getSema().TemplateInstCallbacks.push_back(std::move(p_t));
   }
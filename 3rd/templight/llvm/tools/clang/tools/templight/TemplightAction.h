@@ -50,6 +50,8 @@ public:
   unsigned OutputToStdOut : 1;
   unsigned MemoryProfile : 1;
   unsigned OutputInSafeMode : 1;
+  unsigned CompressNames : 1;
+  unsigned StreamTrace : 1;
   unsigned IgnoreSystemInst : 1;
   unsigned InteractiveDebug : 1;
   std::string OutputFilename;
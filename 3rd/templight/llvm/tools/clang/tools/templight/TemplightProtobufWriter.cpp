@@ -18,15 +18,28 @@
 
 #include <string>
 #include <cstdint>
+#include <utility>
 
 namespace clang {
 
 
-TemplightProtobufWriter::TemplightProtobufWriter(llvm::raw_ostream& aOS, int aCompressLevel) : 
-  TemplightWriter(aOS), compressionMode(aCompressLevel) { }
+TemplightProtobufWriter::TemplightProtobufWriter(llvm::raw_ostream& aOS, int aCompressLevel,
+                                                 bool aStreamTrace) : 
+  TemplightWriter(aOS), compressionMode(aCompressLevel), streamTrace(aStreamTrace) { }
+
+void TemplightProtobufWriter::streamBuffer() {
+  OutputOS << buffer;
+  OutputOS.flush();
+  buffer.clear();
+}
 
 void TemplightProtobufWriter::initialize(const std::string& aSourceName) {
   
+  if ( streamTrace ) {
+    // repeated TemplightTrace traces = 1; (as a group)
+    llvm::protobuf::saveVarInt(OutputOS, (1 << 3) | 3); // wire-type 3: Start group.
+  }
+  
   std::string hdr_contents;
   {
     llvm::raw_string_ostream OS_inner(hdr_contents);
@@ -48,11 +61,22 @@ void TemplightProtobufWriter::initialize(const std::string& aSourceName) {
   // required TemplightHeader header = 1;
   llvm::protobuf::saveString(OS, 1, hdr_contents);
   
+  if ( streamTrace ) {
+    OS.flush();
+    streamBuffer();
+  }
+  
 }
 
 void TemplightProtobufWriter::finalize() {
-  // repeated TemplightTrace traces = 1;
-  llvm::protobuf::saveString(OutputOS, 1, buffer);
+  if ( streamTrace ) {
+    streamBuffer();
+    llvm::protobuf::saveVarInt(OutputOS, (1 << 3) | 4); // wire-type 4: End group.
+    OutputOS.flush();
+  } else {
+    // repeated TemplightTrace traces = 1;
+    llvm::protobuf::saveString(OutputOS, 1, buffer);
+  }
 }
 
 std::string TemplightProtobufWriter::printEntryLocation(
@@ -232,12 +256,16 @@ std::string TemplightProtobufWriter::printTemplateName(const std::string& Name)
   switch( compressionMode ) {
     case 1: { // zlib-compressed name:
       llvm::SmallVector<char, 32> CompressedBuffer;
-      if ( llvm::zlib::compress(llvm::StringRef(Name), CompressedBuffer) ) {
+      // compress returns an Error, which is set only on failure.
+      llvm::Error CompressError = 
+        llvm::zlib::compress(llvm::StringRef(Name), CompressedBuffer);
+      if ( !CompressError ) {
         // optional bytes compressed_name = 2;
         llvm::protobuf::saveString(OS_inner, 2, 
           llvm::StringRef(CompressedBuffer.begin(), CompressedBuffer.size()));
         break;
       } // else, go to case 0:
+      llvm::consumeError(std::move(CompressError));
     }
     case 0:
       // optional string name = 1;
@@ -310,6 +338,11 @@ void TemplightProtobufWriter::printEntry(const PrintableTemplightEntryBegin& aEn
   // repeated TemplightEntry entries = 2;
   llvm::protobuf::saveString(OS, 2, oneof_contents);
   
+  if ( streamTrace ) {
+    OS.flush();
+    streamBuffer();
+  }
+  
 }
 
 void TemplightProtobufWriter::printEntry(const PrintableTemplightEntryEnd& aEntry) {
@@ -351,6 +384,11 @@ void TemplightProtobufWriter::printEntry(const PrintableTemplightEntryEnd& aEntr
   // repeated TemplightEntry entries = 2;
   llvm::protobuf::saveString(OS, 2, oneof_contents);
   
+  if ( streamTrace ) {
+    OS.flush();
+    streamBuffer();
+  }
+  
 }
 
 
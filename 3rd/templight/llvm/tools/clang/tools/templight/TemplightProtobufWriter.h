@@ -29,14 +29,21 @@ private:
   std::unordered_map< std::string, std::size_t > fileNameMap;
   std::unordered_map< std::string, std::size_t > templateNameMap;
   int compressionMode;
+  bool streamTrace;
   
   std::size_t createDictionaryEntry(const std::string& Name);
   std::string printEntryLocation(const std::string& FileName, int Line, int Column);
   std::string printTemplateName(const std::string& Name);
+  void streamBuffer();
   
 public:
   
-  TemplightProtobufWriter(llvm::raw_ostream& aOS, int aCompressLevel = 2);
+  /// \brief When aStreamTrace is set, every chunk of the trace is written
+  /// to the output as soon as it is printed. The trace is written as a
+  /// group (wire-type 3 and 4) then, since its length is not known in
+  /// advance.
+  TemplightProtobufWriter(llvm::raw_ostream& aOS, int aCompressLevel = 2,
+                          bool aStreamTrace = false);
   
   void initialize(const std::string& aSourceName = "") override;
   void finalize() override;
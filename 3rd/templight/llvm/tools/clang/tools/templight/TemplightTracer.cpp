@@ -270,7 +270,8 @@ void TemplightTracer::atTemplateEnd(const Sema &TheSema,
 TemplightTracer::TemplightTracer(const Sema &TheSema,
                                  std::string Output, 
                                  bool Memory, bool Safemode, 
-                                 bool IgnoreSystem) :
+                                 bool IgnoreSystem, bool CompressNames,
+                                 bool StreamTrace) :
                                  MemoryFlag(Memory),
                                  SafeModeFlag(Safemode) {
   
@@ -283,7 +284,10 @@ TemplightTracer::TemplightTracer(const Sema &TheSema,
     return;
   }
   
-  Printer->takeWriter(new clang::TemplightProtobufWriter(*Printer->getTraceStream()));
+  // Compression level 1 stores the names zlib-compressed, level 2 (the
+  // default) stores them in a dictionary.
+  Printer->takeWriter(new clang::TemplightProtobufWriter(
+    *Printer->getTraceStream(), CompressNames ? 1 : 2, StreamTrace));
   
 }
 
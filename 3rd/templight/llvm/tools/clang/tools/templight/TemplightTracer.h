@@ -43,7 +43,9 @@ public:
                   std::string Output = "", 
                   bool Memory = false, 
                   bool Safemode = false,
-                  bool IgnoreSystem = false);
+                  bool IgnoreSystem = false,
+                  bool CompressNames = false,
+                  bool StreamTrace = false);
   
   ~TemplightTracer() override;
   
@@ -88,6 +88,19 @@ static cl::opt<bool> OutputInSafeMode("safe-mode",
            "distort the timing profiles due to file I/O latency)."),
   cl::cat(ClangTemplightCategory));
 
+static cl::opt<bool> CompressNames("compress-names",
+  cl::desc("Store the template names zlib-compressed one by one instead \n"
+           "of collecting them in a dictionary."),
+  cl::cat(ClangTemplightCategory));
+
+static cl::opt<bool> StreamTrace("stream-trace",
+  cl::desc("Write the entries of the trace to the output as they are \n"
+           "printed, instead of writing the whole trace at the end. \n"
+           "The output can be a pipe read during the compilation \n"
+           "(use it together with -safe-mode to print every entry \n"
+           "immediately)."),
+  cl::cat(ClangTemplightCategory));
+
 static cl::opt<bool> IgnoreSystemInst("ignore-system",
   cl::desc("Ignore any template instantiation coming from \n"
            "system-includes (-isystem)."),
@@ -117,6 +130,8 @@ static cl::Option* TemplightOptions[] = {
     &OutputToStdOut,
     &MemoryProfile,
     &OutputInSafeMode,
+    &CompressNames,
+    &StreamTrace,
     &IgnoreSystemInst,
     &InstProfiler,
     &InteractiveDebug,
@@ -389,6 +404,8 @@ int ExecuteTemplightInvocation(CompilerInstance *Clang) {
   Act->OutputToStdOut = OutputToStdOut;
   Act->MemoryProfile = MemoryProfile;
   Act->OutputInSafeMode = OutputInSafeMode;
+  Act->CompressNames = CompressNames;
+  Act->StreamTrace = StreamTrace;
   Act->IgnoreSystemInst = IgnoreSystemInst;
   Act->InteractiveDebug = InteractiveDebug;
   Act->BlackListFilename = BlackListFilename;
@@ -58,6 +58,23 @@ namespace
     return {{"Boost.Wave", metashell::wave_version()},
             {readline_name, metashell::readline::version()}};
   }
+
+  const metashell::engine_entry&
+  find_engine(const std::map<std::string, metashell::engine_entry>& engines_,
+              const std::string& name_)
+  {
+    const auto eentry = engines_.find(name_);
+    if (eentry == engines_.end())
+    {
+      throw std::runtime_error(
+          "Engine " + name_ + " not found. Available engines: " +
+          boost::algorithm::join(engines_ | boost::adaptors::map_keys, ", "));
+    }
+    else
+    {
+      return eentry->second;
+    }
+  }
 }
 
 int main(int argc_, const char* argv_[])
@@ -113,28 +130,20 @@ int main(int argc_, const char* argv_[])
       create_directories(temp_dir);
       create_directories(mdb_dir);
 
+      // The engine is built by the first command needing it, but an unknown
+      // engine or a missing compiler is reported at startup.
+      find_engine(engines, r.cfg.active_shell_config().engine)
+          .check(r.cfg, det);
+
       auto shell = metashell::make_unique<metashell::shell>(
           r.cfg, ccfg.processor_queue(), shell_dir, env_filename, mdb_dir,
           // The shell should be destroyed when this scope is left, capturing
           // locals by reference should be safe.
           [&engines, &shell_dir, &temp_dir, &env_filename, &det, &ccfg,
            &logger](const metashell::data::config& config_) {
-            const auto eentry =
-                engines.find(config_.active_shell_config().engine);
-            if (eentry == engines.end())
-            {
-              throw std::runtime_error(
-                  "Engine " + config_.active_shell_config().engine +
-                  " not found. Available engines: " +
-                  boost::algorithm::join(
-                      engines | boost::adaptors::map_keys, ", "));
-            }
-            else
-            {
-              return eentry->second.build(config_, shell_dir, temp_dir,
-                                          env_filename, det, ccfg.displayer(),
-                                          &logger);
-            }
+            return find_engine(engines, config_.active_shell_config().engine)
+                .build(config_, shell_dir, temp_dir, env_filename, det,
+                       ccfg.displayer(), &logger);
           },
           &logger);
 
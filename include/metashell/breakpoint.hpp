@@ -18,6 +18,8 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include <metashell/boost/regex.hpp>
@@ -25,6 +27,7 @@
 #include <boost/optional.hpp>
 
 #include <metashell/data/frame.hpp>
+#include <metashell/data/interned_string.hpp>
 #include <metashell/data/metaprogram_node.hpp>
 
 namespace metashell
@@ -36,6 +39,8 @@ namespace metashell
     explicit breakpoint(int id, const boost::regex& name_regex);
 
     bool match(const data::metaprogram_node& node) const;
+    // The result is remembered for the interned name of the frame
+    bool match(const data::frame& frame) const;
 
     int get_id() const;
 
@@ -44,6 +49,12 @@ namespace metashell
   private:
     int id;
     boost::optional<boost::regex> name_regex;
+    // The results of matching the interned names, looked up by the identity
+    // of the names. The names are kept alive, therefore their strings are not
+    // reused by other names.
+    mutable std::unordered_map<const std::string*,
+                               std::pair<data::interned_string, bool>>
+        matched_names;
   };
 
   using breakpoints_t = std::vector<breakpoint>;
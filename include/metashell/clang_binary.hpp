@@ -18,6 +18,7 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <metashell/data/cpp_code.hpp>
+#include <metashell/data/resource_limits.hpp>
 #include <metashell/data/result.hpp>
 #include <metashell/iface/displayer.hpp>
 #include <metashell/iface/environment.hpp>
@@ -39,14 +40,16 @@ namespace metashell
   public:
     clang_binary(boost::filesystem::path clang_path_,
                  std::vector<std::string> base_args_,
-                 logger* logger_);
+                 logger* logger_,
+                 data::resource_limits limits_ = data::resource_limits());
 
     clang_binary(bool use_internal_templight_,
                  boost::filesystem::path clang_path_,
                  const std::vector<std::string>& extra_clang_args_,
                  const boost::filesystem::path& internal_dir_,
                  iface::environment_detector& env_detector_,
-                 logger* logger_);
+                 logger* logger_,
+                 data::resource_limits limits_ = data::resource_limits());
 
     virtual data::process_output run(const std::vector<std::string>& args_,
                                      const std::string& stdin_) const override;
@@ -54,12 +57,32 @@ namespace metashell
     data::result precompile(std::vector<std::string> args_,
                             const data::cpp_code& exp_) const;
 
+    // Identifies the binary and the arguments it is always run with
+    std::string id() const;
+
+    // Identifies the version of Metashell, the binary (its path, size and
+    // modification time) and the arguments it is always run with. The
+    // internal directory (which is different in every session) is replaced by
+    // a placeholder in the arguments.
+    std::string cache_key(const boost::filesystem::path& internal_dir_) const;
+
+    const boost::filesystem::path& path() const;
+    const std::vector<std::string>& base_args() const;
+
   private:
     boost::filesystem::path _clang_path;
     std::vector<std::string> _base_args;
     logger* _logger;
+    data::resource_limits _limits;
   };
 
+  // Throws when the engine arguments do not start with the path of an
+  // existing Clang binary
+  std::string extract_clang_binary(const std::vector<std::string>& engine_args_,
+                                   iface::environment_detector& env_detector_,
+                                   const std::string& metashell_path_,
+                                   const std::string& engine_name_);
+
   boost::filesystem::path
   find_clang(bool use_internal_templight_,
              const std::vector<std::string>& extra_clang_args_,
@@ -73,18 +96,34 @@ namespace metashell
                                  std::vector<std::string> clang_args_,
                                  const data::cpp_code& input_);
 
-  data::result
-  eval(const iface::environment& env_,
-       const boost::optional<data::cpp_code>& tmp_exp_,
-       const boost::optional<boost::filesystem::path>& env_path_,
-       const boost::optional<boost::filesystem::path>& templight_dump_path_,
-       clang_binary& clang_binary_);
+  // Where and in which format templight should write the trace
+  struct templight_dump
+  {
+    // templight appends ".trace.pbf" to it
+    boost::filesystem::path path;
+    // The template names are zlib compressed one by one instead of being
+    // collected in a dictionary
+    bool compress_names;
+    // Every entry is written as soon as it is available, so the trace can be
+    // read from a named pipe during the compilation
+    bool stream;
+  };
+
+  // When single_pass_ is set, the code is compiled directly. Otherwise it is
+  // preprocessed first and the preprocessed code is compiled.
+  data::result eval(const iface::environment& env_,
+                    const boost::optional<data::cpp_code>& tmp_exp_,
+                    const boost::optional<boost::filesystem::path>& env_path_,
+                    const boost::optional<templight_dump>& templight_dump_,
+                    clang_binary& clang_binary_,
+                    bool single_pass_);
 
   std::tuple<data::result, std::string> eval_with_templight_dump_on_stdout(
       const iface::environment& env_,
       const boost::optional<data::cpp_code>& tmp_exp_,
       const boost::optional<boost::filesystem::path>& env_path_,
-      clang_binary& clang_binary_);
+      clang_binary& clang_binary_,
+      bool single_pass_);
 }
 
 #endif
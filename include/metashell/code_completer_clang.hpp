@@ -24,8 +24,18 @@
 
 #include <boost/filesystem/path.hpp>
 
+#include <chrono>
+#include <memory>
+
 namespace metashell
 {
+  // Clang lists every candidate for the code before the identifier being
+  // completed. The candidates of the recent completions are remembered,
+  // therefore extending (or shortening) the identifier is answered without
+  // running Clang. When Clang does not finish within timeout_, no candidates
+  // are displayed and Clang finishes in the background. 0 means no timeout.
+  // Clang completes one piece of code at a time. Only the most recent
+  // completion waits for it, the earlier waiting ones are skipped.
   class code_completer_clang : public iface::code_completer
   {
   public:
@@ -33,6 +43,7 @@ namespace metashell
                          const boost::filesystem::path& temp_dir_,
                          const boost::filesystem::path& env_filename_,
                          clang_binary clang_binary_,
+                         std::chrono::milliseconds timeout_,
                          logger* logger_);
 
     virtual void code_complete(const iface::environment& env_,
@@ -44,7 +55,12 @@ namespace metashell
     clang_binary _clang_binary;
     boost::filesystem::path _temp_dir;
     boost::filesystem::path _env_path;
+    std::chrono::milliseconds _timeout;
     logger* _logger;
+
+    class candidate_cache;
+    // Shared by the copies of the object
+    std::shared_ptr<candidate_cache> _candidates;
   };
 }
 
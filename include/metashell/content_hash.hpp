@@ -0,0 +1,48 @@
+#ifndef METASHELL_CONTENT_HASH_HPP
+#define METASHELL_CONTENT_HASH_HPP
+
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <cstdint>
+#include <string>
+
+namespace metashell
+{
+  // Hashes a sequence of strings. The boundaries of the strings are part of
+  // the hashed content, therefore add("ab").add("c") and add("a").add("bc")
+  // give different results. It is not a cryptographic hash, it is used to
+  // name cache entries.
+  class content_hash
+  {
+  public:
+    content_hash();
+
+    content_hash& add(const std::string& s_);
+    content_hash& add(std::uint64_t n_);
+
+    // 32 hexadecimal characters
+    std::string hex() const;
+
+  private:
+    std::uint64_t _lane1;
+    std::uint64_t _lane2;
+
+    void add_bytes(const char* begin_, const char* end_);
+  };
+}
+
+#endif
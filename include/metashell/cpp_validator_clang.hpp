@@ -21,9 +21,12 @@
 
 #include <metashell/clang_binary.hpp>
 #include <metashell/logger.hpp>
+#include <metashell/precompiled_header_builder.hpp>
 
 #include <boost/filesystem/path.hpp>
 
+#include <memory>
+
 namespace metashell
 {
   class cpp_validator_clang : public iface::cpp_validator
@@ -32,6 +35,8 @@ namespace metashell
     cpp_validator_clang(const boost::filesystem::path& internal_dir_,
                         const boost::filesystem::path& env_filename_,
                         clang_binary clang_binary_,
+                        std::shared_ptr<precompiled_header_builder>
+                            precompiled_header_builder_,
                         logger* logger_);
 
     virtual data::result validate_code(const data::cpp_code& src_,
@@ -39,9 +44,16 @@ namespace metashell
                                        const iface::environment& env_,
                                        bool use_precompiled_headers_) override;
 
+    virtual data::result
+    validate_and_append(const data::cpp_code& src_,
+                        const data::config& config_,
+                        iface::environment& env_,
+                        bool use_precompiled_headers_) override;
+
   private:
     clang_binary _clang_binary;
     boost::filesystem::path _env_path;
+    std::shared_ptr<precompiled_header_builder> _precompiled_header_builder;
     logger* _logger;
   };
 }
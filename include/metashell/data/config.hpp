@@ -21,6 +21,7 @@
 #include <metashell/data/logging_mode.hpp>
 #include <metashell/data/shell_config.hpp>
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -41,6 +42,13 @@ namespace metashell
       bool splash_enabled = true;
       logging_mode log_mode = logging_mode::none;
       std::string log_file;
+      std::string cache_dir;
+      std::uintmax_t max_eval_cache_size = 256 * 1024 * 1024;
+      std::uintmax_t max_pch_cache_size = 512 * 1024 * 1024;
+      // milliseconds
+      int code_completion_timeout = 2000;
+      bool compress_template_names = false;
+      bool stream_templight_trace = false;
 
       const std::vector<shell_config>& shell_configs() const;
 
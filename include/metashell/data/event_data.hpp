@@ -21,6 +21,7 @@
 #include <metashell/data/event_kind.hpp>
 #include <metashell/data/event_name.hpp>
 #include <metashell/data/file_location.hpp>
+#include <metashell/data/interned_string.hpp>
 #include <metashell/data/timeless_event_data.hpp>
 #include <metashell/data/type.hpp>
 
@@ -65,7 +66,7 @@ namespace metashell
     relative_depth relative_depth_of(const event_data& data);
 
     event_data template_begin(event_kind kind,
-                              const type& type,
+                              const interned_string& full_name,
                               const file_location& point_of_event,
                               const file_location& source_location,
                               double timestamp);
@@ -74,6 +75,9 @@ namespace metashell
 
     event_name name(const event_data& data);
 
+    // The interned name of the template events, an empty string otherwise
+    interned_string full_name(const event_data& data);
+
     boost::optional<file_location> point_of_event(const event_data& data);
 
     boost::optional<file_location> source_location(const event_data& data);
@@ -19,6 +19,7 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <metashell/data/cpp_code.hpp>
+#include <metashell/data/interned_string.hpp>
 
 #include <ostream>
 #include <string>
@@ -35,10 +36,15 @@ namespace metashell
     {
       file_location();
       file_location(const boost::filesystem::path& name, int row, int column);
+      file_location(interned_string name, int row, int column);
 
       static file_location parse(const std::string& s_);
+      // The name of the file is interned by names_
+      static file_location parse(boost::string_view s_, string_table& names_);
 
-      boost::filesystem::path name;
+      // The file names of a trace are interned by the string_table of the
+      // trace, they can be compared using identical.
+      interned_string name;
       int row;
       int column;
     };
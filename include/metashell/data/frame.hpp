@@ -21,6 +21,7 @@
 #include <metashell/data/event_kind.hpp>
 #include <metashell/data/file_location.hpp>
 #include <metashell/data/finalisable_counter.hpp>
+#include <metashell/data/interned_string.hpp>
 #include <metashell/data/metaprogram_mode.hpp>
 #include <metashell/data/metaprogram_node.hpp>
 
@@ -53,6 +54,9 @@ namespace metashell
       frame(const event_data& event_, metaprogram_mode mode_);
 
       const data::metaprogram_node& node() const;
+      // The interned name of the node of template events, an empty string
+      // otherwise
+      const interned_string& full_name() const;
       const file_location& source_location() const;
 
       bool is_full() const;
@@ -77,6 +81,7 @@ namespace metashell
 
     private:
       metaprogram_node _node;
+      interned_string _full_name;
       file_location _source_location;
       boost::optional<file_location> _point_of_event;
       boost::optional<data::event_kind> _kind;
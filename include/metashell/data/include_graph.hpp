@@ -0,0 +1,60 @@
+#ifndef METASHELL_DATA_INCLUDE_GRAPH_HPP
+#define METASHELL_DATA_INCLUDE_GRAPH_HPP
+
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <boost/filesystem/path.hpp>
+#include <boost/operators.hpp>
+
+#include <iosfwd>
+#include <map>
+#include <set>
+
+namespace metashell
+{
+  namespace data
+  {
+    // The headers included by a piece of code and the headers they include.
+    // The code itself is represented by the empty path.
+    class include_graph : boost::equality_comparable<include_graph>
+    {
+    public:
+      void add(const boost::filesystem::path& includer_,
+               const boost::filesystem::path& header_);
+
+      void add(const include_graph& graph_);
+
+      // The headers included directly or indirectly
+      const std::set<boost::filesystem::path>& headers() const;
+
+      // The headers includer_ includes directly
+      std::set<boost::filesystem::path>
+      included_by(const boost::filesystem::path& includer_) const;
+
+      bool operator==(const include_graph& g_) const;
+
+    private:
+      std::set<boost::filesystem::path> _headers;
+      std::map<boost::filesystem::path, std::set<boost::filesystem::path>>
+          _included;
+    };
+
+    std::ostream& operator<<(std::ostream& out_, const include_graph& g_);
+  }
+}
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef METASHELL_DATA_INTERNED_STRING_HPP
+#define METASHELL_DATA_INTERNED_STRING_HPP
+
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <boost/operators.hpp>
+#include <boost/utility/string_view.hpp>
+
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+namespace metashell
+{
+  namespace data
+  {
+    // A string shared by the copies of the object. The equal strings interned
+    // by the same string_table are stored only once, therefore comparing them
+    // for equality is cheap. The string is freed with the last copy.
+    class interned_string : boost::totally_ordered<interned_string>
+    {
+    public:
+      interned_string();
+
+      // Not shared with the strings of any string_table
+      explicit interned_string(boost::string_view value_);
+
+      const std::string& value() const;
+
+      bool empty() const;
+
+    private:
+      std::shared_ptr<const std::string> _value;
+    };
+
+    std::string to_string(const interned_string& s_);
+    std::ostream& operator<<(std::ostream& o_, const interned_string& s_);
+
+    bool operator==(const interned_string& a_, const interned_string& b_);
+
+    // The strings interned by the same string_table are equal only when they
+    // are identical. Comparing them does not read the strings.
+    bool identical(const interned_string& a_, const interned_string& b_);
+    bool operator<(const interned_string& a_, const interned_string& b_);
+
+    // The strings interned while reading one trace. It is not thread-safe.
+    class string_table
+    {
+    public:
+      interned_string intern(boost::string_view s_);
+
+    private:
+      struct string_view_hash
+      {
+        std::size_t operator()(boost::string_view s_) const;
+      };
+
+      // The keys refer to the values
+      std::unordered_map<boost::string_view, interned_string, string_view_hash>
+          _strings;
+    };
+  }
+}
+
+#endif
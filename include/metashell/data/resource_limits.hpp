@@ -0,0 +1,37 @@
+#ifndef METASHELL_DATA_RESOURCE_LIMITS_HPP
+#define METASHELL_DATA_RESOURCE_LIMITS_HPP
+
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+namespace metashell
+{
+  namespace data
+  {
+    // The limits of the processes started by the engines. 0 means no limit.
+    struct resource_limits
+    {
+      // seconds
+      int wall_time = 0;
+      // seconds of CPU time
+      int cpu_time = 0;
+      // megabytes of address space
+      int memory = 0;
+    };
+  }
+}
+
+#endif
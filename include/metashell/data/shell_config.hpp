@@ -17,6 +17,7 @@
 // You should have received a copy of the GNU General Public License
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
+#include <metashell/data/resource_limits.hpp>
 #include <metashell/data/shell_config_name.hpp>
 
 #include <metashell/iface/json_writer.hpp>
@@ -37,6 +38,8 @@ namespace metashell
       bool use_precompiled_headers = false;
       std::string engine = "internal";
       bool preprocessor_mode = false;
+      bool single_pass_evaluation = true;
+      resource_limits limits;
     };
 
     void display(iface::json_writer& out_, const shell_config& cfg_);
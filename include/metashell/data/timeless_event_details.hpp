@@ -21,6 +21,7 @@
 #include <metashell/data/event_kind.hpp>
 #include <metashell/data/fields.hpp>
 #include <metashell/data/file_location.hpp>
+#include <metashell/data/interned_string.hpp>
 #include <metashell/data/token.hpp>
 #include <metashell/data/type.hpp>
 #include <metashell/data/type_or_code_or_error.hpp>
@@ -46,7 +47,7 @@ namespace metashell
       METASHELL_DATA_FIELDS(
         timeless_event_details,
 
-        ((type, full_name))
+        ((interned_string, full_name))
         ((file_location, point_of_event))
         ((file_location, source_location))
       );
@@ -76,7 +77,7 @@ namespace metashell
                             bool>::type
     is_remove_ptr(const timeless_event_details<Kind>& details_)
     {
-      return is_remove_ptr(details_.full_name);
+      return is_remove_ptr(details_.full_name.value());
     }
 
     template <event_kind Kind>
@@ -88,13 +89,31 @@ namespace metashell
       return false;
     }
 
+    template <event_kind Kind>
+    typename std::enable_if<category(Kind) == event_category::template_ &&
+                                Kind != event_kind::template_end,
+                            interned_string>::type
+    full_name(const timeless_event_details<Kind>& details_)
+    {
+      return details_.full_name;
+    }
+
+    template <event_kind Kind>
+    typename std::enable_if<category(Kind) != event_category::template_ ||
+                                Kind == event_kind::template_end,
+                            interned_string>::type
+    full_name(const timeless_event_details<Kind>&)
+    {
+      return interned_string();
+    }
+
     template <event_kind Kind>
     typename std::enable_if<category(Kind) == event_category::template_ &&
                                 Kind != event_kind::template_end,
                             boost::optional<type>>::type
     type_of(const timeless_event_details<Kind>& details_)
     {
-      return details_.full_name;
+      return type(details_.full_name.value());
     }
 
     template <event_kind Kind>
@@ -102,7 +121,7 @@ namespace metashell
                             Kind != event_kind::template_end>::type
     set_type(timeless_event_details<Kind>& details_, type type_)
     {
-      details_.full_name = std::move(type_);
+      details_.full_name = interned_string(type_.name().value());
     }
 
     template <event_kind Kind>
@@ -111,7 +130,7 @@ namespace metashell
                             type>::type
     name(const timeless_event_details<Kind>& details_)
     {
-      return details_.full_name;
+      return type(details_.full_name.value());
     }
 
     template <event_kind Kind>
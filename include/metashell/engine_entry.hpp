@@ -34,7 +34,8 @@ namespace metashell
     engine_entry(engine_factory factory_,
                  std::string args_,
                  data::markdown_string description_,
-                 std::vector<data::feature> features_);
+                 std::vector<data::feature> features_,
+                 engine_checker checker_ = engine_checker());
 
     std::unique_ptr<iface::engine>
     build(const data::config& config_,
@@ -45,6 +46,9 @@ namespace metashell
           iface::displayer& displayer_,
           logger* logger_) const;
 
+    void check(const data::config& config_,
+               iface::environment_detector& env_detector_) const;
+
     const std::string& args() const;
     const data::markdown_string& description() const;
 
@@ -52,6 +56,7 @@ namespace metashell
 
   private:
     engine_factory _factory;
+    engine_checker _checker;
     std::string _args;
     data::markdown_string _description;
     std::vector<data::feature> _features;
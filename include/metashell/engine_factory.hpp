@@ -39,6 +39,13 @@ namespace metashell
       iface::displayer&,
       logger*)>
       engine_factory;
+
+  // Checks the engine configuration without building the engine (eg. the
+  // existence of the compiler binary). It throws when the configuration is
+  // invalid.
+  typedef std::function<void(const data::config&,
+                             iface::environment_detector&)>
+      engine_checker;
 }
 
 #endif
@@ -0,0 +1,78 @@
+#ifndef METASHELL_EVAL_CACHE_HPP
+#define METASHELL_EVAL_CACHE_HPP
+
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <metashell/data/include_graph.hpp>
+#include <metashell/data/result.hpp>
+
+#include <boost/filesystem/path.hpp>
+#include <boost/optional.hpp>
+
+#include <cstdint>
+#include <string>
+
+namespace metashell
+{
+  // Evaluation results stored on disk. Every entry is a file in the cache
+  // directory named after the hash of the key of the entry. The entry contains
+  // a second, independent hash of the key (not the key, which can be large),
+  // which is compared on lookup, therefore a collision of the names is a cache
+  // miss. When the size of the entries grows over the size limit (in bytes),
+  // the least recently used entries are removed. The modification time of the files is used to
+  // track the last usage. Failing to access the cache directory is handled as
+  // a cache miss.
+  class eval_cache
+  {
+  public:
+    eval_cache(boost::filesystem::path directory_, std::uintmax_t max_size_);
+
+    // An entry is not found after one of the headers it was stored with has
+    // changed.
+    boost::optional<data::result> find(const std::string& key_);
+
+    // headers_ are the headers the result depends on and versions_ is their
+    // file_versions before the result was determined.
+    void store(const std::string& key_,
+               const data::result& result_,
+               const data::include_graph& headers_,
+               const std::string& versions_);
+    void store(const std::string& key_, const data::result& result_);
+
+    void clear();
+
+    const boost::filesystem::path& directory() const;
+    std::uintmax_t max_size() const;
+
+    int hits() const;
+    int misses() const;
+
+    int entries() const;
+    std::uintmax_t size() const;
+
+  private:
+    boost::filesystem::path _directory;
+    std::uintmax_t _max_size;
+    int _hits = 0;
+    int _misses = 0;
+
+    boost::filesystem::path entry(const std::string& key_) const;
+    void evict();
+  };
+}
+
+#endif
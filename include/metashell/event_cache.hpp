@@ -19,7 +19,7 @@
 
 #include <metashell/data/event_data.hpp>
 #include <metashell/data/list.hpp>
-#include <metashell/data/type.hpp>
+#include <metashell/data/interned_string.hpp>
 
 #include <deque>
 #include <map>
@@ -36,8 +36,8 @@ namespace metashell
     void erase_related(const data::event_data& event_);
 
   private:
-    std::map<data::type, std::vector<data::event_data>> _recorded;
-    std::vector<std::pair<data::type, int>> _recording_to;
+    std::map<data::interned_string, std::vector<data::event_data>> _recorded;
+    std::vector<std::pair<data::interned_string, int>> _recording_to;
     std::vector<data::event_data> _empty;
 
     static constexpr bool recordable(data::event_kind kind_)
@@ -0,0 +1,42 @@
+#ifndef METASHELL_FILE_VERSIONS_HPP
+#define METASHELL_FILE_VERSIONS_HPP
+
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <metashell/content_hash.hpp>
+#include <metashell/data/include_graph.hpp>
+
+#include <ctime>
+#include <string>
+
+namespace metashell
+{
+  // Adds the path, size and last modification time of the headers of
+  // graph_ to hash_. The headers that can not be found are added with their
+  // path only. It makes the hash change when one of the headers changes.
+  void add_file_versions(content_hash& hash_,
+                         const data::include_graph& graph_);
+
+  // The hash of the versions (add_file_versions) of the headers of graph_
+  std::string file_versions(const data::include_graph& graph_);
+
+  // Returns if one of the headers of graph_ has been modified after time_.
+  // The headers that can not be found are not checked.
+  bool modified_after(const data::include_graph& graph_, std::time_t time_);
+}
+
+#endif
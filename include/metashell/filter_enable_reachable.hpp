@@ -52,9 +52,10 @@ namespace metashell
               (_depth_enabled.back() ||
                (from_here(*event) && !is_remove_ptr(*event) &&
                 (kind != data::event_kind::memoization ||
-                 !trim_wrap_type(mpark::get<data::event_details<
-                                     data::event_kind::memoization>>(*event)
-                                     .what.full_name)))));
+                 !trim_wrap_type(name(mpark::get<data::event_details<
+                                          data::event_kind::memoization>>(
+                                          *event)
+                                          .what))))));
           if (_depth_enabled.back())
           {
             return event;
@@ -24,17 +24,22 @@
 #include <metashell/cached.hpp>
 #include <metashell/clang_binary.hpp>
 
+#include <boost/filesystem/path.hpp>
+
 namespace metashell
 {
   class header_discoverer_clang : public iface::header_discoverer
   {
   public:
-    explicit header_discoverer_clang(clang_binary clang_binary_);
+    // The include path is cached in cache_dir_ when it is not empty
+    header_discoverer_clang(clang_binary clang_binary_,
+                            const boost::filesystem::path& cache_dir_,
+                            const boost::filesystem::path& internal_dir_);
 
     virtual std::vector<boost::filesystem::path>
     include_path(data::include_type type_) override;
 
-    virtual std::set<boost::filesystem::path>
+    virtual data::include_graph
     files_included_by(const data::cpp_code& exp_) override;
 
   private:
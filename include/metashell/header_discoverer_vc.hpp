@@ -33,7 +33,7 @@ namespace metashell
     virtual std::vector<boost::filesystem::path>
     include_path(data::include_type type_) override;
 
-    virtual std::set<boost::filesystem::path>
+    virtual data::include_graph
     files_included_by(const data::cpp_code& exp_) override;
 
   private:
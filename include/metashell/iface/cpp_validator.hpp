@@ -39,6 +39,23 @@ namespace metashell
                                          const environment& env_,
                                          bool use_precompiled_headers_) = 0;
 
+      // Appends s_ to env_ when it is valid. The precompiled header of the
+      // extended environment may be built by the same compiler run.
+      virtual data::result
+      validate_and_append(const data::cpp_code& s_,
+                          const data::config& config_,
+                          environment& env_,
+                          bool use_precompiled_headers_)
+      {
+        const data::result r =
+            validate_code(s_ + "\n", config_, env_, use_precompiled_headers_);
+        if (r.successful)
+        {
+          env_.append(s_);
+        }
+        return r;
+      }
+
       static data::feature name_of_feature()
       {
         return data::feature::cpp_validator();
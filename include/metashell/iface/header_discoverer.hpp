@@ -19,11 +19,11 @@
 
 #include <metashell/data/cpp_code.hpp>
 #include <metashell/data/feature.hpp>
+#include <metashell/data/include_graph.hpp>
 #include <metashell/data/include_type.hpp>
 
 #include <boost/filesystem/path.hpp>
 
-#include <set>
 #include <string>
 #include <vector>
 
@@ -39,7 +39,7 @@ namespace metashell
       virtual std::vector<boost::filesystem::path>
       include_path(data::include_type type_) = 0;
 
-      virtual std::set<boost::filesystem::path>
+      virtual data::include_graph
       files_included_by(const data::cpp_code& exp_) = 0;
 
       static data::feature name_of_feature()
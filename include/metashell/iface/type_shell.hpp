@@ -43,6 +43,11 @@ namespace metashell
       virtual void
       generate_precompiled_header(const boost::filesystem::path& fn_) = 0;
 
+      // Identifies everything outside of the environment and the expression
+      // the result of the evaluation depends on (eg. the compiler and its
+      // arguments). It is empty when there is no such thing.
+      virtual std::string cache_key() = 0;
+
       static data::feature name_of_feature()
       {
         return data::feature::type_shell();
@@ -0,0 +1,76 @@
+#ifndef METASHELL_INCLUDE_GRAPH_CACHE_HPP
+#define METASHELL_INCLUDE_GRAPH_CACHE_HPP
+
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <metashell/data/cpp_code.hpp>
+#include <metashell/data/include_graph.hpp>
+#include <metashell/iface/header_discoverer.hpp>
+
+#include <functional>
+#include <list>
+#include <string>
+
+namespace metashell
+{
+  // Remembers the headers included by the recent versions of the environment.
+  // The headers included by an extended environment are determined by
+  // processing only the new code after the definitions of the macros of the
+  // earlier version and adding the headers included by the earlier version.
+  // A remembered graph is dropped when one of its headers changes on disk
+  // (eg. an include directive is added to it).
+  class include_graph_cache
+  {
+  public:
+    // Returns the code defining the macros of a piece of code
+    typedef std::function<data::cpp_code(const data::cpp_code&)>
+        macro_definitions;
+
+    explicit include_graph_cache(int max_entries_ = 16);
+
+    // The engine_ argument identifies the engine of header_discoverer_. The
+    // entries of different engines are not mixed. When definitions_ is not
+    // set, code_ is processed entirely.
+    data::include_graph
+    files_included_by(const std::string& engine_,
+                      const data::cpp_code& code_,
+                      iface::header_discoverer& header_discoverer_,
+                      const macro_definitions& definitions_);
+
+    void clear();
+
+  private:
+    struct entry
+    {
+      std::string engine;
+      data::cpp_code code;
+      data::include_graph graph;
+      // The file_versions of the headers of graph
+      std::string versions;
+    };
+
+    int _max_entries;
+    // The most recently used entry is the first one
+    std::list<entry> _entries;
+
+    void store(const std::string& engine_,
+               const data::cpp_code& code_,
+               const data::include_graph& graph_);
+  };
+}
+
+#endif
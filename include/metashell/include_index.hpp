@@ -0,0 +1,143 @@
+#ifndef METASHELL_INCLUDE_INDEX_HPP
+#define METASHELL_INCLUDE_INDEX_HPP
+
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <metashell/logger.hpp>
+
+#include <boost/filesystem/path.hpp>
+#include <boost/optional.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <ctime>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace metashell
+{
+  // Remembers the content of the directories on the include path, therefore
+  // looking headers up does not access the filesystem. The directories passed
+  // to index and their subdirectories are listed on a background thread. The
+  // other directories are listed when they are looked up for the first time.
+  //
+  // The remembered directories are watched using inotify on Linux. The
+  // directories that can not be watched (because inotify is not available or
+  // the limit of the watches has been reached) are checked for modification
+  // after every polling_interval_.
+  //
+  // When cache_dir_ is not empty, the content of the indexed directories is
+  // stored there. Later processes check only the modification date of the
+  // stored directories instead of listing them again.
+  class include_index
+  {
+  public:
+    enum class entry_type
+    {
+      file,
+      directory,
+      other
+    };
+
+    typedef std::map<std::string, entry_type> entries;
+
+    include_index(boost::filesystem::path cache_dir_,
+                  std::chrono::milliseconds polling_interval_,
+                  bool use_inotify_,
+                  logger* logger_);
+
+    include_index(const include_index&) = delete;
+    include_index& operator=(const include_index&) = delete;
+
+    ~include_index();
+
+    void index(const std::vector<boost::filesystem::path>& dirs_);
+
+    // Waits until the directories passed to index have been indexed
+    void wait();
+
+    // Returns none when path_ does not exist
+    boost::optional<entry_type> type(const boost::filesystem::path& path_);
+
+    // Returns none when dir_ is not a directory
+    boost::optional<entries> list(const boost::filesystem::path& dir_);
+
+  private:
+    struct directory
+    {
+      bool exists = false;
+      std::time_t modified = 0;
+      std::time_t listed = 0;
+      entries content;
+      // The entries that are symbolic links. They are not indexed recursively
+      std::set<std::string> links;
+    };
+
+    boost::filesystem::path _cache_dir;
+    std::chrono::milliseconds _polling_interval;
+    logger* _logger;
+
+    std::mutex _mutex;
+    std::condition_variable _changed;
+    std::map<boost::filesystem::path, directory> _directories;
+    std::vector<boost::filesystem::path> _roots;
+    std::vector<boost::filesystem::path> _pending;
+    bool _indexing = false;
+    bool _stopping = false;
+
+    // Accessed by the background thread only
+    std::set<boost::filesystem::path> _modified_roots;
+
+    int _inotify = -1;
+    int _wakeup[2] = {-1, -1};
+    std::map<int, boost::filesystem::path> _watches;
+    std::set<boost::filesystem::path> _watched;
+
+    std::thread _thread;
+
+    void run();
+    void start();
+    void wake();
+    std::vector<boost::filesystem::path>
+    wait_for_events(std::chrono::steady_clock::time_point until_);
+    std::vector<boost::filesystem::path> read_events();
+
+    directory get(const boost::filesystem::path& dir_);
+    void remember(const boost::filesystem::path& dir_, directory dir_data_);
+    void watch(const boost::filesystem::path& dir_);
+
+    // The stored content of a directory is used only when walking the
+    // directory tree reaches it. The stored directories that are not
+    // reached (eg. because they have been removed) are dropped.
+    void walk(const boost::filesystem::path& root_,
+              const std::map<boost::filesystem::path, directory>& stored_);
+    void poll();
+    void update(const boost::filesystem::path& dir_);
+
+    boost::filesystem::path
+    index_file(const boost::filesystem::path& root_) const;
+    std::map<boost::filesystem::path, directory>
+    load(const boost::filesystem::path& root_) const;
+    void store(const boost::filesystem::path& root_);
+  };
+}
+
+#endif
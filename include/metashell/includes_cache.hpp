@@ -22,9 +22,23 @@
 #include <metashell/cached.hpp>
 #include <metashell/clang_binary.hpp>
 
+#include <boost/filesystem/path.hpp>
+
 namespace metashell
 {
   cached<data::includes> includes_cache(clang_binary clang_binary_);
+
+  // When cache_dir_ is not empty, the include path is stored in its includes
+  // subdirectory and later Metashell processes read it from there instead of
+  // running the compiler. The compiler is identified by the path, size and
+  // modification date of the binary and its arguments. The internal
+  // directory is different in every Metashell process, therefore it is not
+  // part of the stored data. Failing to access the cache is handled as a
+  // cache miss.
+  cached<data::includes>
+  includes_cache(clang_binary clang_binary_,
+                 const boost::filesystem::path& cache_dir_,
+                 const boost::filesystem::path& internal_dir_);
 }
 
 #endif
@@ -21,10 +21,12 @@
 #include <metashell/iface/displayer.hpp>
 #include <metashell/iface/file_writer.hpp>
 
+#include <mutex>
 #include <string>
 
 namespace metashell
 {
+  // It can be used from multiple threads.
   class logger
   {
   public:
@@ -40,9 +42,13 @@ namespace metashell
     void log(const std::string& msg_);
 
   private:
+    mutable std::mutex _mutex;
     data::logging_mode _mode;
     iface::file_writer& _fwriter;
     iface::displayer& _displayer;
+
+    // The caller has to hold _mutex
+    void stop_logging_locked();
   };
 }
 
@@ -0,0 +1,95 @@
+#ifndef METASHELL_MACRO_CACHE_HPP
+#define METASHELL_MACRO_CACHE_HPP
+
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <metashell/data/cpp_code.hpp>
+#include <metashell/data/include_graph.hpp>
+#include <metashell/iface/environment.hpp>
+#include <metashell/iface/macro_discovery.hpp>
+
+#include <boost/filesystem/path.hpp>
+
+#include <functional>
+#include <list>
+#include <string>
+
+namespace metashell
+{
+  // Remembers the macros defined by the recent versions of the environment.
+  // The macros of an extended environment are determined by processing only
+  // the new code after the definitions of the macros of the earlier version.
+  // Note that this assumes that the new code depends only on the macros: a
+  // header using #pragma once is processed again when the new code includes
+  // it. The size and modification time of the headers included by the
+  // environment are part of the key, therefore the macros are determined
+  // again when one of the headers changes.
+  class macro_cache
+  {
+  public:
+    // Returns the headers included by a piece of code
+    typedef std::function<data::include_graph(const data::cpp_code&)>
+        included_headers;
+
+    explicit macro_cache(int max_entries_ = 16);
+
+    // The engine_ argument identifies the engine of macro_discovery_. The
+    // entries of different engines are not mixed.
+    data::cpp_code macros(const std::string& engine_,
+                          const iface::environment& env_,
+                          iface::macro_discovery& macro_discovery_,
+                          const included_headers& included_headers_);
+
+    // Code defining the macros of env_ when it is processed instead of env_.
+    // The predefined macros are changed only when env_ has changed them.
+    data::cpp_code definitions(const std::string& engine_,
+                               const iface::environment& env_,
+                               iface::macro_discovery& macro_discovery_,
+                               const included_headers& included_headers_);
+
+    void clear();
+
+  private:
+    struct entry
+    {
+      std::string engine;
+      data::cpp_code env;
+      // The file_versions of the headers included by env
+      std::string versions;
+      data::cpp_code macros;
+    };
+
+    int _max_entries;
+    // The most recently used entry is the first one
+    std::list<entry> _entries;
+
+    std::list<entry>::iterator find(const std::string& engine_,
+                                    const data::cpp_code& env_,
+                                    const std::string& versions_);
+
+    std::list<entry>::iterator
+    find_earlier_version(const std::string& engine_,
+                         const data::cpp_code& env_);
+
+    void store(const std::string& engine_,
+               const data::cpp_code& env_,
+               const std::string& versions_,
+               const data::cpp_code& macros_);
+  };
+}
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef METASHELL_MAPPED_FILE_HPP
+#define METASHELL_MAPPED_FILE_HPP
+
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <boost/filesystem/path.hpp>
+
+#include <cstddef>
+
+namespace metashell
+{
+  // A read-only view of the content of a file mapped into memory. It throws
+  // metashell::exception when the file can not be opened or mapped.
+  class mapped_file
+  {
+  public:
+    // An empty file
+    mapped_file();
+    explicit mapped_file(const boost::filesystem::path& path_);
+
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+
+    mapped_file(mapped_file&& f_);
+    mapped_file& operator=(mapped_file&& f_);
+
+    ~mapped_file();
+
+    const char* begin() const;
+    const char* end() const;
+    std::size_t size() const;
+
+  private:
+    const char* _data;
+    std::size_t _size;
+
+    void unmap();
+  };
+}
+
+#endif
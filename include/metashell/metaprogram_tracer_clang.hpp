@@ -28,7 +28,8 @@ namespace metashell
   class metaprogram_tracer_clang : public iface::metaprogram_tracer
   {
   public:
-    explicit metaprogram_tracer_clang(clang_binary clang_binary_);
+    metaprogram_tracer_clang(clang_binary clang_binary_,
+                             bool single_pass_evaluation_);
 
     virtual std::unique_ptr<iface::event_data_sequence>
     eval(iface::environment& env_,
@@ -39,6 +40,7 @@ namespace metashell
 
   private:
     clang_binary _clang_binary;
+    bool _single_pass_evaluation;
   };
 }
 
@@ -28,7 +28,14 @@ namespace metashell
   class metaprogram_tracer_templight : public iface::metaprogram_tracer
   {
   public:
-    explicit metaprogram_tracer_templight(clang_binary templight_binary_);
+    // When stream_trace_ is set, templight_binary_ has to support
+    // -stream-trace (the Templight shipped with Metashell does). The trace is
+    // read from a named pipe while the compiler is running then. It is
+    // ignored on Windows.
+    metaprogram_tracer_templight(clang_binary templight_binary_,
+                                 bool single_pass_evaluation_,
+                                 bool compress_template_names_,
+                                 bool stream_trace_);
 
     virtual std::unique_ptr<iface::event_data_sequence>
     eval(iface::environment& env_,
@@ -39,6 +46,11 @@ namespace metashell
 
   private:
     clang_binary _templight_binary;
+    bool _single_pass_evaluation;
+    bool _compress_template_names;
+    bool _stream_trace;
+    // The number of streamed traces
+    int _traces;
   };
 }
 
@@ -0,0 +1,60 @@
+#ifndef METASHELL_NAMED_PIPE_HPP
+#define METASHELL_NAMED_PIPE_HPP
+
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <boost/filesystem/path.hpp>
+
+#include <cstddef>
+
+namespace metashell
+{
+  // A named pipe (FIFO) in the file system. Other processes can open it by
+  // its path and write into it, and the data can be read while they are
+  // still running. The pipe is kept open for writing by this object as well,
+  // therefore reading it never reaches the end of file: the reader has to
+  // know when the writers have finished. The destructor removes the pipe from
+  // the file system. The constructor throws metashell::exception when the
+  // pipe can not be created. Named pipes are not supported on Windows.
+  class named_pipe
+  {
+  public:
+    explicit named_pipe(boost::filesystem::path path_);
+
+    named_pipe(const named_pipe&) = delete;
+    named_pipe& operator=(const named_pipe&) = delete;
+
+    ~named_pipe();
+
+    const boost::filesystem::path& path() const;
+
+    // Reads the data available without blocking. It returns the number of
+    // bytes read, which is 0 when there is nothing to read.
+    std::size_t read(char* buff_, std::size_t size_);
+
+    // Waits until there is data to read, but at most timeout_ms_
+    // milliseconds.
+    void wait(int timeout_ms_);
+
+  private:
+    boost::filesystem::path _path;
+    int _read_fd;
+    int _write_fd;
+  };
+}
+
+#endif
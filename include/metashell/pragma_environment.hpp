@@ -17,15 +17,16 @@
 // You should have received a copy of the GNU General Public License
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
-#include <metashell/iface/environment.hpp>
 #include <metashell/pragma_without_arguments.hpp>
 
 namespace metashell
 {
+  class shell;
+
   class pragma_environment : public pragma_without_arguments
   {
   public:
-    explicit pragma_environment(iface::environment& env_);
+    explicit pragma_environment(const shell& shell_);
 
     virtual iface::pragma_handler* clone() const override;
 
@@ -34,7 +35,7 @@ namespace metashell
     virtual void run(iface::displayer& displayer_) const override;
 
   private:
-    iface::environment& _env;
+    const shell& _shell;
   };
 }
 
@@ -17,20 +17,19 @@
 // You should have received a copy of the GNU General Public License
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
-#include <metashell/data/config.hpp>
 #include <metashell/iface/displayer.hpp>
-#include <metashell/iface/environment.hpp>
 #include <metashell/iface/pragma_handler.hpp>
 
 #include <string>
 
 namespace metashell
 {
+  class shell;
+
   class pragma_environment_save : public iface::pragma_handler
   {
   public:
-    pragma_environment_save(const data::config& config_,
-                            const iface::environment& env_);
+    explicit pragma_environment_save(const shell& shell_);
 
     virtual iface::pragma_handler* clone() const override;
 
@@ -44,8 +43,7 @@ namespace metashell
                      iface::displayer& displayer_) const override;
 
   private:
-    const data::config& _config;
-    const iface::environment& _env;
+    const shell& _shell;
   };
 }
 
@@ -0,0 +1,177 @@
+#ifndef METASHELL_PRECOMPILED_HEADER_BUILDER_HPP
+#define METASHELL_PRECOMPILED_HEADER_BUILDER_HPP
+
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <metashell/clang_binary.hpp>
+#include <metashell/data/include_graph.hpp>
+#include <metashell/data/result.hpp>
+#include <metashell/logger.hpp>
+
+#include <boost/filesystem/path.hpp>
+#include <boost/optional.hpp>
+#include <boost/system/error_code.hpp>
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace metashell
+{
+  // Builds the precompiled header of a header on a background thread. The
+  // precompiled header is built as a chain: when the header is extended, only
+  // the new code is precompiled on top of the previous precompiled header.
+  // When the chain gets too long, it is replaced by one precompiled header of
+  // the entire header.
+  //
+  // <header>.pch is removed when the header changes and is created again
+  // when the precompiled header of the latest version is ready. Until then,
+  // clang includes the header itself. A change of the header supersedes the
+  // building of the precompiled header of the previous version. A build
+  // stopped by cancelling the running compilers (Ctrl-C) is started again.
+  //
+  // The precompiled header can also be built in the caller's thread while
+  // validating the extension of the header. It is published only when the
+  // compiler accepts the extension. Otherwise the previous precompiled
+  // header remains in use.
+  //
+  // The precompiled headers of the versions of the header built so far are
+  // kept, so returning to one of them (eg. by popping the environment) does
+  // not need the compiler. The elements of the chains are named after the
+  // compiler, its arguments and the code they are built from. When the size
+  // of the elements grows over max_cache_size_, the least recently used
+  // versions are dropped. The elements are rebuilt when the size or the
+  // modification time of a header they include (according to the dependency
+  // file of clang) has changed.
+  class precompiled_header_builder
+  {
+  public:
+    precompiled_header_builder(clang_binary clang_binary_,
+                               std::uintmax_t max_cache_size_,
+                               logger* logger_);
+
+    precompiled_header_builder(const precompiled_header_builder&) = delete;
+    precompiled_header_builder&
+    operator=(const precompiled_header_builder&) = delete;
+
+    ~precompiled_header_builder();
+
+    void update(const boost::filesystem::path& header_, std::string content_);
+
+    // Waits until the precompiled header of the latest version is ready or
+    // fails to build.
+    void wait();
+
+    // Builds the precompiled header of the new content of the header in the
+    // caller's thread. The result is successful when the compiler emits no
+    // diagnostics, which are reported as the error of the result.
+    data::result precompile(const boost::filesystem::path& header_,
+                            std::string content_);
+
+  private:
+    struct job
+    {
+      boost::filesystem::path header;
+      std::string content;
+    };
+
+    struct chunk_info
+    {
+      // The size of the precompiled header and the code it is built from
+      std::uintmax_t size;
+      // The headers it includes and the element it is built on top of
+      data::include_graph headers;
+      // The version (add_file_versions) of the headers when it was built
+      std::string versions;
+    };
+
+    struct cached_chain
+    {
+      std::vector<boost::filesystem::path> chain;
+      std::uint64_t last_used;
+    };
+
+    clang_binary _clang_binary;
+    std::string _compiler_id;
+    std::uintmax_t _max_cache_size;
+    logger* _logger;
+
+    // The state of the chains. Only one thread uses it at a time: the one
+    // setting _building (the background thread or the caller of precompile)
+    // until it clears it again, or a thread holding _mutex while _building
+    // is false (update reusing an earlier chain).
+    std::string _precompiled;
+    std::vector<boost::filesystem::path> _chain;
+    // The key is the hash of the content of the header
+    std::map<std::string, cached_chain> _cache;
+    // The elements of the chains built so far
+    std::map<boost::filesystem::path, chunk_info> _chunks;
+    std::uint64_t _uses = 0;
+
+    std::mutex _mutex;
+    std::condition_variable _changed;
+    boost::optional<job> _next;
+    bool _building = false;
+    bool _stopping = false;
+
+    std::thread _thread;
+
+    void run();
+    bool build(const job& job_);
+    bool extends_chain(const std::string& content_) const;
+    bool up_to_date(const boost::filesystem::path& pch_) const;
+    data::process_output compile(const job& job_, bool report_warnings_);
+    bool reuse(const std::string& content_);
+    void remember(const std::string& content_);
+    void evict();
+  };
+
+  // The precompiled header of header_ is published as <header>.pch
+  boost::filesystem::path
+  precompiled_header_of(const boost::filesystem::path& header_);
+
+  // Creates a hard link to from_ called to_. It reports the failure in ec_.
+  using link_function =
+      std::function<void(const boost::filesystem::path& from_,
+                         const boost::filesystem::path& to_,
+                         boost::system::error_code& ec_)>;
+
+  // Replaces the published precompiled header of header_ by pch_ in one
+  // step, so the clang processes started in the meantime never see a
+  // partially written precompiled header. It is a hard link to pch_ when
+  // link_ (boost::filesystem::create_hard_link by default) can create one.
+  // Otherwise pch_ is copied.
+  void publish_precompiled_header(const boost::filesystem::path& pch_,
+                                  const boost::filesystem::path& header_);
+
+  void publish_precompiled_header(const boost::filesystem::path& pch_,
+                                  const boost::filesystem::path& header_,
+                                  const link_function& link_);
+
+  // The arguments of clang including header_. The published precompiled
+  // header is passed explicitly (-include-pch) when it exists. Otherwise the
+  // header itself is included.
+  std::vector<std::string>
+  include_precompiled(const boost::filesystem::path& header_);
+}
+
+#endif
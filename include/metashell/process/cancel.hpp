@@ -0,0 +1,31 @@
+#ifndef METASHELL_PROCESS_CANCEL_HPP
+#define METASHELL_PROCESS_CANCEL_HPP
+
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+namespace metashell
+{
+  namespace process
+  {
+    // Kills the running child processes together with the processes they
+    // have started. Waiting for them throws process::cancelled. It can be
+    // called from a signal handler. It does nothing on Windows.
+    void cancel_running_processes();
+  }
+}
+
+#endif
@@ -19,11 +19,14 @@
 
 #include <metashell/data/exit_code_t.hpp>
 #include <metashell/data/process_output.hpp>
+#include <metashell/data/resource_limits.hpp>
 
 #include <metashell/process/pipe.hpp>
 
 #include <boost/filesystem/path.hpp>
 
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -31,13 +34,19 @@ namespace metashell
 {
   namespace process
   {
+    class watchdog;
+
+    // The CPU time and memory limits are applied using setrlimit, therefore
+    // they are ignored on Windows. The process is killed when it exceeds the
+    // wall-clock time limit.
     class execution
     {
     public:
       execution(
           const boost::filesystem::path& binary_,
           const std::vector<std::string>& args_,
-          const boost::filesystem::path& cwd_ = boost::filesystem::path());
+          const boost::filesystem::path& cwd_ = boost::filesystem::path(),
+          const data::resource_limits& limits_ = data::resource_limits());
 
       execution(const execution&) = delete;
       execution& operator=(const execution&) = delete;
@@ -52,17 +61,38 @@ namespace metashell
       input_file& standard_output();
       input_file& standard_error();
 
+      // It throws process::cancelled when the process has been killed by
+      // cancel_running_processes and process::limit_exceeded when it has
+      // been killed because of exceeding the wall-clock time limit. The
+      // other limits are checked by the caller, since the output of the
+      // process may be needed to decide if the process has exceeded them.
       data::exit_code_t wait();
 
+#ifndef _WIN32
+      // The signal terminating the process or 0 when it has exited. It is
+      // available after wait.
+      int terminating_signal() const;
+
+      // The maximum resident set size (in bytes) of the process and its
+      // children it has waited for. It is available after wait.
+      std::uintmax_t max_resident_set_size() const;
+#endif
+
     private:
       pipe _standard_input;
       pipe _standard_output;
       pipe _standard_error;
+      data::resource_limits _limits;
+      std::unique_ptr<watchdog> _watchdog;
 
 #ifdef _WIN32
       PROCESS_INFORMATION _process_information;
 #else
       pid_t _pid;
+      // Handle of the process group registered for cancellation
+      int _process_group;
+      int _terminating_signal;
+      std::uintmax_t _max_resident_set_size;
 #endif
     };
   }
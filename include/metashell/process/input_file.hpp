@@ -66,6 +66,8 @@ namespace metashell
         return read(out_.data(), out_.size());
       }
 
+      size_type read(char* buf_, size_t count_);
+
       bool eof() const;
 
       iterator begin() const;
@@ -73,8 +75,6 @@ namespace metashell
 
     private:
       bool _eof;
-
-      size_type read(char* buf_, size_t count_);
     };
 
     void read_all(std::tuple<input_file&, std::string&> io1_);
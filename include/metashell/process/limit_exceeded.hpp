@@ -0,0 +1,50 @@
+#ifndef METASHELL_PROCESS_LIMIT_EXCEEDED_HPP
+#define METASHELL_PROCESS_LIMIT_EXCEEDED_HPP
+
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <metashell/process/exception.hpp>
+
+namespace metashell
+{
+  namespace process
+  {
+    enum class limit
+    {
+      wall_time,
+      cpu_time,
+      memory
+    };
+
+    // Thrown when a process is stopped because it has exceeded one of its
+    // resource limits
+    class limit_exceeded : public exception
+    {
+    public:
+      limit_exceeded(limit limit_, int value_);
+
+      limit exceeded() const;
+      int value() const;
+
+    private:
+      limit _limit;
+      int _value;
+    };
+  }
+}
+
+#endif
@@ -18,6 +18,7 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <metashell/data/process_output.hpp>
+#include <metashell/data/resource_limits.hpp>
 
 #include <boost/filesystem/path.hpp>
 
@@ -28,11 +29,15 @@ namespace metashell
 {
   namespace process
   {
+    // It throws process::limit_exceeded when the process (or the compiler a
+    // compiler driver starts, based on the crash the driver reports) exceeds
+    // one of the limits.
     data::process_output
     run(const boost::filesystem::path& binary_,
         const std::vector<std::string>& args_,
         const std::string& input_,
-        const boost::filesystem::path& cwd_ = boost::filesystem::path());
+        const boost::filesystem::path& cwd_ = boost::filesystem::path(),
+        const data::resource_limits& limits_ = data::resource_limits());
   }
 }
 
@@ -0,0 +1,129 @@
+#ifndef METASHELL_PROTOBUF_READER_HPP
+#define METASHELL_PROTOBUF_READER_HPP
+
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <boost/utility/string_view.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace metashell
+{
+  // Reads templight traces in protobuf format from a buffer (usually a mapped
+  // file) without copying it or from a stream (eg. a pipe) while it is being
+  // written. The names and file names of the last entry are views into the
+  // buffer or into the dictionaries of the reader. They are valid until the
+  // next call to next(). Truncated traces end where the truncated part starts.
+  // The zlib compressed names are decompressed when the first entry using them
+  // is read, not when the name is displayed: the debuggers filter and match
+  // the events by their names while the trace is being read, therefore every
+  // name is needed anyway. A name used by several entries is decompressed
+  // only once per trace. Traces written by templight -stream-trace (encoded as
+  // a group instead of a length-delimited field) are supported as well.
+  class protobuf_reader
+  {
+  public:
+    enum class chunk
+    {
+      end_of_file,
+      header,
+      begin_entry,
+      end_entry,
+      other
+    };
+
+    struct location
+    {
+      boost::string_view file_name;
+      int line = 0;
+      int column = 0;
+    };
+
+    struct begin_entry
+    {
+      int kind = 0;
+      boost::string_view name;
+      location point_of_instantiation;
+      location template_origin;
+      double timestamp = 0;
+      std::uint64_t memory_usage = 0;
+    };
+
+    struct end_entry
+    {
+      double timestamp = 0;
+      std::uint64_t memory_usage = 0;
+    };
+
+    // Reads up to the given number of bytes into the buffer and returns the
+    // number of bytes read. It returns 0 at the end of the stream only.
+    typedef std::function<std::size_t(char*, std::size_t)> read_function;
+
+    protobuf_reader(const char* begin_, const char* end_);
+    explicit protobuf_reader(read_function read_);
+
+    chunk next();
+
+    const begin_entry& last_begin_entry() const;
+    const end_entry& last_end_entry() const;
+
+    unsigned int version() const;
+    boost::string_view source_name() const;
+
+  private:
+    // Set when reading from a stream. _buffer holds the part of the stream
+    // that has been read but not processed yet.
+    read_function _read;
+    std::vector<char> _buffer;
+
+    const char* _current;
+    const char* _end;
+    // The end of the trace being read. nullptr when no trace is being read
+    // or when the trace being read is a group.
+    const char* _trace_end;
+    bool _in_group;
+
+    unsigned int _version;
+    std::string _source_name;
+    begin_entry _last_begin_entry;
+    end_entry _last_end_entry;
+
+    // The names are stored in deques to keep the views into them valid
+    std::deque<std::string> _file_names;
+    std::deque<std::string> _template_names;
+    // The decompressed names by their compressed form
+    std::map<std::string, std::string, std::less<>> _decompressed_names;
+
+    bool read_more();
+    chunk read_chunk();
+    void read_header(const char* end_);
+    void read_begin_entry(const char* end_);
+    void read_end_entry(const char* end_);
+    void read_template_name(const char* end_);
+    boost::string_view decompressed_name(boost::string_view compressed_);
+    void read_location(const char* end_, location& location_);
+    void read_dictionary_entry(const char* end_);
+  };
+}
+
+#endif
@@ -19,15 +19,18 @@
 
 #include <metashell/data/cpp_code.hpp>
 #include <metashell/data/event_data.hpp>
+#include <metashell/data/interned_string.hpp>
 #include <metashell/data/metaprogram_mode.hpp>
 #include <metashell/data/type_or_code_or_error.hpp>
 
-#include <templight/ProtobufReader.h>
+#include <metashell/mapped_file.hpp>
+#include <metashell/named_pipe.hpp>
+#include <metashell/protobuf_reader.hpp>
 
 #include <boost/filesystem/path.hpp>
 #include <boost/optional.hpp>
 
-#include <iosfwd>
+#include <future>
 #include <memory>
 
 namespace metashell
@@ -40,6 +43,16 @@ namespace metashell
                    data::cpp_code root_name_,
                    data::metaprogram_mode mode_);
 
+    // Reads the trace from src_ while templight is writing it. The trace ends
+    // when the evaluation has finished and everything it has written has been
+    // read. Its result is the last event. The destructor blocks until the
+    // evaluation has finished.
+    protobuf_trace(
+        std::unique_ptr<named_pipe> src_,
+        std::future<data::type_or_code_or_error> evaluation_result_,
+        data::cpp_code root_name_,
+        data::metaprogram_mode mode_);
+
     boost::optional<data::event_data> next();
 
     const data::cpp_code& root_name() const;
@@ -47,8 +60,24 @@ namespace metashell
     data::metaprogram_mode mode() const;
 
   private:
-    std::unique_ptr<std::istream> _src;
-    templight::ProtobufReader _reader;
+    struct stream
+    {
+      // Its destructor waits for the evaluation (it comes from std::async)
+      std::future<data::type_or_code_or_error> evaluation_result;
+      // It is destroyed first. When the trace has not been read till the end,
+      // templight gets EPIPE (or SIGPIPE) at its next write instead of
+      // blocking on the full pipe forever. The wait for the evaluation still
+      // lasts until then.
+      std::unique_ptr<named_pipe> src;
+    };
+
+    mapped_file _src;
+    // It is referred to by _reader. It is on the heap to make protobuf_trace
+    // movable.
+    std::unique_ptr<stream> _stream;
+    protobuf_reader _reader;
+    // The template names and file names of the trace
+    data::string_table _names;
     boost::optional<data::event_data> _evaluation_result;
     data::cpp_code _root_name;
     data::metaprogram_mode _mode;
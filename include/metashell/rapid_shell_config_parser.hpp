@@ -22,6 +22,7 @@
 
 #include <boost/optional.hpp>
 
+#include <cstdint>
 #include <functional>
 
 namespace metashell
@@ -42,6 +43,8 @@ namespace metashell
     bool key(const std::string& str_);
 
     bool Bool(bool b_);
+    bool Int(int i_);
+    bool Uint(unsigned i_);
     bool string(const std::string& str_);
 
   private:
@@ -49,6 +52,8 @@ namespace metashell
     boost::optional<data::shell_config> _config = boost::none;
     boost::optional<std::string> _key = boost::none;
     bool _in_engine_args = false;
+
+    bool integer(std::int64_t i_);
   };
 }
 
@@ -19,8 +19,13 @@
 
 #include <metashell/command_processor_queue.hpp>
 #include <metashell/data/config.hpp>
+#include <metashell/eval_cache.hpp>
+#include <metashell/include_graph_cache.hpp>
+#include <metashell/include_index.hpp>
 #include <metashell/logger.hpp>
+#include <metashell/macro_cache.hpp>
 #include <metashell/pragma_handler_map.hpp>
+#include <metashell/type_shell_lazy.hpp>
 
 #include <metashell/iface/command_processor.hpp>
 #include <metashell/iface/displayer.hpp>
@@ -31,8 +36,10 @@
 #include <boost/filesystem/path.hpp>
 #include <boost/optional.hpp>
 
+#include <exception>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <stack>
 #include <string>
@@ -108,11 +115,28 @@ namespace metashell
     void display_environment_stack_size(iface::displayer& displayer_);
     void rebuild_environment();
 
+    // The macros defined by the environment
+    data::cpp_code macros();
+
+    // The headers included by code_, which is usually the environment or an
+    // extension of it
+    data::include_graph files_included_by(const data::cpp_code& code_);
+
+    void display_cache_statistics(iface::displayer& displayer_);
+    void clear_cache();
+
+    // The resource limits of the compiler used by the active config
+    const data::resource_limits& limits() const;
+    void limits(const data::resource_limits& limits_);
+
     const data::config& get_config() const;
     data::config& get_config();
 
     iface::engine& engine();
 
+    // The content of the directories on the include path of the engines
+    include_index& include_path_index();
+
     boost::filesystem::path env_path() const;
 
     bool preprocess(iface::displayer& displayer_,
@@ -132,7 +156,11 @@ namespace metashell
     boost::filesystem::path _internal_dir;
     boost::filesystem::path _env_filename;
     std::string _line_prefix;
-    std::unique_ptr<iface::environment> _env;
+    // The type shell of the environment until the engine is built
+    std::unique_ptr<type_shell_lazy> _lazy_type_shell;
+    // Built by the first command needing it
+    mutable std::unique_ptr<iface::environment> _env;
+    mutable std::once_flag _env_built;
     data::config _config;
     std::string _prev_line;
     pragma_handler_map _pragma_handlers;
@@ -142,13 +170,28 @@ namespace metashell
     std::function<std::unique_ptr<iface::engine>(const data::config&)>
         _engine_builder;
     std::map<std::string, std::unique_ptr<iface::engine>> _engines;
+    // The errors of building the engines. They are reported by every command
+    // needing the engine without building it again.
+    std::map<std::string, std::exception_ptr> _engine_errors;
     bool _echo = false;
     bool _show_cpp_errors = true;
     bool _evaluate_metaprograms = true;
+    std::unique_ptr<eval_cache> _eval_cache;
+    macro_cache _macro_cache;
+    include_graph_cache _include_graph_cache;
+    std::unique_ptr<include_index> _include_index;
+    // The engines whose include path has been passed to _include_index
+    std::set<std::string> _indexed_engines;
 
     void init(command_processor_queue* cpq_,
               const boost::filesystem::path& mdb_temp_dir_);
     void rebuild_environment(const data::cpp_code& content_);
+    void build_environment_lazily();
+    // The environment, which is built when it is needed for the first time
+    iface::environment& built_env() const;
+    // The engine of the active config, without generating the precompiled
+    // header of an environment built lazily.
+    iface::engine& built_engine();
   };
 }
 
@@ -0,0 +1,69 @@
+#ifndef METASHELL_TEMPLIGHT_DUMP_READER_HPP
+#define METASHELL_TEMPLIGHT_DUMP_READER_HPP
+
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <boost/utility/string_view.hpp>
+
+#include <string>
+
+namespace metashell
+{
+  // Reads the YAML document stream Clang displays for -templight-dump from a
+  // buffer one entry at a time without building a node tree. Every document is
+  // a flat mapping of scalars. The values are views into the buffer or, when
+  // they need unescaping, into the reader. They are valid until the next entry
+  // is read.
+  class templight_dump_reader
+  {
+  public:
+    struct entry
+    {
+      boost::string_view name;
+      boost::string_view kind;
+      boost::string_view event;
+      boost::string_view orig;
+      boost::string_view poi;
+    };
+
+    templight_dump_reader(const char* begin_, const char* end_);
+
+    // Returns false at the end of the buffer
+    bool next();
+
+    const entry& last_entry() const;
+
+  private:
+    const char* _current;
+    const char* _end;
+
+    entry _last_entry;
+
+    // The unescaped values of the fields of the last entry
+    std::string _name;
+    std::string _kind;
+    std::string _event;
+    std::string _orig;
+    std::string _poi;
+    // The unescaped value of the last field the reader does not use
+    std::string _other;
+
+    boost::string_view* field(boost::string_view key_, std::string*& buff_);
+  };
+}
+
+#endif
@@ -0,0 +1,69 @@
+#ifndef METASHELL_TYPE_SHELL_CACHED_HPP
+#define METASHELL_TYPE_SHELL_CACHED_HPP
+
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <metashell/data/include_graph.hpp>
+#include <metashell/data/resource_limits.hpp>
+#include <metashell/eval_cache.hpp>
+#include <metashell/iface/type_shell.hpp>
+
+#include <functional>
+#include <string>
+
+namespace metashell
+{
+  // Looks the evaluation results up in a cache before evaluating them using
+  // another type shell. The key of an entry is the engine description, the
+  // limits, the use of precompiled headers, the environment and the
+  // expression. The headers the environment includes are stored with the
+  // entry together with their size and modification time: the entry is used
+  // only while they are unchanged. Only the successful results are stored:
+  // errors can be caused by something outside of the key (eg. a missing
+  // header). The headers are looked up only for the results to store.
+  class type_shell_cached : public iface::type_shell
+  {
+  public:
+    // Returns the headers included by a piece of code
+    typedef std::function<data::include_graph(const data::cpp_code&)>
+        included_headers;
+
+    type_shell_cached(iface::type_shell& type_shell_,
+                      eval_cache& cache_,
+                      std::string engine_,
+                      data::resource_limits limits_,
+                      included_headers included_headers_);
+
+    virtual data::result eval(const iface::environment& env_,
+                              const boost::optional<data::cpp_code>& tmp_exp_,
+                              bool use_precompiled_headers_) override;
+
+    virtual void
+    generate_precompiled_header(const boost::filesystem::path& fn_) override;
+
+    virtual std::string cache_key() override;
+
+  private:
+    iface::type_shell& _type_shell;
+    eval_cache& _cache;
+    std::string _engine;
+    data::resource_limits _limits;
+    included_headers _included_headers;
+  };
+}
+
+#endif
@@ -21,9 +21,13 @@
 
 #include <metashell/clang_binary.hpp>
 #include <metashell/logger.hpp>
+#include <metashell/precompiled_header_builder.hpp>
 
 #include <boost/filesystem/path.hpp>
 
+#include <memory>
+#include <string>
+
 namespace metashell
 {
   class type_shell_clang : public iface::type_shell
@@ -32,6 +36,9 @@ namespace metashell
     type_shell_clang(const boost::filesystem::path& internal_dir_,
                      const boost::filesystem::path& env_filename_,
                      clang_binary clang_binary_,
+                     bool single_pass_evaluation_,
+                     std::shared_ptr<precompiled_header_builder>
+                         precompiled_header_builder_,
                      logger* logger_);
 
     virtual data::result eval(const iface::environment& env_,
@@ -41,10 +48,18 @@ namespace metashell
     virtual void
     generate_precompiled_header(const boost::filesystem::path& fn_) override;
 
+    virtual std::string cache_key() override;
+
+    // The precompiled header is built in the background
+    void wait_for_precompiled_header();
+
   private:
     clang_binary _clang_binary;
+    boost::filesystem::path _internal_dir;
     boost::filesystem::path _env_path;
+    bool _single_pass_evaluation;
     logger* _logger;
+    std::shared_ptr<precompiled_header_builder> _precompiled_header_builder;
   };
 }
 
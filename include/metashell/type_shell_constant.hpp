@@ -33,6 +33,8 @@ namespace metashell
     virtual void
     generate_precompiled_header(const boost::filesystem::path&) override;
 
+    virtual std::string cache_key() override;
+
   private:
     data::result _result;
   };
@@ -0,0 +1,59 @@
+#ifndef METASHELL_TYPE_SHELL_LAZY_HPP
+#define METASHELL_TYPE_SHELL_LAZY_HPP
+
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <metashell/iface/type_shell.hpp>
+
+#include <boost/filesystem/path.hpp>
+#include <boost/optional.hpp>
+
+#include <functional>
+#include <string>
+
+namespace metashell
+{
+  // Gets the type shell to use only when it is needed for the first time, thus
+  // the engine providing it is not built before that. The last precompiled
+  // header requested before that is generated when the type shell is got. A
+  // null type shell means that the engine does not have one.
+  class type_shell_lazy : public iface::type_shell
+  {
+  public:
+    explicit type_shell_lazy(std::function<iface::type_shell*()> get_);
+
+    virtual data::result eval(const iface::environment& env_,
+                              const boost::optional<data::cpp_code>& tmp_exp_,
+                              bool use_precompiled_headers_) override;
+
+    virtual void
+    generate_precompiled_header(const boost::filesystem::path& fn_) override;
+
+    virtual std::string cache_key() override;
+
+    iface::type_shell* get();
+    bool got() const;
+
+  private:
+    std::function<iface::type_shell*()> _get;
+    bool _got;
+    iface::type_shell* _type_shell;
+    boost::optional<boost::filesystem::path> _precompiled_header;
+  };
+}
+
+#endif
@@ -18,6 +18,7 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <metashell/data/cpp_code.hpp>
+#include <metashell/data/resource_limits.hpp>
 #include <metashell/data/result.hpp>
 #include <metashell/iface/executable.hpp>
 #include <metashell/logger.hpp>
@@ -35,7 +36,8 @@ namespace metashell
     vc_binary(boost::filesystem::path cl_path_,
               std::vector<std::string> base_args_,
               boost::filesystem::path temp_dir_,
-              logger* logger_);
+              logger* logger_,
+              data::resource_limits limits_ = data::resource_limits());
 
     virtual data::process_output run(const std::vector<std::string>& args_,
                                      const std::string& stdin_) const override;
@@ -48,6 +50,7 @@ namespace metashell
     std::vector<std::string> _base_args;
     boost::filesystem::path _temp_dir;
     logger* _logger;
+    data::resource_limits _limits;
   };
 
   data::process_output run_vc(const vc_binary& vc_binary_,
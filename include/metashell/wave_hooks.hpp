@@ -22,6 +22,7 @@
 #include <metashell/data/counter.hpp>
 #include <metashell/data/cpp_code.hpp>
 #include <metashell/data/file_location.hpp>
+#include <metashell/data/include_graph.hpp>
 #include <metashell/data/include_argument.hpp>
 #include <metashell/data/token.hpp>
 
@@ -34,7 +35,6 @@
 #include <cassert>
 #include <functional>
 #include <iterator>
-#include <set>
 #include <sstream>
 #include <vector>
 
@@ -88,8 +88,9 @@ namespace metashell
 
     wave_hooks() : _included_files(nullptr) {}
 
-    explicit wave_hooks(std::set<boost::filesystem::path>& included_files_)
-      : _included_files(&included_files_)
+    explicit wave_hooks(data::include_graph& included_files_)
+      : _included_files(&included_files_),
+        _includers{boost::filesystem::path()}
     {
     }
 
@@ -101,7 +102,8 @@ namespace metashell
     {
       if (_included_files)
       {
-        _included_files->insert(absname_);
+        _included_files->add(_includers.back(), absname_);
+        _includers.push_back(absname_);
       }
       if (on_include_begin)
       {
@@ -123,6 +125,11 @@ namespace metashell
       }
       assert(!_include_depth.empty());
       --_include_depth;
+      if (_included_files)
+      {
+        assert(_includers.size() > 1);
+        _includers.pop_back();
+      }
     }
 
     template <typename ContextT,
@@ -319,6 +326,10 @@ namespace metashell
           on_include_end();
         }
       }
+      if (_included_files)
+      {
+        _includers.resize(1);
+      }
 
       return false;
     }
@@ -338,7 +349,8 @@ namespace metashell
     }
 
   private:
-    std::set<boost::filesystem::path>* _included_files;
+    data::include_graph* _included_files;
+    std::vector<boost::filesystem::path> _includers;
     data::file_location _last_directive_location;
     boost::optional<std::vector<std::function<void()>>> _event_queue;
     data::counter _include_depth;
@@ -19,23 +19,23 @@
 
 #include <metashell/data/cpp_code.hpp>
 #include <metashell/data/event_data.hpp>
+#include <metashell/data/interned_string.hpp>
 #include <metashell/data/metaprogram_mode.hpp>
 #include <metashell/data/type_or_code_or_error.hpp>
 
-#include <boost/optional.hpp>
+#include <metashell/templight_dump_reader.hpp>
 
-#include <yaml-cpp/node/node.h>
-#include <yaml-cpp/yaml.h>
+#include <boost/optional.hpp>
 
+#include <memory>
 #include <string>
-#include <vector>
 
 namespace metashell
 {
   class yaml_trace
   {
   public:
-    yaml_trace(const std::string& trace_,
+    yaml_trace(std::string trace_,
                data::type_or_code_or_error evaluation_result_,
                data::cpp_code root_name_,
                data::metaprogram_mode mode_);
@@ -47,8 +47,11 @@ namespace metashell
     data::metaprogram_mode mode() const;
 
   private:
-    std::vector<YAML::Node> _nodes;
-    std::vector<YAML::Node>::const_iterator _next;
+    // Shared to keep the views of the reader valid when the trace is copied
+    std::shared_ptr<const std::string> _trace;
+    templight_dump_reader _reader;
+    // The template names and file names of the trace
+    data::string_table _names;
     boost::optional<data::event_data> _evaluation_result;
     data::cpp_code _root_name;
     data::metaprogram_mode _mode;
@@ -20,6 +20,9 @@
 
 namespace
 {
+  // The number of interned names whose match results are remembered
+  const std::size_t max_matched_names = 4096;
+
   class match_visitor : public boost::static_visitor<>
   {
   public:
@@ -85,6 +88,33 @@ namespace metashell
     }
   }
 
+  bool breakpoint::match(const data::frame& frame) const
+  {
+    const data::interned_string& name = frame.full_name();
+    if (name.empty())
+    {
+      return match(frame.node());
+    }
+    else
+    {
+      const auto i = matched_names.find(&name.value());
+      if (i != matched_names.end())
+      {
+        return i->second.second;
+      }
+      else
+      {
+        if (matched_names.size() >= max_matched_names)
+        {
+          matched_names.clear();
+        }
+        const bool result = match(frame.node());
+        matched_names.emplace(&name.value(), std::make_pair(name, result));
+        return result;
+      }
+    }
+  }
+
   int breakpoint::get_id() const { return id; }
 
   std::string breakpoint::to_string() const
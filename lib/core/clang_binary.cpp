@@ -15,12 +15,17 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <metashell/clang_binary.hpp>
+#include <metashell/content_hash.hpp>
 #include <metashell/has_prefix.hpp>
 #include <metashell/metashell.hpp>
+#include <metashell/precompiled_header_builder.hpp>
 #include <metashell/process/run.hpp>
 #include <metashell/process/util.hpp>
+#include <metashell/version.hpp>
 
 #include <boost/algorithm/string/join.hpp>
+#include <boost/algorithm/string/replace.hpp>
+#include <boost/filesystem/operations.hpp>
 #include <boost/range/adaptor/sliced.hpp>
 #include <boost/range/adaptor/transformed.hpp>
 
@@ -34,39 +39,6 @@ namespace
 #include "default_clang_search_path.hpp"
   };
 
-  std::string extract_clang_binary(const std::vector<std::string>& engine_args_,
-                                   iface::environment_detector& env_detector_,
-                                   const std::string& metashell_path_,
-                                   const std::string& engine_name_)
-  {
-    if (engine_args_.empty())
-    {
-      const std::string sample_path =
-          env_detector_.on_windows() ?
-              "c:\\Program Files\\LLVM\\bin\\clang++.exe" :
-              "/usr/bin/clang++";
-      throw std::runtime_error(
-          "The engine requires that you specify the path to the clang compiler"
-          " after --. For example: " +
-          metashell_path_ + " --engine " + engine_name_ + " -- " + sample_path +
-          " -std=c++11");
-    }
-    else
-    {
-      const std::string path = engine_args_.front();
-      if (env_detector_.file_exists(path))
-      {
-        return path;
-      }
-      else
-      {
-        throw std::runtime_error(
-            "The path specified as the Clang binary to use (" + path +
-            ") does not exist.");
-      }
-    }
-  }
-
   boost::filesystem::path
   templight_shipped_with_metashell(iface::environment_detector& env_detector_)
   {
@@ -111,7 +83,8 @@ namespace
         METASHELL_LOG(logger_, "No Clang binary found.");
 
         const auto search_path_len =
-            sizeof(default_clang_search_path) / sizeof(const char*);
+            sizeof(default_clang_search_path) /
+            sizeof(default_clang_search_path[0]);
 
         displayer_.show_error(
             "clang++ not found. Checked:\n" + clang_metashell.string() + "\n" +
@@ -259,6 +232,22 @@ namespace
     return args;
   }
 
+  std::vector<std::string>
+  include_env(const boost::optional<boost::filesystem::path>& env_path_)
+  {
+    return env_path_ ? include_precompiled(*env_path_) :
+                       std::vector<std::string>{};
+  }
+
+  data::cpp_code
+  code_to_evaluate(const iface::environment& env_,
+                   const boost::optional<data::cpp_code>& tmp_exp_)
+  {
+    return tmp_exp_ ? env_.get_appended("::metashell::impl::wrap< " +
+                                        *tmp_exp_ + " > __metashell_v;\n") :
+                      env_.get();
+  }
+
   data::result
   preprocess(const iface::environment& env_,
              const boost::optional<data::cpp_code>& tmp_exp_,
@@ -266,33 +255,43 @@ namespace
              clang_binary& clang_binary_)
   {
     return clang_binary_.precompile(
-        env_path_ ? std::vector<std::string>{"-include", env_path_->string()} :
-                    std::vector<std::string>{},
-        tmp_exp_ ?
-            env_.get_appended("::metashell::impl::wrap< " + *tmp_exp_ +
-                              " > __metashell_v;\n") :
-            env_.get());
+        include_env(env_path_), code_to_evaluate(env_, tmp_exp_));
   }
 
-  std::vector<std::string> dump_ast() { return {"-Xclang", "-ast-dump"}; }
+  // Only the declaration of __metashell_v is needed, not the whole AST
+  std::vector<std::string> dump_ast()
+  {
+    return {"-Xclang", "-ast-dump", "-Xclang", "-ast-dump-filter", "-Xclang",
+            "__metashell_v"};
+  }
 
   std::vector<std::string> dump_templight_to_file(
       std::vector<std::string> clang_args_,
-      const boost::optional<boost::filesystem::path>& templight_dump_path_)
+      const boost::optional<templight_dump>& templight_dump_)
   {
-    if (templight_dump_path_)
+    if (templight_dump_)
     {
       clang_args_.push_back("-Xtemplight");
       clang_args_.push_back("-profiler");
       clang_args_.push_back("-Xtemplight");
       clang_args_.push_back("-safe-mode");
+      if (templight_dump_->compress_names)
+      {
+        clang_args_.push_back("-Xtemplight");
+        clang_args_.push_back("-compress-names");
+      }
+      if (templight_dump_->stream)
+      {
+        clang_args_.push_back("-Xtemplight");
+        clang_args_.push_back("-stream-trace");
+      }
 
       // templight can't be forced to generate output file with
       // -Xtemplight -output=<file> for some reason
       // A workaround is to specify a standard output location with -o
       // then append ".trace.pbf" to the specified file (on the calling side)
       clang_args_.push_back("-o");
-      clang_args_.push_back(templight_dump_path_->string());
+      clang_args_.push_back(templight_dump_->path.string());
     }
 
     return clang_args_;
@@ -310,33 +309,57 @@ namespace
     return run_clang(clang_binary_, clang_args_, preprocessed_code_);
   }
 
-  data::result
-  compile(const boost::optional<data::cpp_code>& tmp_exp_,
-          data::cpp_code precompiled_exp_,
-          const boost::optional<boost::filesystem::path>& templight_dump_path_,
-          clang_binary& clang_binary_)
+  // Compiles the code without preprocessing it in a separate step first
+  data::process_output
+  compile_directly(const iface::environment& env_,
+                   const boost::optional<data::cpp_code>& tmp_exp_,
+                   const boost::optional<boost::filesystem::path>& env_path_,
+                   const std::vector<std::string>& clang_args_,
+                   clang_binary& clang_binary_)
   {
-    const data::process_output output =
-        compile(std::move(precompiled_exp_),
-                dump_templight_to_file(dump_ast(), templight_dump_path_),
-                clang_binary_);
+    std::vector<std::string> args = include_env(env_path_);
+    args.insert(args.end(), clang_args_.begin(), clang_args_.end());
+    args.push_back("-c");
+    args.push_back("-x");
+    args.push_back("c++");
+
+    return run_clang(clang_binary_, args, code_to_evaluate(env_, tmp_exp_));
+  }
 
-    const bool success = output.exit_code == data::exit_code_t(0);
+  data::result to_result(const boost::optional<data::cpp_code>& tmp_exp_,
+                         const data::process_output& output_)
+  {
+    const bool success = output_.exit_code == data::exit_code_t(0);
 
     return data::result{success,
                         success && tmp_exp_ ?
-                            get_type_from_ast_string(output.standard_output) :
+                            get_type_from_ast_string(output_.standard_output) :
                             "",
-                        success ? "" : output.standard_error, ""};
+                        success ? "" : output_.standard_error, ""};
+  }
+
+  data::result
+  compile(const boost::optional<data::cpp_code>& tmp_exp_,
+          data::cpp_code precompiled_exp_,
+          const boost::optional<templight_dump>& templight_dump_,
+          clang_binary& clang_binary_)
+  {
+    return to_result(
+        tmp_exp_,
+        compile(std::move(precompiled_exp_),
+                dump_templight_to_file(dump_ast(), templight_dump_),
+                clang_binary_));
   }
 }
 
 clang_binary::clang_binary(boost::filesystem::path clang_path_,
                            std::vector<std::string> base_args_,
-                           logger* logger_)
+                           logger* logger_,
+                           data::resource_limits limits_)
   : _clang_path(std::move(clang_path_)),
     _base_args(std::move(base_args_)),
-    _logger(logger_)
+    _logger(logger_),
+    _limits(limits_)
 {
   process::quote_arguments(_base_args);
 }
@@ -346,7 +369,8 @@ clang_binary::clang_binary(bool use_internal_templight_,
                            const std::vector<std::string>& extra_clang_args_,
                            const boost::filesystem::path& internal_dir_,
                            iface::environment_detector& env_detector_,
-                           logger* logger_)
+                           logger* logger_,
+                           data::resource_limits limits_)
   : clang_binary(std::move(clang_path_),
                  clang_args(use_internal_templight_,
                             extra_clang_args_,
@@ -354,7 +378,8 @@ clang_binary::clang_binary(bool use_internal_templight_,
                             env_detector_,
                             logger_,
                             clang_path_),
-                 logger_)
+                 logger_,
+                 limits_)
 {
 }
 
@@ -370,7 +395,8 @@ data::process_output clang_binary::run(const std::vector<std::string>& args_,
   METASHELL_LOG(_logger, "Running Clang: " + _clang_path.string() + " " +
                              boost::algorithm::join(cmd, " "));
 
-  const data::process_output o = process::run(_clang_path, cmd, stdin_);
+  const data::process_output o = process::run(
+      _clang_path, cmd, stdin_, boost::filesystem::path(), _limits);
 
   METASHELL_LOG(_logger, "Clang's exit code: " + to_string(o.exit_code));
   METASHELL_LOG(_logger, "Clang's stdout: " + o.standard_output);
@@ -379,6 +405,54 @@ data::process_output clang_binary::run(const std::vector<std::string>& args_,
   return o;
 }
 
+std::string clang_binary::id() const
+{
+  content_hash h;
+  h.add(_clang_path.string()).add(_base_args.size());
+  for (const std::string& arg : _base_args)
+  {
+    h.add(arg);
+  }
+  return h.hex();
+}
+
+std::string
+clang_binary::cache_key(const boost::filesystem::path& internal_dir_) const
+{
+  const std::string internal_dir = internal_dir_.string();
+
+  content_hash h;
+  h.add(version()).add(_clang_path.string());
+
+  boost::system::error_code ec;
+  const std::uintmax_t size = boost::filesystem::file_size(_clang_path, ec);
+  if (!ec)
+  {
+    h.add(size).add(static_cast<std::uint64_t>(
+        boost::filesystem::last_write_time(_clang_path, ec)));
+  }
+
+  h.add(_base_args.size());
+  for (const std::string& arg : _base_args)
+  {
+    h.add(internal_dir.empty() ? arg :
+                                 boost::algorithm::replace_all_copy(
+                                     arg, internal_dir, "<internal>"));
+  }
+
+  return h.hex();
+}
+
+const boost::filesystem::path& clang_binary::path() const
+{
+  return _clang_path;
+}
+
+const std::vector<std::string>& clang_binary::base_args() const
+{
+  return _base_args;
+}
+
 data::result clang_binary::precompile(std::vector<std::string> args_,
                                       const data::cpp_code& exp_) const
 {
@@ -407,8 +481,25 @@ metashell::eval_with_templight_dump_on_stdout(
     const iface::environment& env_,
     const boost::optional<data::cpp_code>& tmp_exp_,
     const boost::optional<boost::filesystem::path>& env_path_,
-    clang_binary& clang_binary_)
+    clang_binary& clang_binary_,
+    bool single_pass_)
 {
+  if (single_pass_)
+  {
+    // The template trace and the AST are both displayed on the standard
+    // output, therefore they can not be requested from the same compilation.
+    const data::process_output templight_output =
+        compile_directly(env_, tmp_exp_, env_path_,
+                         {"-Xclang", "-templight-dump"}, clang_binary_);
+
+    return std::make_tuple(
+        templight_output.exit_code == data::exit_code_t(0) ?
+            to_result(tmp_exp_, compile_directly(env_, tmp_exp_, env_path_,
+                                                 dump_ast(), clang_binary_)) :
+            data::result{false, "", templight_output.standard_error, ""},
+        templight_output.standard_output);
+  }
+
   data::result precompile_result =
       preprocess(env_, tmp_exp_, env_path_, clang_binary_);
 
@@ -435,18 +526,62 @@ data::result metashell::eval(
     const iface::environment& env_,
     const boost::optional<data::cpp_code>& tmp_exp_,
     const boost::optional<boost::filesystem::path>& env_path_,
-    const boost::optional<boost::filesystem::path>& templight_dump_path_,
-    clang_binary& clang_binary_)
+    const boost::optional<templight_dump>& templight_dump_,
+    clang_binary& clang_binary_,
+    bool single_pass_)
 {
+  if (single_pass_)
+  {
+    return to_result(
+        tmp_exp_, compile_directly(
+                      env_, tmp_exp_, env_path_,
+                      dump_templight_to_file(dump_ast(), templight_dump_),
+                      clang_binary_));
+  }
+
   const data::result precompile_result =
       preprocess(env_, tmp_exp_, env_path_, clang_binary_);
 
   return precompile_result.successful ?
              compile(tmp_exp_, data::cpp_code(precompile_result.output),
-                     templight_dump_path_, clang_binary_) :
+                     templight_dump_, clang_binary_) :
              precompile_result;
 }
 
+std::string
+metashell::extract_clang_binary(const std::vector<std::string>& engine_args_,
+                                iface::environment_detector& env_detector_,
+                                const std::string& metashell_path_,
+                                const std::string& engine_name_)
+{
+  if (engine_args_.empty())
+  {
+    const std::string sample_path =
+        env_detector_.on_windows() ?
+            "c:\\Program Files\\LLVM\\bin\\clang++.exe" :
+            "/usr/bin/clang++";
+    throw std::runtime_error(
+        "The engine requires that you specify the path to the clang compiler"
+        " after --. For example: " +
+        metashell_path_ + " --engine " + engine_name_ + " -- " + sample_path +
+        " -std=c++11");
+  }
+  else
+  {
+    const std::string path = engine_args_.front();
+    if (env_detector_.file_exists(path))
+    {
+      return path;
+    }
+    else
+    {
+      throw std::runtime_error(
+          "The path specified as the Clang binary to use (" + path +
+          ") does not exist.");
+    }
+  }
+}
+
 boost::filesystem::path
 metashell::find_clang(bool use_internal_templight_,
                       const std::vector<std::string>& extra_clang_args_,
@@ -15,23 +15,43 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <metashell/code_completer_clang.hpp>
+#include <metashell/content_hash.hpp>
+#include <metashell/exception.hpp>
 
 #include <metashell/data/command.hpp>
 #include <metashell/data/token.hpp>
 #include <metashell/data/token_category.hpp>
 
 #include <metashell/for_each_line.hpp>
+#include <metashell/precompiled_header_builder.hpp>
 #include <metashell/source_position.hpp>
 #include <metashell/unsaved_file.hpp>
 
 #include <boost/algorithm/string/join.hpp>
 #include <boost/algorithm/string/predicate.hpp>
+#include <boost/filesystem.hpp>
 #include <boost/optional.hpp>
 #include <boost/range/adaptor/sliced.hpp>
 #include <boost/range/adaptor/transformed.hpp>
 
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <list>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <utility>
+#include <vector>
+
 namespace
 {
+  // The number of completions whose candidates are remembered
+  const std::size_t max_remembered_completions = 16;
+
   boost::optional<std::string> remove_prefix(const std::string& s_,
                                              const std::string& prefix_)
   {
@@ -105,20 +125,269 @@ namespace
       }
     }
   }
+
+  // The content of the file or an empty string when it can not be read
+  std::string content_of(const boost::filesystem::path& path_)
+  {
+    std::ifstream f(path_.string());
+    return std::string(
+        std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+  }
+
+  // env_header_content_ is the content of the header of the environment
+  // when the completion was started.
+  std::vector<std::string>
+  complete(const metashell::clang_binary& clang_binary_,
+           const metashell::data::unsaved_file& src_,
+           const boost::filesystem::path& env_header_,
+           const std::string& env_header_content_,
+           bool use_precompiled_headers_,
+           metashell::logger* logger_)
+  {
+    using metashell::to_string;
+
+    generate(src_);
+
+    const metashell::source_position sp =
+        metashell::source_position_of(src_.content());
+
+    std::vector<std::string> clang_args{
+        "-fsyntax-only", "-Xclang",
+        "-code-completion-at=" + src_.filename().string() + ":" +
+            to_string(sp),
+        src_.filename().string()};
+
+    if (use_precompiled_headers_)
+    {
+      const std::vector<std::string> include =
+          metashell::include_precompiled(env_header_);
+      clang_args.insert(clang_args.end(), include.begin(), include.end());
+    }
+
+    const metashell::data::process_output o = clang_binary_.run(clang_args, "");
+
+    boost::system::error_code ec;
+    boost::filesystem::remove(src_.filename(), ec);
+
+    METASHELL_LOG(logger_, "Exit code of clang: " + to_string(o.exit_code));
+
+    // The candidates of a failed run (eg. a cancelled one) are incomplete
+    if (o.exit_code != metashell::data::exit_code_t(0))
+    {
+      throw metashell::exception("Code completion failed: " + o.standard_error);
+    }
+
+    // Clang reads the environment from the disk. The candidates of a
+    // completion finishing in the background may belong to a later version
+    // of the environment.
+    if (content_of(env_header_) != env_header_content_)
+    {
+      throw metashell::exception(
+          "The environment changed during code completion");
+    }
+
+    std::vector<std::string> result;
+    metashell::for_each_line(
+        o.standard_output, [&result](const std::string& line_) {
+          if (const boost::optional<std::string> comp = parse_completion(line_))
+          {
+            result.push_back(*comp);
+          }
+        });
+    return result;
+  }
 }
 
 namespace metashell
 {
+  class code_completer_clang::candidate_cache
+  {
+  public:
+    explicit candidate_cache(logger* logger_) : _logger(logger_) {}
+
+    candidate_cache(const candidate_cache&) = delete;
+    candidate_cache& operator=(const candidate_cache&) = delete;
+
+    ~candidate_cache()
+    {
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _waiting = boost::none;
+      }
+      if (_worker.joinable())
+      {
+        _worker.join();
+      }
+    }
+
+    // key_ identifies the completed code together with the environment
+    std::vector<std::string>
+    get(const std::string& key_,
+        const std::function<std::vector<std::string>()>& complete_,
+        std::chrono::milliseconds timeout_)
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+
+      auto entry = find(key_);
+      if (entry != _entries.end())
+      {
+        METASHELL_LOG(_logger, "Using the remembered completion candidates");
+        _entries.splice(_entries.begin(), _entries, entry);
+        return _entries.front().candidates;
+      }
+
+      if (!in_progress(key_))
+      {
+        if (_waiting)
+        {
+          METASHELL_LOG(_logger, "Skipping a superseded code completion");
+        }
+        _waiting = job{key_, complete_};
+        if (_error && _error->first == key_)
+        {
+          _error = boost::none;
+        }
+        start_worker();
+        // The one waiting for the superseded completion gives up
+        _finished.notify_all();
+      }
+
+      const auto finished = [this, &key_] { return !in_progress(key_); };
+      if (timeout_.count() == 0)
+      {
+        _finished.wait(lock, finished);
+      }
+      else if (!_finished.wait_for(lock, timeout_, finished))
+      {
+        // The candidates of other versions of the environment can be wrong
+        METASHELL_LOG(_logger, "Code completion timed out, it continues in "
+                               "the background.");
+        return std::vector<std::string>();
+      }
+
+      if (_error && _error->first == key_)
+      {
+        const std::exception_ptr e = _error->second;
+        _error = boost::none;
+        std::rethrow_exception(e);
+      }
+
+      entry = find(key_);
+      return entry == _entries.end() ? std::vector<std::string>() :
+                                       entry->candidates;
+    }
+
+  private:
+    struct remembered
+    {
+      std::string key;
+      std::vector<std::string> candidates;
+    };
+
+    struct job
+    {
+      std::string key;
+      std::function<std::vector<std::string>()> complete;
+    };
+
+    logger* _logger;
+
+    std::mutex _mutex;
+    std::condition_variable _finished;
+    // The most recently used one is the first one
+    std::list<remembered> _entries;
+    // Only one completion runs at a time and only the most recent one waits
+    // for it. The waiting one is replaced by a new completion.
+    boost::optional<std::string> _running;
+    boost::optional<job> _waiting;
+    boost::optional<std::pair<std::string, std::exception_ptr>> _error;
+    std::thread _worker;
+    bool _worker_running = false;
+
+    // Assumes that _mutex is locked
+    bool in_progress(const std::string& key_) const
+    {
+      return (_running && *_running == key_) ||
+             (_waiting && _waiting->key == key_);
+    }
+
+    // Assumes that _mutex is locked. A finished worker does not lock it
+    // again.
+    void start_worker()
+    {
+      if (!_worker_running)
+      {
+        if (_worker.joinable())
+        {
+          _worker.join();
+        }
+        _worker_running = true;
+        _worker = std::thread([this] { work(); });
+      }
+    }
+
+    void work()
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      while (_waiting)
+      {
+        const job next = std::move(*_waiting);
+        _waiting = boost::none;
+        _running = next.key;
+        lock.unlock();
+
+        std::vector<std::string> candidates;
+        std::exception_ptr error;
+        try
+        {
+          candidates = next.complete();
+        }
+        catch (...)
+        {
+          error = std::current_exception();
+        }
+
+        lock.lock();
+        _running = boost::none;
+        if (error)
+        {
+          _error = std::make_pair(next.key, error);
+        }
+        else
+        {
+          _entries.push_front(remembered{next.key, std::move(candidates)});
+          if (_entries.size() > max_remembered_completions)
+          {
+            _entries.pop_back();
+          }
+        }
+        _finished.notify_all();
+      }
+      _worker_running = false;
+    }
+
+    // Assumes that _mutex is locked
+    std::list<remembered>::iterator find(const std::string& key_)
+    {
+      return std::find_if(
+          _entries.begin(), _entries.end(),
+          [&key_](const remembered& e_) { return e_.key == key_; });
+    }
+  };
+
   code_completer_clang::code_completer_clang(
       const boost::filesystem::path& internal_dir_,
       const boost::filesystem::path& temp_dir_,
       const boost::filesystem::path& env_filename_,
       clang_binary clang_binary_,
+      std::chrono::milliseconds timeout_,
       logger* logger_)
     : _clang_binary(clang_binary_),
       _temp_dir(temp_dir_),
       _env_path(internal_dir_ / env_filename_),
-      _logger(logger_)
+      _timeout(timeout_),
+      _logger(logger_),
+      _candidates(std::make_shared<candidate_cache>(logger_))
   {
   }
 
@@ -140,42 +409,40 @@ namespace metashell
     METASHELL_LOG(
         _logger, "Part kept for code completion: " + completion_start.first);
 
-    const data::unsaved_file src(
-        _temp_dir / "code_complete.cpp",
-        env_.get_appended(data::cpp_code(completion_start.first)).value());
-
-    generate(src);
+    const std::string code =
+        env_.get_appended(data::cpp_code(completion_start.first)).value();
+    // The code may refer to the environment only by including it
+    const std::string key = content_hash()
+                                .add(use_precompiled_headers_ ? "pch" : "")
+                                .add(env_.get_all().value())
+                                .add(completion_start.first)
+                                .hex();
 
-    const source_position sp = source_position_of(src.content());
+    // The completions run one after the other
+    const data::unsaved_file src(_temp_dir / "code_complete.cpp", code);
+    const std::string env_header_content = content_of(_env_path);
 
-    std::vector<std::string> clang_args{
-        "-fsyntax-only", "-Xclang",
-        "-code-completion-at=" + src.filename().string() + ":" + to_string(sp),
-        src.filename().string()};
+    const clang_binary cbin = _clang_binary;
+    const boost::filesystem::path env_path = _env_path;
+    logger* const log = _logger;
+    const std::vector<std::string> candidates = _candidates->get(
+        key,
+        [cbin, src, env_path, env_header_content, use_precompiled_headers_,
+         log] {
+          return complete(cbin, src, env_path, env_header_content,
+                          use_precompiled_headers_, log);
+        },
+        _timeout);
 
-    if (use_precompiled_headers_)
-    {
-      clang_args.push_back("-include");
-      clang_args.push_back(_env_path.string());
-    }
-
-    const data::process_output o = _clang_binary.run(clang_args, "");
-
-    METASHELL_LOG(_logger, "Exit code of clang: " + to_string(o.exit_code));
-
-    const std::string out = o.standard_output;
     out_.clear();
     const int prefix_len = completion_start.second.length();
-    for_each_line(
-        out, [&out_, &completion_start, prefix_len](const std::string& line_) {
-          if (const boost::optional<std::string> comp = parse_completion(line_))
-          {
-            if (starts_with(*comp, completion_start.second) &&
-                *comp != completion_start.second)
-            {
-              out_.insert(string(comp->begin() + prefix_len, comp->end()));
-            }
-          }
-        });
+    for (const std::string& comp : candidates)
+    {
+      if (starts_with(comp, completion_start.second) &&
+          comp != completion_start.second)
+      {
+        out_.insert(string(comp.begin() + prefix_len, comp.end()));
+      }
+    }
   }
 }
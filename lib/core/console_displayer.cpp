@@ -373,13 +373,14 @@ void console_displayer::show_file_section(const data::file_location& location_,
                                           const std::string& env_buffer_)
 {
   file_section section;
-  if (location_.name == "<stdin>")
+  if (location_.name.value() == "<stdin>")
   {
     section = get_file_section_from_buffer(env_buffer_, location_.row, 3);
   }
   else
   {
-    section = get_file_section_from_file(location_.name, location_.row, 3);
+    section =
+        get_file_section_from_file(location_.name.value(), location_.row, 3);
   }
 
   if (section.empty())
@@ -0,0 +1,86 @@
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <metashell/content_hash.hpp>
+
+namespace metashell
+{
+  namespace
+  {
+    // FNV-1a is used on two lanes with different offset bases to get 128
+    // bits. The result of the lanes is mixed by the finaliser of SplitMix64.
+    const std::uint64_t fnv_prime = 0x100000001b3ull;
+
+    std::uint64_t mix(std::uint64_t x_)
+    {
+      x_ = (x_ ^ (x_ >> 30)) * 0xbf58476d1ce4e5b9ull;
+      x_ = (x_ ^ (x_ >> 27)) * 0x94d049bb133111ebull;
+      return x_ ^ (x_ >> 31);
+    }
+
+    void append_hex(std::uint64_t x_, std::string& out_)
+    {
+      const char digits[] = "0123456789abcdef";
+      for (int shift = 60; shift >= 0; shift -= 4)
+      {
+        out_ += digits[(x_ >> shift) & 0xf];
+      }
+    }
+  }
+
+  content_hash::content_hash()
+    : _lane1(0xcbf29ce484222325ull), _lane2(0x84222325cbf29ce4ull)
+  {
+  }
+
+  content_hash& content_hash::add(const std::string& s_)
+  {
+    add(static_cast<std::uint64_t>(s_.size()));
+    add_bytes(s_.data(), s_.data() + s_.size());
+    return *this;
+  }
+
+  content_hash& content_hash::add(std::uint64_t n_)
+  {
+    char bytes[8];
+    for (char& b : bytes)
+    {
+      b = static_cast<char>(n_ & 0xff);
+      n_ >>= 8;
+    }
+    add_bytes(bytes, bytes + sizeof(bytes));
+    return *this;
+  }
+
+  std::string content_hash::hex() const
+  {
+    std::string result;
+    result.reserve(32);
+    append_hex(mix(_lane1 ^ mix(_lane2)), result);
+    append_hex(mix(_lane2 ^ mix(_lane1)), result);
+    return result;
+  }
+
+  void content_hash::add_bytes(const char* begin_, const char* end_)
+  {
+    for (const char* i = begin_; i != end_; ++i)
+    {
+      const std::uint64_t c = static_cast<unsigned char>(*i);
+      _lane1 = (_lane1 ^ c) * fnv_prime;
+      _lane2 = (_lane2 ^ (c + 0x9e)) * fnv_prime;
+    }
+  }
+}
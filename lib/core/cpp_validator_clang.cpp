@@ -19,6 +19,7 @@
 #include <metashell/exception.hpp>
 #include <metashell/metashell.hpp>
 
+#include <boost/algorithm/string/predicate.hpp>
 #include <boost/algorithm/string/trim.hpp>
 
 namespace metashell
@@ -27,9 +28,11 @@ namespace metashell
       const boost::filesystem::path& internal_dir_,
       const boost::filesystem::path& env_filename_,
       clang_binary clang_binary_,
+      std::shared_ptr<precompiled_header_builder> precompiled_header_builder_,
       logger* logger_)
     : _clang_binary(clang_binary_),
       _env_path(internal_dir_ / env_filename_),
+      _precompiled_header_builder(std::move(precompiled_header_builder_)),
       _logger(logger_)
   {
   }
@@ -48,8 +51,9 @@ namespace metashell
       std::vector<std::string> clang_args{"-fsyntax-only"};
       if (use_precompiled_headers_)
       {
-        clang_args.push_back("-include");
-        clang_args.push_back(_env_path.string());
+        const std::vector<std::string> include =
+            include_precompiled(_env_path);
+        clang_args.insert(clang_args.end(), include.begin(), include.end());
       }
 
       const data::process_output output =
@@ -66,4 +70,45 @@ namespace metashell
       return data::result(false, "", e.what(), "");
     }
   }
+
+  data::result
+  cpp_validator_clang::validate_and_append(const data::cpp_code& src_,
+                                           const data::config& config_,
+                                           iface::environment& env_,
+                                           bool use_precompiled_headers_)
+  {
+    if (!use_precompiled_headers_ || !_precompiled_header_builder)
+    {
+      const data::result r =
+          validate_code(src_ + "\n", config_, env_, use_precompiled_headers_);
+      if (r.successful)
+      {
+        env_.append(src_);
+      }
+      return r;
+    }
+
+    METASHELL_LOG(_logger, "Validating and precompiling code " + src_.value());
+
+    // The environment is extended the same way, therefore the precompiled
+    // header is not built again after appending the code.
+    const data::cpp_code src =
+        src_.empty() || boost::algorithm::ends_with(src_.value(), "\n") ?
+            src_ :
+            src_ + "\n";
+
+    // The compiler emits the precompiled header of the extended environment
+    // as well. It is used only when the code is valid.
+    data::result r = _precompiled_header_builder->precompile(
+        _env_path, env_.get_all().value() + src.value());
+    if (r.successful)
+    {
+      env_.append(src_);
+      if (config_.verbose)
+      {
+        r.info = src.value();
+      }
+    }
+    return r;
+  }
 }
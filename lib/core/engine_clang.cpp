@@ -23,6 +23,7 @@
 #include <metashell/macro_discovery_clang.hpp>
 #include <metashell/metaprogram_tracer_clang.hpp>
 #include <metashell/not_supported.hpp>
+#include <metashell/precompiled_header_builder.hpp>
 #include <metashell/preprocessor_shell_clang.hpp>
 #include <metashell/type_shell_clang.hpp>
 
@@ -58,18 +59,38 @@ namespace
                           config_.active_shell_config().engine, env_detector_,
                           displayer_, logger_),
         config_.active_shell_config().engine_args, internal_dir_, env_detector_,
-        logger_);
+        logger_, config_.active_shell_config().limits);
+
+    // The precompiled header is built by the validation of the new
+    // declarations as well.
+    const auto pch_builder = std::make_shared<precompiled_header_builder>(
+        cbin, config_.max_pch_cache_size, logger_);
 
     return make_engine(
         config_.active_shell_config().engine,
-        type_shell_clang(internal_dir_, env_filename_, cbin, logger_),
+        type_shell_clang(internal_dir_, env_filename_, cbin,
+                         config_.active_shell_config().single_pass_evaluation,
+                         pch_builder, logger_),
         preprocessor_shell_clang(cbin),
         code_completer_clang(
-            internal_dir_, temp_dir_, env_filename_, cbin, logger_),
-        header_discoverer_clang(cbin), metaprogram_tracer_clang(cbin),
-        cpp_validator_clang(internal_dir_, env_filename_, cbin, logger_),
+            internal_dir_, temp_dir_, env_filename_, cbin,
+            std::chrono::milliseconds(config_.code_completion_timeout),
+            logger_),
+        header_discoverer_clang(cbin, config_.cache_dir, internal_dir_),
+        metaprogram_tracer_clang(
+            cbin, config_.active_shell_config().single_pass_evaluation),
+        cpp_validator_clang(
+            internal_dir_, env_filename_, cbin, pch_builder, logger_),
         macro_discovery_clang(cbin), not_supported(), supported_features());
   }
+
+  void check_clang_engine(const data::config& config_,
+                          iface::environment_detector& env_detector_)
+  {
+    extract_clang_binary(config_.active_shell_config().engine_args,
+                         env_detector_, config_.metashell_binary,
+                         config_.active_shell_config().engine);
+  }
 } // anonymous namespace
 
 engine_entry metashell::get_engine_clang_entry()
@@ -84,5 +105,5 @@ engine_entry metashell::get_engine_clang_entry()
           "standard by default, you can omit the `-std` argument. Metaprogram "
           "debugging (MDB) is supported only when Clang has been patched with "
           "[templight](https://github.com/mikael-s-persson/templight)"),
-      supported_features());
+      supported_features(), &check_clang_engine);
 }
@@ -32,8 +32,10 @@ namespace
 engine_entry::engine_entry(engine_factory factory_,
                            std::string args_,
                            data::markdown_string description_,
-                           std::vector<data::feature> features_)
+                           std::vector<data::feature> features_,
+                           engine_checker checker_)
   : _factory(move(factory_)),
+    _checker(move(checker_)),
     _args(move(args_)),
     _description(std::move(description_)),
     _features(move(features_))
@@ -54,6 +56,15 @@ engine_entry::build(const data::config& config_,
                   env_detector_, displayer_, logger_);
 }
 
+void engine_entry::check(const data::config& config_,
+                         iface::environment_detector& env_detector_) const
+{
+  if (_checker)
+  {
+    _checker(config_, env_detector_);
+  }
+}
+
 const std::string& engine_entry::args() const { return _args; }
 
 const data::markdown_string& engine_entry::description() const
@@ -110,15 +110,25 @@ namespace
     clang_binary cbin(
         clang_path,
         gcc_args(config_.active_shell_config().engine_args, internal_dir_),
-        logger_);
+        logger_, config_.active_shell_config().limits);
 
     return make_engine(
         config_.active_shell_config().engine, not_supported(),
         preprocessor_shell_clang(cbin), not_supported(),
-        header_discoverer_clang(cbin), not_supported(),
-        cpp_validator_clang(internal_dir_, env_filename_, cbin, logger_),
+        header_discoverer_clang(cbin, config_.cache_dir, internal_dir_),
+        not_supported(),
+        cpp_validator_clang(
+            internal_dir_, env_filename_, cbin, nullptr, logger_),
         macro_discovery_clang(cbin), not_supported(), supported_features());
   }
+
+  void check_gcc_engine(const data::config& config_,
+                        iface::environment_detector& env_detector_)
+  {
+    extract_gcc_binary(config_.active_shell_config().engine_args,
+                       env_detector_, config_.metashell_binary,
+                       config_.active_shell_config().engine);
+  }
 } // anonymous namespace
 
 engine_entry metashell::get_engine_gcc_entry()
@@ -131,5 +141,5 @@ engine_entry metashell::get_engine_gcc_entry()
           "Metashell requires C++11 or above. If your gcc uses such a standard "
           "by default, you can omit the `-std` argument. Also note that "
           "currently only the preprocessor shell is supported."),
-      supported_features());
+      supported_features(), &check_gcc_engine);
 }
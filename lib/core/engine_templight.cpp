@@ -23,6 +23,7 @@
 #include <metashell/macro_discovery_clang.hpp>
 #include <metashell/metaprogram_tracer_templight.hpp>
 #include <metashell/not_supported.hpp>
+#include <metashell/precompiled_header_builder.hpp>
 #include <metashell/preprocessor_shell_clang.hpp>
 #include <metashell/type_shell_clang.hpp>
 
@@ -60,18 +61,40 @@ namespace
             config_.metashell_binary, config_.active_shell_config().engine,
             env_detector_, displayer_, logger_),
         config_.active_shell_config().engine_args, internal_dir_, env_detector_,
-        logger_);
+        logger_, config_.active_shell_config().limits);
+
+    // The precompiled header is built by the validation of the new
+    // declarations as well.
+    const auto pch_builder = std::make_shared<precompiled_header_builder>(
+        cbin, config_.max_pch_cache_size, logger_);
 
     return make_engine(
         config_.active_shell_config().engine,
-        type_shell_clang(internal_dir_, env_filename_, cbin, logger_),
+        type_shell_clang(internal_dir_, env_filename_, cbin,
+                         config_.active_shell_config().single_pass_evaluation,
+                         pch_builder, logger_),
         preprocessor_shell_clang(cbin),
         code_completer_clang(
-            internal_dir_, temp_dir_, env_filename_, cbin, logger_),
-        header_discoverer_clang(cbin), metaprogram_tracer_templight(cbin),
-        cpp_validator_clang(internal_dir_, env_filename_, cbin, logger_),
+            internal_dir_, temp_dir_, env_filename_, cbin,
+            std::chrono::milliseconds(config_.code_completion_timeout),
+            logger_),
+        header_discoverer_clang(cbin, config_.cache_dir, internal_dir_),
+        metaprogram_tracer_templight(
+            cbin, config_.active_shell_config().single_pass_evaluation,
+            config_.compress_template_names,
+            UseInternalTemplight && config_.stream_templight_trace),
+        cpp_validator_clang(
+            internal_dir_, env_filename_, cbin, pch_builder, logger_),
         macro_discovery_clang(cbin), not_supported(), supported_features());
   }
+
+  void check_templight_engine(const data::config& config_,
+                              iface::environment_detector& env_detector_)
+  {
+    extract_clang_binary(config_.active_shell_config().engine_args,
+                         env_detector_, config_.metashell_binary,
+                         config_.active_shell_config().engine);
+  }
 } // anonymous namespace
 
 engine_entry metashell::get_engine_templight_entry()
@@ -85,7 +108,7 @@ engine_entry metashell::get_engine_templight_entry()
           "line-arguments. Note that Metashell requires C++11 or above. If "
           "your Templight uses such a standard by default, you can omit the "
           "`-std` argument."),
-      supported_features());
+      supported_features(), &check_templight_engine);
 }
 
 engine_entry metashell::get_internal_templight_entry()
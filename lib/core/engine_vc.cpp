@@ -81,6 +81,21 @@ namespace
     return args;
   }
 
+  void check_vc_engine(const data::config& config_,
+                       iface::environment_detector& env_detector_)
+  {
+    if (!just::environment::exists("INCLUDE"))
+    {
+      throw exception(
+          "To use the Visual C++ engine, please run Metashell "
+          " from the Visual Studio Developer Prompt.");
+    }
+
+    extract_vc_binary(config_.active_shell_config().engine_args,
+                      env_detector_, config_.metashell_binary,
+                      config_.active_shell_config().engine);
+  }
+
   std::unique_ptr<iface::engine>
   create_vc_engine(const data::config& config_,
                    const boost::filesystem::path& internal_dir_,
@@ -90,19 +105,14 @@ namespace
                    iface::displayer&,
                    logger* logger_)
   {
-    if (!just::environment::exists("INCLUDE"))
-    {
-      throw exception(
-          "To use the Visual C++ engine, please run Metashell "
-          " from the Visual Studio Developer Prompt.");
-    }
+    check_vc_engine(config_, env_detector_);
 
     const boost::filesystem::path vc_path = extract_vc_binary(
         config_.active_shell_config().engine_args, env_detector_,
         config_.metashell_binary, config_.active_shell_config().engine);
     vc_binary cbin(vc_path, vc_args(config_.active_shell_config().engine_args,
                                     internal_dir_),
-                   temp_dir_, logger_);
+                   temp_dir_, logger_, config_.active_shell_config().limits);
 
     return make_engine(
         config_.active_shell_config().engine, not_supported(),
@@ -124,5 +134,5 @@ engine_entry metashell::get_engine_vc_entry()
           "that currently only the preprocessor shell is supported. You need "
           "to run Metashell from the Visual Studio Developer Prompt to use "
           "this engine."),
-      supported_features());
+      supported_features(), &check_vc_engine);
 }
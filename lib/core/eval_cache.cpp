@@ -0,0 +1,296 @@
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <metashell/content_hash.hpp>
+#include <metashell/eval_cache.hpp>
+#include <metashell/file_versions.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <ctime>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <tuple>
+#include <vector>
+
+namespace metashell
+{
+  namespace
+  {
+    const std::string format_header = "metashell eval cache 3\n";
+
+    // Stored in the entry instead of the key, which contains the entire
+    // environment. It is hashed from a different starting state than the name
+    // of the entry, therefore a collision of the names is still a cache miss.
+    std::string key_digest(const std::string& key_)
+    {
+      return content_hash().add("key digest").add(key_).hex();
+    }
+
+    void write_field(const std::string& value_, std::ostream& out_)
+    {
+      out_ << value_.size() << '\n' << value_;
+    }
+
+    bool read_field(std::istream& in_, std::string& value_)
+    {
+      std::string::size_type size = 0;
+      if (in_ >> size && in_.get() == '\n')
+      {
+        value_.resize(size);
+        return size == 0 || in_.read(&value_[0], size);
+      }
+      else
+      {
+        return false;
+      }
+    }
+
+    // Returns none when the entry is corrupted, belongs to a different key or
+    // one of its headers has changed.
+    boost::optional<data::result> parse(const std::string& content_,
+                                        const std::string& key_digest_)
+    {
+      if (content_.compare(0, format_header.size(), format_header) != 0)
+      {
+        return boost::none;
+      }
+
+      std::istringstream in(content_.substr(format_header.size()));
+
+      std::string digest;
+      std::string versions;
+      std::string::size_type header_count = 0;
+      if (!(read_field(in, digest) && digest == key_digest_ &&
+            read_field(in, versions) &&
+            in >> header_count && in.get() == '\n'))
+      {
+        return boost::none;
+      }
+
+      data::include_graph headers;
+      for (std::string::size_type i = 0; i != header_count; ++i)
+      {
+        std::string header;
+        if (!read_field(in, header))
+        {
+          return boost::none;
+        }
+        headers.add(boost::filesystem::path(), header);
+      }
+      if (file_versions(headers) != versions)
+      {
+        return boost::none;
+      }
+
+      data::result result;
+      const int successful = in.get();
+      if ((successful == '0' || successful == '1') && in.get() == '\n' &&
+          read_field(in, result.output) && read_field(in, result.error) &&
+          read_field(in, result.info) && in.peek() == EOF)
+      {
+        result.successful = successful == '1';
+        return result;
+      }
+      else
+      {
+        return boost::none;
+      }
+    }
+
+    // last usage, size, path
+    typedef std::tuple<std::time_t, std::uintmax_t, boost::filesystem::path>
+        entry_info;
+
+    std::vector<entry_info>
+    list_entries(const boost::filesystem::path& directory_)
+    {
+      std::vector<entry_info> result;
+
+      boost::system::error_code ec;
+      for (boost::filesystem::directory_iterator i(directory_, ec), e;
+           !ec && i != e; i.increment(ec))
+      {
+        const boost::filesystem::path& p = i->path();
+        boost::system::error_code entry_ec;
+        if (boost::filesystem::is_regular_file(i->status()))
+        {
+          const std::uintmax_t size = boost::filesystem::file_size(p, entry_ec);
+          const std::time_t used =
+              boost::filesystem::last_write_time(p, entry_ec);
+          if (!entry_ec)
+          {
+            result.emplace_back(used, size, p);
+          }
+        }
+      }
+
+      return result;
+    }
+  }
+
+  eval_cache::eval_cache(boost::filesystem::path directory_,
+                         std::uintmax_t max_size_)
+    : _directory(std::move(directory_)), _max_size(max_size_)
+  {
+  }
+
+  boost::optional<data::result> eval_cache::find(const std::string& key_)
+  {
+    const boost::filesystem::path path = entry(key_);
+    std::ifstream f(path.string(), std::ios::binary);
+    const boost::optional<data::result> result =
+        f ? parse(std::string(std::istreambuf_iterator<char>(f),
+                              std::istreambuf_iterator<char>()),
+                  key_digest(key_)) :
+            boost::none;
+
+    if (result)
+    {
+      ++_hits;
+      boost::system::error_code ec;
+      boost::filesystem::last_write_time(path, std::time(nullptr), ec);
+    }
+    else
+    {
+      ++_misses;
+    }
+    return result;
+  }
+
+  void eval_cache::store(const std::string& key_, const data::result& result_)
+  {
+    const data::include_graph no_headers;
+    store(key_, result_, no_headers, file_versions(no_headers));
+  }
+
+  void eval_cache::store(const std::string& key_,
+                         const data::result& result_,
+                         const data::include_graph& headers_,
+                         const std::string& versions_)
+  {
+    boost::system::error_code ec;
+    boost::filesystem::create_directories(_directory, ec);
+
+    // Writing into a temporary file and renaming it to make other Metashell
+    // processes using the same cache never see a partially written entry.
+    const boost::filesystem::path path = entry(key_);
+    const boost::filesystem::path tmp =
+        boost::filesystem::unique_path(path.string() + "-%%%%%%%%.tmp", ec);
+    if (ec)
+    {
+      return;
+    }
+
+    {
+      std::ofstream f(tmp.string(), std::ios::binary);
+      f << format_header;
+      write_field(key_digest(key_), f);
+      write_field(versions_, f);
+      f << headers_.headers().size() << '\n';
+      for (const boost::filesystem::path& header : headers_.headers())
+      {
+        write_field(header.string(), f);
+      }
+      f << (result_.successful ? '1' : '0') << '\n';
+      write_field(result_.output, f);
+      write_field(result_.error, f);
+      write_field(result_.info, f);
+      if (!f)
+      {
+        ec = make_error_code(boost::system::errc::io_error);
+      }
+    }
+
+    if (!ec)
+    {
+      boost::filesystem::rename(tmp, path, ec);
+    }
+
+    if (ec)
+    {
+      boost::filesystem::remove(tmp, ec);
+    }
+    else
+    {
+      evict();
+    }
+  }
+
+  void eval_cache::clear()
+  {
+    for (const auto& e : list_entries(_directory))
+    {
+      boost::system::error_code ec;
+      boost::filesystem::remove(std::get<2>(e), ec);
+    }
+  }
+
+  const boost::filesystem::path& eval_cache::directory() const
+  {
+    return _directory;
+  }
+
+  std::uintmax_t eval_cache::max_size() const { return _max_size; }
+
+  int eval_cache::hits() const { return _hits; }
+
+  int eval_cache::misses() const { return _misses; }
+
+  int eval_cache::entries() const { return list_entries(_directory).size(); }
+
+  std::uintmax_t eval_cache::size() const
+  {
+    std::uintmax_t result = 0;
+    for (const auto& e : list_entries(_directory))
+    {
+      result += std::get<1>(e);
+    }
+    return result;
+  }
+
+  boost::filesystem::path eval_cache::entry(const std::string& key_) const
+  {
+    return _directory / content_hash().add(key_).hex();
+  }
+
+  void eval_cache::evict()
+  {
+    auto entries = list_entries(_directory);
+
+    std::uintmax_t total = 0;
+    for (const auto& e : entries)
+    {
+      total += std::get<1>(e);
+    }
+
+    if (total > _max_size)
+    {
+      std::sort(entries.begin(), entries.end());
+      for (auto i = entries.begin(); i != entries.end() && total > _max_size;
+           ++i)
+      {
+        boost::system::error_code ec;
+        if (boost::filesystem::remove(std::get<2>(*i), ec))
+        {
+          total -= std::get<1>(*i);
+        }
+      }
+    }
+  }
+}
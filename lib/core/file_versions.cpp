@@ -0,0 +1,70 @@
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <metashell/file_versions.hpp>
+
+#include <boost/filesystem/operations.hpp>
+
+#include <cstdint>
+#include <ctime>
+
+namespace metashell
+{
+  void add_file_versions(content_hash& hash_,
+                         const data::include_graph& graph_)
+  {
+    hash_.add(graph_.headers().size());
+    for (const boost::filesystem::path& header : graph_.headers())
+    {
+      hash_.add(header.string());
+
+      boost::system::error_code ec;
+      const std::uintmax_t size = boost::filesystem::file_size(header, ec);
+      if (ec)
+      {
+        hash_.add("missing");
+      }
+      else
+      {
+        const std::time_t modified =
+            boost::filesystem::last_write_time(header, ec);
+        hash_.add(size).add(ec ? 0 : static_cast<std::uint64_t>(modified));
+      }
+    }
+  }
+
+  std::string file_versions(const data::include_graph& graph_)
+  {
+    content_hash result;
+    add_file_versions(result, graph_);
+    return result.hex();
+  }
+
+  bool modified_after(const data::include_graph& graph_, std::time_t time_)
+  {
+    for (const boost::filesystem::path& header : graph_.headers())
+    {
+      boost::system::error_code ec;
+      const std::time_t modified =
+          boost::filesystem::last_write_time(header, ec);
+      if (!ec && modified > time_)
+      {
+        return true;
+      }
+    }
+    return false;
+  }
+}
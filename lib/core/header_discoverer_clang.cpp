@@ -18,13 +18,10 @@
 
 #include <metashell/includes_cache.hpp>
 
-#include <boost/xpressive/xpressive.hpp>
-
-#include <boost/range/adaptor/filtered.hpp>
-#include <boost/range/adaptor/transformed.hpp>
-
 #include <just/lines.hpp>
 
+#include <vector>
+
 namespace
 {
   template <class InputIt>
@@ -49,8 +46,12 @@ namespace
 
 namespace metashell
 {
-  header_discoverer_clang::header_discoverer_clang(clang_binary clang_binary_)
-    : _clang_binary(clang_binary_), _includes(includes_cache(_clang_binary))
+  header_discoverer_clang::header_discoverer_clang(
+      clang_binary clang_binary_,
+      const boost::filesystem::path& cache_dir_,
+      const boost::filesystem::path& internal_dir_)
+    : _clang_binary(clang_binary_),
+      _includes(includes_cache(_clang_binary, cache_dir_, internal_dir_))
   {
   }
 
@@ -60,31 +61,29 @@ namespace metashell
     return get(type_, *_includes);
   }
 
-  std::set<boost::filesystem::path>
+  data::include_graph
   header_discoverer_clang::files_included_by(const data::cpp_code& exp_)
   {
     const data::process_output output =
         run_clang(_clang_binary, {"-H", "-E"}, exp_);
 
-    const boost::xpressive::sregex included_header =
-        boost::xpressive::bos >> +boost::xpressive::as_xpr('.') >> ' ';
-
-    const just::lines::view lines(output.standard_error);
-
-    const auto result =
-        lines |
-        boost::adaptors::filtered([&included_header](const std::string& s_) {
-          return regex_search(s_, included_header);
-        }) |
-        boost::adaptors::transformed([](const std::string& s_) {
-          const auto i = std::find(s_.begin(), s_.end(), ' ');
-
-          return i == s_.end() ?
-                     boost::filesystem::path() :
-                     boost::filesystem::path(
-                         remove_double_backslashes(i + 1, s_.end()));
-        });
+    // The number of dots before a header is the depth of the inclusion
+    data::include_graph result;
+    std::vector<boost::filesystem::path> includers{boost::filesystem::path()};
+    for (const std::string& line : just::lines::view(output.standard_error))
+    {
+      const std::string::size_type depth = line.find_first_not_of('.');
+      if (depth != 0 && depth != std::string::npos && line[depth] == ' ' &&
+          depth <= includers.size())
+      {
+        const boost::filesystem::path header(
+            remove_double_backslashes(line.begin() + depth + 1, line.end()));
 
-    return std::set<boost::filesystem::path>(result.begin(), result.end());
+        includers.resize(depth);
+        result.add(includers.back(), header);
+        includers.push_back(header);
+      }
+    }
+    return result;
   }
 }
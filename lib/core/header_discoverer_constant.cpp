@@ -31,9 +31,9 @@ namespace metashell
     return get(type_, _includes);
   }
 
-  std::set<boost::filesystem::path>
+  data::include_graph
   header_discoverer_constant::files_included_by(const data::cpp_code&)
   {
-    return std::set<boost::filesystem::path>();
+    return data::include_graph();
   }
 }
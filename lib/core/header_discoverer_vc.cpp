@@ -30,6 +30,7 @@
 #include <just/lines.hpp>
 
 #include <algorithm>
+#include <vector>
 
 namespace
 {
@@ -96,7 +97,7 @@ namespace metashell
     return get(type_, _includes);
   }
 
-  std::set<boost::filesystem::path>
+  data::include_graph
   header_discoverer_vc::files_included_by(const data::cpp_code& exp_)
   {
     using boost::xpressive::bos;
@@ -109,17 +110,27 @@ namespace metashell
     const boost::xpressive::sregex included_header =
         bos >> +~(set = ':') >> ": " >> +~(set = ':') >> ":" >> *as_xpr(' ');
 
-    std::set<boost::filesystem::path> result;
-
+    // The number of spaces before a header is the depth of the inclusion
+    data::include_graph result;
+    std::vector<boost::filesystem::path> includers{boost::filesystem::path()};
     for (const std::string line : just::lines::view(output.standard_output))
     {
       boost::xpressive::smatch what;
       if (regex_search(line, what, included_header))
       {
-        result.insert(what.suffix().str());
+        const std::string prefix = what[0].str();
+        const std::string::size_type depth =
+            prefix.size() - prefix.find_last_not_of(' ') - 1;
+        if (depth > 0 && depth <= includers.size())
+        {
+          const boost::filesystem::path header(what.suffix().str());
+
+          includers.resize(depth);
+          result.add(includers.back(), header);
+          includers.push_back(header);
+        }
       }
     }
-
     return result;
   }
 }
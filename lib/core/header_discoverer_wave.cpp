@@ -31,11 +31,11 @@ namespace metashell
     return get(type_, _config.includes);
   }
 
-  std::set<boost::filesystem::path>
+  data::include_graph
   header_discoverer_wave::files_included_by(const data::cpp_code& exp_)
   {
     const data::cpp_code exp = exp_ + "\n";
-    std::set<boost::filesystem::path> result;
+    data::include_graph result;
     wave_hooks hooks(result);
     wave_context ctx(exp.begin(), exp.end(), "<stdin>", hooks);
     apply(ctx, _config);
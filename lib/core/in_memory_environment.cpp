@@ -0,0 +1,43 @@
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <metashell/in_memory_environment.hpp>
+
+namespace metashell
+{
+  in_memory_environment::in_memory_environment(
+      data::cpp_code code_, const boost::filesystem::path& internal_dir_)
+    : _code(std::move(code_)), _headers(internal_dir_)
+  {
+  }
+
+  void in_memory_environment::append(const data::cpp_code& s_) { _code += s_; }
+
+  data::cpp_code in_memory_environment::get() const { return _code; }
+
+  data::cpp_code
+  in_memory_environment::get_appended(const data::cpp_code& s_) const
+  {
+    return _code + s_;
+  }
+
+  const data::headers& in_memory_environment::get_headers() const
+  {
+    return _headers;
+  }
+
+  data::cpp_code in_memory_environment::get_all() const { return _code; }
+}
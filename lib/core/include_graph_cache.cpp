@@ -0,0 +1,105 @@
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <metashell/file_versions.hpp>
+#include <metashell/include_graph_cache.hpp>
+#include <metashell/process/cancelled.hpp>
+
+#include <boost/algorithm/string/predicate.hpp>
+
+namespace metashell
+{
+  include_graph_cache::include_graph_cache(int max_entries_)
+    : _max_entries(max_entries_)
+  {
+  }
+
+  data::include_graph include_graph_cache::files_included_by(
+      const std::string& engine_,
+      const data::cpp_code& code_,
+      iface::header_discoverer& header_discoverer_,
+      const macro_definitions& definitions_)
+  {
+    auto earlier = _entries.end();
+    for (auto i = _entries.begin(); i != _entries.end();)
+    {
+      if (i->engine != engine_ || !boost::starts_with(code_, i->code))
+      {
+        ++i;
+      }
+      else if (i->versions != file_versions(i->graph))
+      {
+        // One of the headers has changed since the graph was determined
+        i = _entries.erase(i);
+      }
+      else if (i->code == code_)
+      {
+        _entries.splice(_entries.begin(), _entries, i);
+        return i->graph;
+      }
+      else
+      {
+        if (definitions_ && !i->code.empty() &&
+            boost::ends_with(i->code, "\n") &&
+            (earlier == _entries.end() ||
+             earlier->code.size() < i->code.size()))
+        {
+          earlier = i;
+        }
+        ++i;
+      }
+    }
+
+    if (earlier != _entries.end())
+    {
+      const entry base = *earlier;
+      try
+      {
+        data::include_graph result = header_discoverer_.files_included_by(
+            definitions_(base.code) + code_.value().substr(base.code.size()));
+        result.add(base.graph);
+        store(engine_, code_, result);
+        return result;
+      }
+      catch (const process::cancelled&)
+      {
+        throw;
+      }
+      catch (const std::exception&)
+      {
+        // Processing the entire code reports the real error
+      }
+    }
+
+    const data::include_graph result =
+        header_discoverer_.files_included_by(code_);
+    store(engine_, code_, result);
+    return result;
+  }
+
+  void include_graph_cache::clear() { _entries.clear(); }
+
+  void include_graph_cache::store(const std::string& engine_,
+                                  const data::cpp_code& code_,
+                                  const data::include_graph& graph_)
+  {
+    _entries.push_front(entry{engine_, code_, graph_, file_versions(graph_)});
+    while (_entries.size() > static_cast<std::size_t>(_max_entries))
+    {
+      _entries.pop_back();
+    }
+  }
+}
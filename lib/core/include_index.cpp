@@ -0,0 +1,698 @@
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <metashell/content_hash.hpp>
+#include <metashell/include_index.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <utility>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace metashell
+{
+  namespace
+  {
+    const std::string format_header = "metashell include index 1";
+
+    // The number of directories listed by the background thread under one
+    // directory passed to index.
+    const int max_directories_per_root = 20000;
+
+    boost::filesystem::path normalise(const boost::filesystem::path& path_)
+    {
+      boost::filesystem::path result = path_.lexically_normal();
+      while (result.filename() == "." && result != result.root_path())
+      {
+        result = result.parent_path();
+      }
+      return result;
+    }
+
+    bool under(const boost::filesystem::path& path_,
+               const boost::filesystem::path& dir_)
+    {
+      const std::string p = path_.string();
+      const std::string d = dir_.string();
+      return p.compare(0, d.size(), d) == 0 &&
+             (p.size() == d.size() || (!d.empty() && d.back() == '/') ||
+              p[d.size()] == '/' ||
+              p[d.size()] == boost::filesystem::path::preferred_separator);
+    }
+
+    // 0 when path_ does not exist
+    std::time_t modification_date(const boost::filesystem::path& path_)
+    {
+      boost::system::error_code ec;
+      const std::time_t result = boost::filesystem::last_write_time(path_, ec);
+      return ec ? 0 : result;
+    }
+
+    bool has_newline(const std::string& s_)
+    {
+      return s_.find('\n') != std::string::npos;
+    }
+
+    include_index::entry_type
+    type_of(const boost::filesystem::file_status& status_)
+    {
+      if (is_regular_file(status_))
+      {
+        return include_index::entry_type::file;
+      }
+      else if (is_directory(status_))
+      {
+        return include_index::entry_type::directory;
+      }
+      else
+      {
+        return include_index::entry_type::other;
+      }
+    }
+
+    char to_char(include_index::entry_type type_)
+    {
+      switch (type_)
+      {
+      case include_index::entry_type::file:
+        return 'f';
+      case include_index::entry_type::directory:
+        return 'd';
+      case include_index::entry_type::other:
+        return 'o';
+      }
+      return 'o';
+    }
+
+    boost::optional<include_index::entry_type> from_char(char c_)
+    {
+      switch (c_)
+      {
+      case 'f':
+        return include_index::entry_type::file;
+      case 'd':
+        return include_index::entry_type::directory;
+      case 'o':
+        return include_index::entry_type::other;
+      default:
+        return boost::none;
+      }
+    }
+  }
+
+  include_index::include_index(boost::filesystem::path cache_dir_,
+                               std::chrono::milliseconds polling_interval_,
+                               bool use_inotify_,
+                               logger* logger_)
+    : _cache_dir(std::move(cache_dir_)),
+      _polling_interval(polling_interval_),
+      _logger(logger_)
+  {
+#ifdef __linux__
+    if (use_inotify_)
+    {
+      _inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+      if (_inotify == -1)
+      {
+        METASHELL_LOG(_logger, "inotify is not available, using polling.");
+      }
+      else if (pipe2(_wakeup, O_NONBLOCK | O_CLOEXEC) == -1)
+      {
+        close(_inotify);
+        _inotify = -1;
+      }
+    }
+#else
+    (void)use_inotify_;
+#endif
+  }
+
+  include_index::~include_index()
+  {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _stopping = true;
+    }
+    wake();
+    if (_thread.joinable())
+    {
+      _thread.join();
+    }
+
+#ifdef __linux__
+    if (_inotify != -1)
+    {
+      close(_inotify);
+      close(_wakeup[0]);
+      close(_wakeup[1]);
+    }
+#endif
+  }
+
+  void include_index::index(const std::vector<boost::filesystem::path>& dirs_)
+  {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      for (const boost::filesystem::path& dir : dirs_)
+      {
+        const boost::filesystem::path d = normalise(dir);
+        if (!d.empty() && std::find(_roots.begin(), _roots.end(), d) ==
+                              _roots.end())
+        {
+          _roots.push_back(d);
+          _pending.push_back(d);
+        }
+      }
+      start();
+    }
+    wake();
+  }
+
+  void include_index::wait()
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _changed.wait(lock, [this] { return _pending.empty() && !_indexing; });
+  }
+
+  boost::optional<include_index::entry_type>
+  include_index::type(const boost::filesystem::path& path_)
+  {
+    const boost::filesystem::path path = normalise(path_);
+    const boost::filesystem::path parent = path.parent_path();
+
+    if (parent.empty() || path == path.root_path())
+    {
+      // Relative paths without a directory and the root are not indexed
+      boost::system::error_code ec;
+      const boost::filesystem::file_status status =
+          boost::filesystem::status(path, ec);
+      return exists(status) ? boost::make_optional(type_of(status)) :
+                              boost::none;
+    }
+
+    const std::string name = path.filename().string();
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      const auto dir = _directories.find(parent);
+      if (dir != _directories.end())
+      {
+        const auto entry = dir->second.content.find(name);
+        return entry == dir->second.content.end() ?
+                   boost::none :
+                   boost::make_optional(entry->second);
+      }
+    }
+
+    const directory dir = get(parent);
+    const auto entry = dir.content.find(name);
+    return entry == dir.content.end() ? boost::none :
+                                        boost::make_optional(entry->second);
+  }
+
+  boost::optional<include_index::entries>
+  include_index::list(const boost::filesystem::path& dir_)
+  {
+    const directory dir = get(normalise(dir_));
+    return dir.exists ? boost::make_optional(dir.content) : boost::none;
+  }
+
+  void include_index::start()
+  {
+    if (!_thread.joinable())
+    {
+      _thread = std::thread([this] { run(); });
+    }
+  }
+
+  void include_index::wake()
+  {
+#ifdef __linux__
+    if (_inotify != -1)
+    {
+      // When the pipe is full, the thread has not read the earlier
+      // notifications yet.
+      const char c = 0;
+      const ssize_t written = write(_wakeup[1], &c, 1);
+      static_cast<void>(written);
+      return;
+    }
+#endif
+    _changed.notify_all();
+  }
+
+  include_index::directory
+  include_index::get(const boost::filesystem::path& dir_)
+  {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      const auto dir = _directories.find(dir_);
+      if (dir != _directories.end())
+      {
+        return dir->second;
+      }
+    }
+
+    directory result;
+    result.listed = std::time(nullptr);
+    result.modified = modification_date(dir_);
+    if (result.modified != 0)
+    {
+      boost::system::error_code ec;
+      result.exists = is_directory(dir_, ec);
+      for (boost::filesystem::directory_iterator i(dir_, ec), e;
+           !ec && i != e; i.increment(ec))
+      {
+        const std::string name = i->path().filename().string();
+        boost::system::error_code status_ec;
+        result.content[name] = type_of(i->status(status_ec));
+        if (is_symlink(i->symlink_status(status_ec)))
+        {
+          result.links.insert(name);
+        }
+      }
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    const auto r = _directories.insert(std::make_pair(dir_, result));
+    if (r.second && result.exists)
+    {
+      watch(dir_);
+    }
+    if (r.second)
+    {
+      start();
+    }
+    return r.first->second;
+  }
+
+  void include_index::remember(const boost::filesystem::path& dir_,
+                               directory dir_data_)
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _directories[dir_] = std::move(dir_data_);
+    if (_directories[dir_].exists)
+    {
+      watch(dir_);
+    }
+  }
+
+  void include_index::watch(const boost::filesystem::path& dir_)
+  {
+#ifdef __linux__
+    if (_inotify != -1 && _watched.find(dir_) == _watched.end())
+    {
+      const int wd = inotify_add_watch(
+          _inotify, dir_.c_str(),
+          IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO |
+              IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR);
+      if (wd != -1)
+      {
+        _watches[wd] = dir_;
+        _watched.insert(dir_);
+      }
+    }
+#else
+    (void)dir_;
+#endif
+  }
+
+  void include_index::run()
+  {
+    auto next_poll = std::chrono::steady_clock::now() + _polling_interval;
+    while (true)
+    {
+      boost::filesystem::path root;
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_stopping)
+        {
+          return;
+        }
+        else if (!_pending.empty())
+        {
+          root = _pending.front();
+          _pending.erase(_pending.begin());
+          _indexing = true;
+        }
+      }
+
+      if (!root.empty())
+      {
+        try
+        {
+          walk(root, load(root));
+          store(root);
+        }
+        catch (const std::exception& e)
+        {
+          METASHELL_LOG(_logger, "Error indexing " + root.string() + ": " +
+                                     e.what());
+        }
+        {
+          std::lock_guard<std::mutex> lock(_mutex);
+          _indexing = false;
+        }
+        _changed.notify_all();
+        continue;
+      }
+
+      for (const boost::filesystem::path& dir : wait_for_events(next_poll))
+      {
+        update(dir);
+      }
+      if (std::chrono::steady_clock::now() >= next_poll)
+      {
+        poll();
+        next_poll = std::chrono::steady_clock::now() + _polling_interval;
+      }
+
+      for (const boost::filesystem::path& modified_root : _modified_roots)
+      {
+        try
+        {
+          store(modified_root);
+        }
+        catch (const std::exception& e)
+        {
+          METASHELL_LOG(_logger, "Error storing the index of " +
+                                     modified_root.string() + ": " + e.what());
+        }
+      }
+      _modified_roots.clear();
+    }
+  }
+
+  std::vector<boost::filesystem::path> include_index::wait_for_events(
+      std::chrono::steady_clock::time_point until_)
+  {
+#ifdef __linux__
+    if (_inotify != -1)
+    {
+      const auto timeout =
+          std::chrono::duration_cast<std::chrono::milliseconds>(
+              until_ - std::chrono::steady_clock::now());
+
+      pollfd fds[2] = {{_inotify, POLLIN, 0}, {_wakeup[0], POLLIN, 0}};
+      if (::poll(fds, 2, static_cast<int>(std::max<std::int64_t>(
+                             0, timeout.count()))) > 0)
+      {
+        if (fds[1].revents & POLLIN)
+        {
+          char buff[64];
+          while (read(_wakeup[0], buff, sizeof(buff)) > 0)
+          {
+          }
+        }
+        if (fds[0].revents & POLLIN)
+        {
+          return read_events();
+        }
+      }
+      return {};
+    }
+#endif
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    _changed.wait_until(
+        lock, until_, [this] { return _stopping || !_pending.empty(); });
+    return {};
+  }
+
+  std::vector<boost::filesystem::path> include_index::read_events()
+  {
+    std::vector<boost::filesystem::path> result;
+#ifdef __linux__
+    alignas(inotify_event) char buff[4096];
+    ssize_t len = 0;
+    while ((len = read(_inotify, buff, sizeof(buff))) > 0)
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      for (const char* p = buff; p < buff + len;)
+      {
+        const inotify_event* event = reinterpret_cast<const inotify_event*>(p);
+        const auto watch = _watches.find(event->wd);
+        if (watch != _watches.end())
+        {
+          if (std::find(result.begin(), result.end(), watch->second) ==
+              result.end())
+          {
+            result.push_back(watch->second);
+          }
+          if (event->mask & IN_IGNORED)
+          {
+            _watched.erase(watch->second);
+            _watches.erase(watch);
+          }
+        }
+        p += sizeof(inotify_event) + event->len;
+      }
+    }
+#endif
+    return result;
+  }
+
+  void include_index::walk(
+      const boost::filesystem::path& root_,
+      const std::map<boost::filesystem::path, directory>& stored_)
+  {
+    std::vector<boost::filesystem::path> todo{root_};
+    for (int listed = 0; !todo.empty() && listed < max_directories_per_root;
+         ++listed)
+    {
+      const boost::filesystem::path dir = todo.back();
+      todo.pop_back();
+
+      boost::optional<directory> known;
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_stopping)
+        {
+          return;
+        }
+        const auto i = _directories.find(dir);
+        if (i != _directories.end())
+        {
+          known = i->second;
+        }
+      }
+      // The directories listed since starting are more recent than the
+      // stored ones.
+      if (!known)
+      {
+        const auto i = stored_.find(dir);
+        if (i != stored_.end())
+        {
+          known = i->second;
+        }
+      }
+
+      // The content of a directory listed in the second when it was last
+      // modified may be out of date.
+      if (!known || modification_date(dir) != known->modified ||
+          (known->exists && known->modified >= known->listed - 1))
+      {
+        {
+          std::lock_guard<std::mutex> lock(_mutex);
+          _directories.erase(dir);
+        }
+        known = get(dir);
+      }
+      else
+      {
+        remember(dir, *known);
+      }
+
+      for (const auto& entry : known->content)
+      {
+        if (entry.second == entry_type::directory &&
+            known->links.find(entry.first) == known->links.end())
+        {
+          todo.push_back(dir / entry.first);
+        }
+      }
+    }
+  }
+
+  void include_index::poll()
+  {
+    std::vector<std::pair<boost::filesystem::path, directory>> unwatched;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      for (const auto& dir : _directories)
+      {
+        if (_watched.find(dir.first) == _watched.end())
+        {
+          directory d;
+          d.exists = dir.second.exists;
+          d.modified = dir.second.modified;
+          d.listed = dir.second.listed;
+          unwatched.emplace_back(dir.first, d);
+        }
+      }
+    }
+
+    for (const auto& dir : unwatched)
+    {
+      if (modification_date(dir.first) != dir.second.modified ||
+          (dir.second.exists &&
+           dir.second.modified >= dir.second.listed - 1))
+      {
+        update(dir.first);
+      }
+    }
+  }
+
+  void include_index::update(const boost::filesystem::path& dir_)
+  {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _directories.erase(dir_);
+      for (const boost::filesystem::path& root : _roots)
+      {
+        if (under(dir_, root))
+        {
+          _modified_roots.insert(root);
+        }
+      }
+    }
+    get(dir_);
+  }
+
+  boost::filesystem::path
+  include_index::index_file(const boost::filesystem::path& root_) const
+  {
+    return _cache_dir / content_hash().add(root_.string()).hex();
+  }
+
+  std::map<boost::filesystem::path, include_index::directory>
+  include_index::load(const boost::filesystem::path& root_) const
+  {
+    const std::map<boost::filesystem::path, directory> nothing;
+
+    if (_cache_dir.empty())
+    {
+      return nothing;
+    }
+
+    std::ifstream f(index_file(root_).string());
+    std::string line;
+    if (!std::getline(f, line) || line != format_header)
+    {
+      return nothing;
+    }
+
+    std::map<boost::filesystem::path, directory> loaded;
+    while (std::getline(f, line))
+    {
+      std::istringstream s(line);
+      char tag = 0;
+      int exists = 0;
+      directory dir;
+      std::size_t count = 0;
+      if (!(s >> tag >> exists >> dir.modified >> dir.listed >> count) ||
+          tag != 'D' || s.get() != ' ')
+      {
+        return nothing;
+      }
+      dir.exists = exists == 1;
+
+      std::string path;
+      std::getline(s, path);
+
+      for (std::size_t i = 0; i != count; ++i)
+      {
+        if (!std::getline(f, line) || line.size() < 3 || line[2] != ' ')
+        {
+          return nothing;
+        }
+        const auto type = from_char(line[0]);
+        if (!type)
+        {
+          return nothing;
+        }
+        const std::string name = line.substr(3);
+        dir.content[name] = *type;
+        if (line[1] == 'l')
+        {
+          dir.links.insert(name);
+        }
+      }
+
+      loaded[path] = dir;
+    }
+
+    return loaded;
+  }
+
+  void include_index::store(const boost::filesystem::path& root_)
+  {
+    if (_cache_dir.empty())
+    {
+      return;
+    }
+
+    std::ostringstream s;
+    s << format_header << '\n';
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      for (auto i = _directories.lower_bound(root_);
+           i != _directories.end() && under(i->first, root_); ++i)
+      {
+        // These directories are listed again by the next process
+        if (has_newline(i->first.string()) ||
+            std::any_of(i->second.content.begin(), i->second.content.end(),
+                        [](const std::pair<const std::string, entry_type>& e_) {
+                          return has_newline(e_.first);
+                        }))
+        {
+          continue;
+        }
+
+        s << "D " << (i->second.exists ? 1 : 0) << ' ' << i->second.modified
+          << ' ' << i->second.listed << ' ' << i->second.content.size() << ' '
+          << i->first.string() << '\n';
+        for (const auto& entry : i->second.content)
+        {
+          s << to_char(entry.second)
+            << (i->second.links.count(entry.first) ? 'l' : '-') << ' '
+            << entry.first << '\n';
+        }
+      }
+    }
+
+    boost::filesystem::create_directories(_cache_dir);
+
+    const boost::filesystem::path fn = index_file(root_);
+    const boost::filesystem::path tmp =
+        fn.string() +
+        boost::filesystem::unique_path("-%%%%%%%%.tmp").string();
+    {
+      std::ofstream f(tmp.string());
+      f << s.str();
+    }
+    boost::filesystem::rename(tmp, fn);
+  }
+}
@@ -24,8 +24,11 @@
 
 #include <boost/algorithm/string/predicate.hpp>
 #include <boost/algorithm/string/trim.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/optional.hpp>
 
 #include <algorithm>
+#include <fstream>
 #include <string>
 
 namespace
@@ -103,6 +106,129 @@ namespace
     const std::string s = o.standard_output + o.standard_error;
     return determine_clang_includes(just::lines::view_of(s));
   }
+
+  const std::string format_header = "metashell includes cache 1";
+
+  bool is_separator(char c_)
+  {
+    return c_ == '/' || c_ == boost::filesystem::path::preferred_separator;
+  }
+
+  // Returns if path_ is dir_ or a path in it. /tmp/ab is not in /tmp/a.
+  bool in_directory(const std::string& path_, const std::string& dir_)
+  {
+    return !dir_.empty() && boost::algorithm::starts_with(path_, dir_) &&
+           (path_.size() == dir_.size() || is_separator(dir_.back()) ||
+            is_separator(path_[dir_.size()]));
+  }
+
+  // Every path is stored in one line. Paths in the internal directory are
+  // prefixed with "i", the rest of them with "a".
+  void write_paths(const std::vector<boost::filesystem::path>& paths_,
+                   const std::string& internal_dir_,
+                   std::ostream& out_)
+  {
+    out_ << paths_.size() << '\n';
+    for (const boost::filesystem::path& p : paths_)
+    {
+      const std::string path = p.string();
+      if (in_directory(path, internal_dir_))
+      {
+        out_ << 'i' << path.substr(internal_dir_.size()) << '\n';
+      }
+      else
+      {
+        out_ << 'a' << path << '\n';
+      }
+    }
+  }
+
+  bool read_paths(std::istream& in_,
+                  const std::string& internal_dir_,
+                  std::vector<boost::filesystem::path>& paths_)
+  {
+    std::string line;
+    if (!std::getline(in_, line))
+    {
+      return false;
+    }
+
+    std::vector<boost::filesystem::path>::size_type size = 0;
+    try
+    {
+      size = std::stoul(line);
+    }
+    catch (const std::exception&)
+    {
+      return false;
+    }
+
+    for (; size > 0 && std::getline(in_, line); --size)
+    {
+      if (line.empty() || (line[0] != 'i' && line[0] != 'a'))
+      {
+        return false;
+      }
+      paths_.push_back(line[0] == 'i' ? internal_dir_ + line.substr(1) :
+                                        line.substr(1));
+    }
+    return size == 0;
+  }
+
+  boost::optional<metashell::data::includes>
+  load(const boost::filesystem::path& path_, const std::string& internal_dir_)
+  {
+    std::ifstream f(path_.string(), std::ios::binary);
+    std::string header;
+    metashell::data::includes result;
+    if (std::getline(f, header) && header == format_header &&
+        read_paths(f, internal_dir_, result.sys) &&
+        read_paths(f, internal_dir_, result.quote) && f.peek() == EOF)
+    {
+      return result;
+    }
+    else
+    {
+      return boost::none;
+    }
+  }
+
+  // It writes into a temporary file and renames it to make other Metashell
+  // processes using the same cache never see a partially written entry.
+  void store(const boost::filesystem::path& path_,
+             const std::string& internal_dir_,
+             const metashell::data::includes& includes_)
+  {
+    boost::system::error_code ec;
+    boost::filesystem::create_directories(path_.parent_path(), ec);
+
+    const boost::filesystem::path tmp =
+        boost::filesystem::unique_path(path_.string() + "-%%%%%%%%.tmp", ec);
+    if (ec)
+    {
+      return;
+    }
+
+    {
+      std::ofstream f(tmp.string(), std::ios::binary);
+      f << format_header << '\n';
+      write_paths(includes_.sys, internal_dir_, f);
+      write_paths(includes_.quote, internal_dir_, f);
+      if (!f)
+      {
+        ec = make_error_code(boost::system::errc::io_error);
+      }
+    }
+
+    if (!ec)
+    {
+      boost::filesystem::rename(tmp, path_, ec);
+    }
+    if (ec)
+    {
+      boost::filesystem::remove(tmp, ec);
+    }
+  }
 }
 
 namespace metashell
@@ -112,4 +238,38 @@ namespace metashell
     return cached<data::includes>(
         [clang_binary_]() { return determine_includes(clang_binary_); });
   }
+
+  cached<data::includes>
+  includes_cache(clang_binary clang_binary_,
+                 const boost::filesystem::path& cache_dir_,
+                 const boost::filesystem::path& internal_dir_)
+  {
+    if (cache_dir_.empty())
+    {
+      return includes_cache(std::move(clang_binary_));
+    }
+
+    return cached<data::includes>([clang_binary_, cache_dir_,
+                                   internal_dir_]() {
+      const boost::filesystem::path path =
+          cache_dir_ / "includes" / clang_binary_.cache_key(internal_dir_);
+      const std::string internal_dir = internal_dir_.string();
+
+      if (const boost::optional<data::includes> stored =
+              load(path, internal_dir))
+      {
+        return *stored;
+      }
+      else
+      {
+        const data::includes result = determine_includes(clang_binary_);
+        // The compiler may have failed to display its include path
+        if (!result.sys.empty() || !result.quote.empty())
+        {
+          store(path, internal_dir, result);
+        }
+        return result;
+      }
+    });
+  }
 }
@@ -16,6 +16,8 @@
 
 #include <metashell/logger.hpp>
 
+#include <mutex>
+
 using namespace metashell;
 
 logger::logger(iface::displayer& displayer_, iface::file_writer& fwriter_)
@@ -23,13 +25,23 @@ logger::logger(iface::displayer& displayer_, iface::file_writer& fwriter_)
 {
 }
 
-bool logger::logging() const { return _mode != data::logging_mode::none; }
+bool logger::logging() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _mode != data::logging_mode::none;
+}
 
-data::logging_mode logger::mode() const { return _mode; }
+data::logging_mode logger::mode() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _mode;
+}
 
 void logger::log_into_file(const std::string& filename_)
 {
-  stop_logging();
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  stop_logging_locked();
 
   if (_fwriter.open(filename_))
   {
@@ -39,12 +51,21 @@ void logger::log_into_file(const std::string& filename_)
 
 void logger::log_to_console()
 {
-  stop_logging();
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  stop_logging_locked();
 
   _mode = data::logging_mode::console;
 }
 
 void logger::stop_logging()
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  stop_logging_locked();
+}
+
+void logger::stop_logging_locked()
 {
   if (_fwriter.is_open())
   {
@@ -55,6 +76,10 @@ void logger::stop_logging()
 
 void logger::log(const std::string& msg_)
 {
+  // Messages come from the thread building the precompiled headers as well.
+  // The lock keeps the lines in the file and on the console whole.
+  std::lock_guard<std::mutex> lock(_mutex);
+
   switch (_mode)
   {
   case data::logging_mode::none:
@@ -0,0 +1,216 @@
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <metashell/file_versions.hpp>
+#include <metashell/in_memory_environment.hpp>
+#include <metashell/macro_cache.hpp>
+#include <metashell/process/cancelled.hpp>
+
+#include <boost/algorithm/string/predicate.hpp>
+
+#include <map>
+#include <sstream>
+
+namespace metashell
+{
+  namespace
+  {
+    // Maps the name of the macros to their definition line
+    std::map<std::string, std::string>
+    parse_definitions(const data::cpp_code& macros_)
+    {
+      std::map<std::string, std::string> result;
+
+      std::istringstream s(macros_.value());
+      const std::string prefix = "#define ";
+      for (std::string line; std::getline(s, line);)
+      {
+        if (boost::starts_with(line, prefix))
+        {
+          const std::string::size_type end =
+              line.find_first_of("( ", prefix.size());
+          result[line.substr(prefix.size(), end == std::string::npos ?
+                                                std::string::npos :
+                                                end - prefix.size())] = line;
+        }
+      }
+
+      return result;
+    }
+
+    // Code restoring the macros of an earlier version of the environment. The
+    // predefined macros are changed only when the environment has changed
+    // them.
+    std::string restore(const data::cpp_code& predefined_,
+                        const data::cpp_code& macros_)
+    {
+      const std::map<std::string, std::string> predefined =
+          parse_definitions(predefined_);
+      const std::map<std::string, std::string> macros =
+          parse_definitions(macros_);
+
+      std::string result;
+      for (const auto& m : macros)
+      {
+        const auto p = predefined.find(m.first);
+        if (p == predefined.end())
+        {
+          result += m.second + "\n";
+        }
+        else if (p->second != m.second)
+        {
+          result += "#undef " + m.first + "\n" + m.second + "\n";
+        }
+      }
+      for (const auto& p : predefined)
+      {
+        if (macros.find(p.first) == macros.end())
+        {
+          result += "#undef " + p.first + "\n";
+        }
+      }
+      return result;
+    }
+
+    std::string
+    included_file_versions(const data::cpp_code& env_,
+                           const macro_cache::included_headers& headers_)
+    {
+      // Every include directive contains "include". The headers are not
+      // looked up when there is none.
+      return env_.value().find("include") == std::string::npos ?
+                 std::string() :
+                 file_versions(headers_(env_));
+    }
+  }
+
+  macro_cache::macro_cache(int max_entries_) : _max_entries(max_entries_) {}
+
+  data::cpp_code macro_cache::macros(const std::string& engine_,
+                                     const iface::environment& env_,
+                                     iface::macro_discovery& macro_discovery_,
+                                     const included_headers& included_headers_)
+  {
+    const data::cpp_code env = env_.get_all();
+    const std::string versions =
+        included_file_versions(env, included_headers_);
+
+    const auto i = find(engine_, env, versions);
+    if (i != _entries.end())
+    {
+      _entries.splice(_entries.begin(), _entries, i);
+      return i->macros;
+    }
+
+    const auto earlier = find_earlier_version(engine_, env);
+    if (earlier != _entries.end() &&
+        earlier->versions ==
+            included_file_versions(earlier->env, included_headers_))
+    {
+      const data::cpp_code earlier_env = earlier->env;
+      const boost::filesystem::path& internal_dir =
+          env_.get_headers().internal_dir();
+
+      try
+      {
+        const data::cpp_code result =
+            macro_discovery_.macros(in_memory_environment(
+                definitions(engine_,
+                            in_memory_environment(earlier_env, internal_dir),
+                            macro_discovery_, included_headers_) +
+                    env.value().substr(earlier_env.size()),
+                internal_dir));
+        store(engine_, env, versions, result);
+        return result;
+      }
+      catch (const process::cancelled&)
+      {
+        throw;
+      }
+      catch (const std::exception&)
+      {
+        // Processing the entire environment reports the real error
+      }
+    }
+
+    const data::cpp_code result = macro_discovery_.macros(env_);
+    store(engine_, env, versions, result);
+    return result;
+  }
+
+  data::cpp_code
+  macro_cache::definitions(const std::string& engine_,
+                           const iface::environment& env_,
+                           iface::macro_discovery& macro_discovery_,
+                           const included_headers& included_headers_)
+  {
+    const data::cpp_code predefined = macros(
+        engine_,
+        in_memory_environment(
+            data::cpp_code(), env_.get_headers().internal_dir()),
+        macro_discovery_, included_headers_);
+    return data::cpp_code(restore(
+        predefined,
+        macros(engine_, env_, macro_discovery_, included_headers_)));
+  }
+
+  void macro_cache::clear() { _entries.clear(); }
+
+  std::list<macro_cache::entry>::iterator
+  macro_cache::find(const std::string& engine_,
+                    const data::cpp_code& env_,
+                    const std::string& versions_)
+  {
+    for (auto i = _entries.begin(), e = _entries.end(); i != e; ++i)
+    {
+      if (i->engine == engine_ && i->env == env_ && i->versions == versions_)
+      {
+        return i;
+      }
+    }
+    return _entries.end();
+  }
+
+  std::list<macro_cache::entry>::iterator
+  macro_cache::find_earlier_version(const std::string& engine_,
+                                    const data::cpp_code& env_)
+  {
+    auto result = _entries.end();
+    for (auto i = _entries.begin(), e = _entries.end(); i != e; ++i)
+    {
+      if (i->engine == engine_ && !i->env.empty() &&
+          boost::ends_with(i->env, "\n") && i->env.size() < env_.size() &&
+          boost::starts_with(env_, i->env) &&
+          (result == _entries.end() || result->env.size() < i->env.size()))
+      {
+        result = i;
+      }
+    }
+    return result;
+  }
+
+  void macro_cache::store(const std::string& engine_,
+                          const data::cpp_code& env_,
+                          const std::string& versions_,
+                          const data::cpp_code& macros_)
+  {
+    _entries.push_front(entry{engine_, env_, versions_, macros_});
+    while (_entries.size() > static_cast<std::size_t>(_max_entries))
+    {
+      _entries.pop_back();
+    }
+  }
+}
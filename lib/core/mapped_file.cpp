@@ -0,0 +1,141 @@
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <metashell/exception.hpp>
+#include <metashell/mapped_file.hpp>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace metashell
+{
+  mapped_file::mapped_file() : _data(nullptr), _size(0) {}
+
+  mapped_file::mapped_file(const boost::filesystem::path& path_)
+    : _data(nullptr), _size(0)
+  {
+    const std::string error = "Error mapping " + path_.string();
+
+#ifdef _WIN32
+    const HANDLE file =
+        CreateFileW(path_.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                    OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+      throw exception(error);
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size))
+    {
+      CloseHandle(file);
+      throw exception(error);
+    }
+    _size = static_cast<std::size_t>(size.QuadPart);
+
+    if (_size > 0)
+    {
+      // The view keeps the mapping and the file open
+      const HANDLE mapping =
+          CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+      if (mapping != nullptr)
+      {
+        _data = static_cast<const char*>(
+            MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        CloseHandle(mapping);
+      }
+    }
+    CloseHandle(file);
+#else
+    const int fd = open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1)
+    {
+      throw exception(error);
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == -1)
+    {
+      close(fd);
+      throw exception(error);
+    }
+    _size = static_cast<std::size_t>(st.st_size);
+
+    if (_size > 0)
+    {
+      // The mapping keeps the file open
+      void* data = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (data != MAP_FAILED)
+      {
+        _data = static_cast<const char*>(data);
+        madvise(data, _size, MADV_SEQUENTIAL);
+      }
+    }
+    close(fd);
+#endif
+
+    if (_size > 0 && _data == nullptr)
+    {
+      throw exception(error);
+    }
+  }
+
+  mapped_file::mapped_file(mapped_file&& f_) : _data(f_._data), _size(f_._size)
+  {
+    f_._data = nullptr;
+    f_._size = 0;
+  }
+
+  mapped_file& mapped_file::operator=(mapped_file&& f_)
+  {
+    if (this != &f_)
+    {
+      unmap();
+      _data = f_._data;
+      _size = f_._size;
+      f_._data = nullptr;
+      f_._size = 0;
+    }
+    return *this;
+  }
+
+  mapped_file::~mapped_file() { unmap(); }
+
+  const char* mapped_file::begin() const { return _data; }
+
+  const char* mapped_file::end() const { return _data + _size; }
+
+  std::size_t mapped_file::size() const { return _size; }
+
+  void mapped_file::unmap()
+  {
+    if (_data != nullptr)
+    {
+#ifdef _WIN32
+      UnmapViewOfFile(_data);
+#else
+      munmap(const_cast<char*>(_data), _size);
+#endif
+      _data = nullptr;
+    }
+  }
+}
@@ -21,6 +21,8 @@
 #include <metashell/mdb_shell.hpp>
 #include <metashell/metashell.hpp>
 #include <metashell/null_history.hpp>
+#include <metashell/process/cancel.hpp>
+#include <metashell/process/cancelled.hpp>
 #include <metashell/some_feature_not_supported.hpp>
 
 #include <metashell/data/mdb_usage.hpp>
@@ -232,6 +234,10 @@ namespace metashell
 
       cmd.get_func()(*this, args, displayer_);
     }
+    catch (const process::cancelled&)
+    {
+      displayer_.show_error("Cancelled\n");
+    }
     catch (const std::exception& ex)
     {
       displayer_.show_error(std::string("Error: ") + ex.what() + "\n");
@@ -638,7 +644,7 @@ namespace metashell
         const auto match_count = std::count_if(
             mp->begin(false), mp->end(), [&bp](const data::debugger_event& e) {
               const auto p = mpark::get_if<data::frame>(&e);
-              return p && bp.match(p->node());
+              return p && bp.match(*p);
             });
 
         if (match_count == 0)
@@ -846,7 +852,7 @@ namespace metashell
       }
       for (const breakpoint& bp : breakpoints)
       {
-        if (bp.match(mp->get_current_frame().node()))
+        if (bp.match(mp->get_current_frame()))
         {
           return &bp;
         }
@@ -884,7 +890,7 @@ namespace metashell
     displayer_.show_frame(frame);
 
     data::file_location source_location = frame.source_location();
-    if (source_location.name == _env_path)
+    if (boost::filesystem::path(source_location.name.value()) == _env_path)
     {
       // We don't want to show stuff from the internal header
       source_location = data::file_location();
@@ -981,7 +987,7 @@ namespace metashell
 
   void mdb_shell::cancel_operation()
   {
-    // TODO
+    process::cancel_running_processes();
   }
 
   void mdb_shell::code_complete(const std::string&, std::set<std::string>&)
@@ -42,8 +42,10 @@ namespace metashell
     }
   }
 
-  metaprogram_tracer_clang::metaprogram_tracer_clang(clang_binary clang_binary_)
-    : _clang_binary(clang_binary_)
+  metaprogram_tracer_clang::metaprogram_tracer_clang(
+      clang_binary clang_binary_, bool single_pass_evaluation_)
+    : _clang_binary(clang_binary_),
+      _single_pass_evaluation(single_pass_evaluation_)
   {
   }
 
@@ -54,11 +56,11 @@ namespace metashell
       data::metaprogram_mode mode_,
       iface::displayer& displayer_)
   {
-    const auto out = eval_with_templight_dump_on_stdout(
-        env_, expression_, boost::none, _clang_binary);
+    auto out = eval_with_templight_dump_on_stdout(
+        env_, expression_, boost::none, _clang_binary, _single_pass_evaluation);
 
     const data::result& res = std::get<0>(out);
-    const std::string& trace = std::get<1>(out);
+    std::string& trace = std::get<1>(out);
 
     if (!res.info.empty())
     {
@@ -74,7 +76,8 @@ namespace metashell
     {
       return filter_events(
           yaml_trace(
-              trace, type_or_code_or_error_from_result(res, expression_),
+              std::move(trace),
+              type_or_code_or_error_from_result(res, expression_),
               expression_ ? *expression_ : data::cpp_code("<environment>"),
               mode_),
           determine_from_line(
@@ -16,36 +16,32 @@
 
 #include <metashell/data/stdin_name.hpp>
 #include <metashell/filter_events.hpp>
+#include <metashell/in_memory_environment.hpp>
+#include <metashell/make_unique.hpp>
 #include <metashell/metaprogram_tracer_templight.hpp>
 #include <metashell/protobuf_trace.hpp>
 
+#include <future>
+#include <memory>
+#include <string>
+
 namespace
 {
   metashell::data::type_or_code_or_error
-  run_metaprogram(metashell::clang_binary& clang_binary_,
-                  const boost::optional<metashell::data::cpp_code>& expression_,
-                  const boost::filesystem::path& output_path_,
-                  metashell::iface::environment& env_,
-                  metashell::iface::displayer& displayer_)
+  to_evaluation_result(
+      const metashell::data::result& res_,
+      const boost::optional<metashell::data::cpp_code>& expression_)
   {
     using metashell::data::type_or_code_or_error;
 
-    const metashell::data::result res = metashell::eval(
-        env_, expression_, boost::none, output_path_, clang_binary_);
-
-    if (!res.info.empty())
-    {
-      displayer_.show_raw_text(res.info);
-    }
-
-    if (!res.successful)
+    if (!res_.successful)
     {
-      return type_or_code_or_error::make_error(res.error);
+      return type_or_code_or_error::make_error(res_.error);
     }
     else if (expression_)
     {
       return type_or_code_or_error::make_type(
-          metashell::data::type(res.output));
+          metashell::data::type(res_.output));
     }
     else
     {
@@ -57,8 +53,15 @@ namespace
 namespace metashell
 {
   metaprogram_tracer_templight::metaprogram_tracer_templight(
-      clang_binary templight_binary_)
-    : _templight_binary(templight_binary_)
+      clang_binary templight_binary_,
+      bool single_pass_evaluation_,
+      bool compress_template_names_,
+      bool stream_trace_)
+    : _templight_binary(templight_binary_),
+      _single_pass_evaluation(single_pass_evaluation_),
+      _compress_template_names(compress_template_names_),
+      _stream_trace(stream_trace_),
+      _traces(0)
   {
   }
 
@@ -70,17 +73,71 @@ namespace metashell
       data::metaprogram_mode mode_,
       iface::displayer& displayer_)
   {
+    const data::cpp_code root_name =
+        expression_ ? *expression_ : data::cpp_code("<environment>");
+    const boost::optional<data::file_location> from_line = determine_from_line(
+        env_.get(), expression_, data::stdin_name_in_clang());
+
+#ifndef _WIN32
+    if (_stream_trace)
+    {
+      // The trace of an earlier evaluation may still be being written. Every
+      // evaluation gets its own pipe to keep them apart.
+      const boost::filesystem::path output_path =
+          temp_dir_ / ("templight" + std::to_string(++_traces) + ".pb");
+
+      std::unique_ptr<named_pipe> trace = metashell::make_unique<named_pipe>(
+          output_path.string() + ".trace.pbf");
+
+      // The compilation runs in the background while the trace is being
+      // read. It gets the code the compiler is given for the environment
+      // (env_.get()) and the internal directory by value. For a header file
+      // environment the code is the #include of the header. The header is
+      // not changed while mdb is running: mdb turns the precompiled headers
+      // off and the shell is not reading commands. The destructor of the
+      // trace waits for the compilation to finish.
+      std::future<data::type_or_code_or_error> evaluation_result = std::async(
+          std::launch::async,
+          [binary = _templight_binary, single_pass = _single_pass_evaluation,
+           dump = templight_dump{output_path, _compress_template_names, true},
+           env_code = env_.get(),
+           internal_dir = env_.get_headers().internal_dir(),
+           expression_]() mutable {
+            const in_memory_environment env(env_code, internal_dir);
+            data::result res = metashell::eval(
+                env, expression_, boost::none, dump, binary, single_pass);
+
+            // The info can not be displayed from this thread. It is reported
+            // with the error instead of being lost.
+            if (!res.successful && !res.info.empty())
+            {
+              res.error = res.info + res.error;
+            }
+            return to_evaluation_result(res, expression_);
+          });
+
+      return filter_events(protobuf_trace(std::move(trace),
+                                          std::move(evaluation_result),
+                                          root_name, mode_),
+                           from_line);
+    }
+#endif
+
     const boost::filesystem::path output_path = temp_dir_ / "templight.pb";
 
-    const data::type_or_code_or_error evaluation_result = run_metaprogram(
-        _templight_binary, expression_, output_path, env_, displayer_);
+    const data::result res = metashell::eval(
+        env_, expression_, boost::none,
+        templight_dump{output_path, _compress_template_names, false},
+        _templight_binary, _single_pass_evaluation);
+
+    if (!res.info.empty())
+    {
+      displayer_.show_raw_text(res.info);
+    }
 
-    return filter_events(
-        protobuf_trace(
-            output_path.string() + ".trace.pbf", evaluation_result,
-            expression_ ? *expression_ : data::cpp_code("<environment>"),
-            mode_),
-        determine_from_line(
-            env_.get(), expression_, data::stdin_name_in_clang()));
+    return filter_events(protobuf_trace(output_path.string() + ".trace.pbf",
+                                        to_evaluation_result(res, expression_),
+                                        root_name, mode_),
+                         from_line);
   }
 }
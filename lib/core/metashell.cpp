@@ -28,6 +28,7 @@
 #include <boost/optional.hpp>
 #include <metashell/boost/regex.hpp>
 
+#include <cstring>
 #include <fstream>
 #include <memory>
 
@@ -59,6 +60,86 @@ namespace
     }
     return t;
   }
+
+  bool starts_with(const char* begin_, const char* end_, const char* prefix_)
+  {
+    for (; *prefix_ != 0; ++begin_, ++prefix_)
+    {
+      if (begin_ == end_ || *begin_ != *prefix_)
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Skips prefix_ when [begin_, end_) starts with it
+  const char* skip(const char* begin_, const char* end_, const char* prefix_)
+  {
+    return starts_with(begin_, end_, prefix_) ? begin_ + std::strlen(prefix_) :
+                                                begin_;
+  }
+
+  // Checks if [begin_, end_) starts with
+  //   ' 'void ([void])[ __attribute__((thiscall))][ noexcept]'
+  bool is_constructor_type(const char* begin_, const char* end_)
+  {
+    const char* p = skip(begin_, end_, "' 'void (");
+    if (p == begin_)
+    {
+      return false;
+    }
+    p = skip(p, end_, "void");
+    if (!starts_with(p, end_, ")"))
+    {
+      return false;
+    }
+    p = skip(p + 1, end_, " __attribute__((thiscall))");
+    p = skip(p, end_, " noexcept");
+    return starts_with(p, end_, "'");
+  }
+
+  // Checks if [begin_, end_) starts with ':'[struct ]metashell::impl::wrap
+  // and returns the end of it.
+  const char* skip_wrap(const char* begin_, const char* end_)
+  {
+    const char* p = skip(begin_, end_, "':'");
+    if (p == begin_)
+    {
+      return begin_;
+    }
+    p = skip(p, end_, "struct ");
+    const char* const after_wrap = skip(p, end_, "metashell::impl::wrap");
+    return after_wrap == p ? begin_ : after_wrap;
+  }
+
+  // Returns the (untrimmed) TYPE in
+  //   ...':'[struct ]metashell::impl::wrap[<]TYPE>' 'void (...)...'...
+  // The rightmost constructor type and the rightmost wrap before it are used.
+  // Every character of the line is visited at most twice.
+  boost::optional<std::pair<const char*, const char*>>
+  find_wrapped_type(const char* begin_, const char* end_)
+  {
+    for (const char* type_end = end_; type_end != begin_;)
+    {
+      --type_end;
+      if (*type_end == '>' && is_constructor_type(type_end + 1, end_))
+      {
+        for (const char* p = type_end; p != begin_;)
+        {
+          --p;
+          const char* const after_wrap = skip_wrap(p, type_end);
+          if (after_wrap != p)
+          {
+            return std::make_pair(skip(after_wrap, type_end, "<"), type_end);
+          }
+        }
+        // There is no wrap before the earlier constructor types either
+        return boost::none;
+      }
+    }
+    return boost::none;
+  }
 } // anonymous namespace
 
 std::string metashell::repair_type_string(const std::string& type)
@@ -75,36 +156,32 @@ std::string metashell::repair_type_string(const std::string& type)
 
 std::string metashell::get_type_from_ast_string(const std::string& ast)
 {
-  // This algorithm is very ugly, but it basically iterates on the
-  // lines of the ast dump from the end until it finds the interesting line.
-
-  std::size_t end_index = std::string::npos;
-  std::size_t start_index = ast.find_last_of('\n');
+  // The dump is scanned from the end line by line (the interesting line is
+  // close to the end) without copying the lines. The interesting line is the
+  // one of the constructor call of __metashell_v.
 
-  boost::regex reg(
-      ".*':'(?:struct )?metashell::impl::wrap<?(.*)>' "
-      "'void \\((?:void)?\\)"
-      "(?: __attribute__\\(\\(thiscall\\)\\)|(?:))(?: noexcept|(?:))'.*");
+  const char* const begin = ast.data();
+  const char* line_end = begin + ast.size();
 
-  std::string line;
-  while (true)
+  while (line_end != begin)
   {
-    end_index = start_index;
-    start_index = ast.find_last_of('\n', end_index - 1);
-
-    if (start_index == std::string::npos || end_index == std::string::npos)
+    const char* line_begin = line_end;
+    while (line_begin != begin && *(line_begin - 1) != '\n')
     {
-      throw exception("No suitable ast line in dump");
+      --line_begin;
     }
 
-    line = ast.substr(start_index + 1, end_index - start_index - 1);
-
-    boost::smatch match;
-    if (boost::regex_match(line, match, reg))
+    if (const boost::optional<std::pair<const char*, const char*>> type =
+            find_wrapped_type(line_begin, line_end))
     {
-      return repair_type_string(boost::trim_copy(std::string(match[1])));
+      return repair_type_string(
+          boost::trim_copy(std::string(type->first, type->second)));
     }
+
+    line_end = line_begin == begin ? begin : line_begin - 1;
   }
+
+  throw exception("No suitable ast line in dump");
 }
 
 bool metashell::is_environment_setup_command(
@@ -0,0 +1,121 @@
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <metashell/exception.hpp>
+#include <metashell/named_pipe.hpp>
+
+#include <boost/filesystem/operations.hpp>
+
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <string>
+#include <utility>
+
+namespace metashell
+{
+  named_pipe::named_pipe(boost::filesystem::path path_)
+    : _path(std::move(path_)), _read_fd(-1), _write_fd(-1)
+  {
+#ifdef _WIN32
+    throw exception("Named pipes are not supported on Windows");
+#else
+    const std::string error = "Error creating named pipe " + _path.string();
+
+    // The leftover of an earlier run may be still there
+    boost::system::error_code ignore;
+    boost::filesystem::remove(_path, ignore);
+
+    if (mkfifo(_path.c_str(), 0600) == -1)
+    {
+      throw exception(error);
+    }
+
+    // The read end is opened first: opening the write end of a pipe nobody
+    // reads fails with O_NONBLOCK and blocks without it.
+    _read_fd = open(_path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (_read_fd != -1)
+    {
+      _write_fd = open(_path.c_str(), O_WRONLY | O_CLOEXEC);
+    }
+
+    if (_write_fd == -1)
+    {
+      if (_read_fd != -1)
+      {
+        close(_read_fd);
+      }
+      unlink(_path.c_str());
+      throw exception(error);
+    }
+#endif
+  }
+
+  named_pipe::~named_pipe()
+  {
+#ifndef _WIN32
+    // Writers opening the pipe by its path after this point create a regular
+    // file instead of blocking. The ones writing into it get EPIPE once the
+    // read end is closed.
+    unlink(_path.c_str());
+    close(_write_fd);
+    close(_read_fd);
+#endif
+  }
+
+  const boost::filesystem::path& named_pipe::path() const { return _path; }
+
+  std::size_t named_pipe::read(char* buff_, std::size_t size_)
+  {
+#ifdef _WIN32
+    (void)buff_;
+    (void)size_;
+    return 0;
+#else
+    while (true)
+    {
+      const ssize_t len = ::read(_read_fd, buff_, size_);
+      if (len >= 0)
+      {
+        return static_cast<std::size_t>(len);
+      }
+      else if (errno != EINTR)
+      {
+        // EAGAIN: there is nothing to read
+        return 0;
+      }
+    }
+#endif
+  }
+
+  void named_pipe::wait(int timeout_ms_)
+  {
+#ifdef _WIN32
+    (void)timeout_ms_;
+#else
+    pollfd fd;
+    fd.fd = _read_fd;
+    fd.events = POLLIN;
+    fd.revents = 0;
+    poll(&fd, 1, timeout_ms_);
+#endif
+  }
+}
@@ -189,11 +189,22 @@ namespace
         " argument after --";
   };
 
+  int non_negative(int value_, const std::string& name_)
+  {
+    if (value_ < 0)
+    {
+      throw std::runtime_error("The value of --" + name_ +
+                               " should not be negative.");
+    }
+    return value_;
+  }
+
   data::shell_config
   parse_default_shell_config(const boost::program_options::variables_map& vm_,
                              const char** extra_args_begin_,
                              const char** extra_args_end_,
-                             const std::string& engine_)
+                             const std::string& engine_,
+                             const data::resource_limits& limits_)
   {
     data::shell_config result;
     result.name = data::shell_config_name("default");
@@ -207,6 +218,10 @@ namespace
     }
     result.use_precompiled_headers = !vm_.count("no_precompiled_headers");
     result.preprocessor_mode = vm_.count("preprocessor");
+    result.single_pass_evaluation = !vm_.count("no_single_pass_evaluation");
+    result.limits.wall_time = non_negative(limits_.wall_time, "timeout");
+    result.limits.cpu_time = non_negative(limits_.cpu_time, "cpu_time_limit");
+    result.limits.memory = non_negative(limits_.memory, "memory_limit");
 
     return result;
   }
@@ -256,6 +271,12 @@ metashell::parse_config(int argc_,
 
   std::vector<boost::filesystem::path> configs_to_load;
 
+  const std::uintmax_t megabyte = 1024 * 1024;
+  std::uintmax_t eval_cache_size = cfg.max_eval_cache_size / megabyte;
+  std::uintmax_t pch_cache_size = cfg.max_pch_cache_size / megabyte;
+
+  data::resource_limits limits;
+
   options_description desc("Options");
   // clang-format off
   desc.add_options()
@@ -272,6 +293,18 @@ metashell::parse_config(int argc_,
       "disable_saving",
       "Disable saving the environment using the #msh environment save"
     )
+    (
+      "compress_template_names",
+      "Make Templight store the zlib compressed template names in the"
+      " metaprogram traces instead of a dictionary of the names. It makes the"
+      " traces of long, rarely repeated names smaller and slower to read."
+    )
+    (
+      "stream_templight_trace",
+      "Make the internal engine read the metaprogram traces through a named"
+      " pipe while the Templight shipped with Metashell is writing them"
+      " (experimental)."
+    )
     (
       "console", value(&con_type)->default_value(con_type),
       "Console type. Possible values: plain, readline, json"
@@ -281,9 +314,50 @@ metashell::parse_config(int argc_,
       "log", value(&cfg.log_file),
       "Log into a file. When it is set to -, it logs into the console."
     )
+    (
+      "cache_dir", value(&cfg.cache_dir),
+      "Cache the evaluation results and the include path of the compiler in"
+      " this directory. They are not cached when it is not set."
+    )
+    (
+      "eval_cache_size",
+      value(&eval_cache_size)->default_value(eval_cache_size),
+      "The maximum size of the evaluation cache in megabytes."
+    )
+    (
+      "pch_cache_size",
+      value(&pch_cache_size)->default_value(pch_cache_size),
+      "The maximum size of the precompiled headers kept for the earlier"
+      " versions of the environment in megabytes."
+    )
+    (
+      "code_completion_timeout",
+      value(&cfg.code_completion_timeout)
+        ->default_value(cfg.code_completion_timeout),
+      "Display the code completion candidates found after this many"
+      " milliseconds. The compiler keeps completing the code in the background."
+      " 0 means no limit."
+    )
     ("engine", value(&engine), engine_info.c_str())
     ("help_engine", value(&help_engine), "Display help about the engine")
     ("preprocessor", "Starts the shell in preprocessor mode")
+    (
+      "no_single_pass_evaluation",
+      "Preprocess the code in a separate compiler run before evaluating it."
+    )
+    (
+      "timeout", value(&limits.wall_time)->default_value(limits.wall_time),
+      "Stop the compiler after this many seconds. 0 means no limit."
+    )
+    (
+      "cpu_time_limit",
+      value(&limits.cpu_time)->default_value(limits.cpu_time),
+      "The CPU time (in seconds) the compiler can use. 0 means no limit."
+    )
+    (
+      "memory_limit", value(&limits.memory)->default_value(limits.memory),
+      "The memory (in megabytes) the compiler can use. 0 means no limit."
+    )
     ("load_configs", value(&configs_to_load), "Load configs from a file.");
   // clang-format on
 
@@ -333,6 +407,12 @@ metashell::parse_config(int argc_,
     cfg.indent = vm.count("indent") != 0;
     cfg.con_type = metashell::data::parse_console_type(con_type);
     cfg.saving_enabled = !vm.count("disable_saving");
+    cfg.compress_template_names = vm.count("compress_template_names") != 0;
+    cfg.stream_templight_trace = vm.count("stream_templight_trace") != 0;
+    cfg.max_eval_cache_size = eval_cache_size * megabyte;
+    cfg.max_pch_cache_size = pch_cache_size * megabyte;
+    cfg.code_completion_timeout = non_negative(
+        cfg.code_completion_timeout, "code_completion_timeout");
     cfg.splash_enabled = vm.count("nosplash") == 0;
     if (vm.count("log") == 0)
     {
@@ -345,7 +425,8 @@ metashell::parse_config(int argc_,
     }
 
     cfg.push_back(
-        parse_default_shell_config(vm, extra_args_begin, args_end, engine));
+        parse_default_shell_config(
+            vm, extra_args_begin, args_end, engine, limits));
 
     for (const boost::filesystem::path& config_path : configs_to_load)
     {
@@ -179,7 +179,8 @@ namespace
                          env_detector_, displayer_, logger_),
         extra_clang_args, internal_dir_, env_detector_, logger_);
 
-    metashell::header_discoverer_clang header_discoverer(cbin);
+    metashell::header_discoverer_clang header_discoverer(
+        cbin, boost::filesystem::path(), internal_dir_);
 
     metashell::data::wave_config result;
     result.includes.sys =
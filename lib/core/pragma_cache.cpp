@@ -0,0 +1,37 @@
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <metashell/pragma_cache.hpp>
+#include <metashell/shell.hpp>
+
+using namespace metashell;
+
+pragma_cache::pragma_cache(shell& shell_) : _shell(shell_) {}
+
+iface::pragma_handler* pragma_cache::clone() const
+{
+  return new pragma_cache(_shell);
+}
+
+std::string pragma_cache::description() const
+{
+  return "Displays statistics about the cache of the evaluation results.";
+}
+
+void pragma_cache::run(iface::displayer& displayer_) const
+{
+  _shell.display_cache_statistics(displayer_);
+}
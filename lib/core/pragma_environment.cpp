@@ -15,14 +15,15 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <metashell/pragma_environment.hpp>
+#include <metashell/shell.hpp>
 
 using namespace metashell;
 
-pragma_environment::pragma_environment(iface::environment& env_) : _env(env_) {}
+pragma_environment::pragma_environment(const shell& shell_) : _shell(shell_) {}
 
 iface::pragma_handler* pragma_environment::clone() const
 {
-  return new pragma_environment(_env);
+  return new pragma_environment(_shell);
 }
 
 std::string pragma_environment::description() const
@@ -32,5 +33,5 @@ std::string pragma_environment::description() const
 
 void pragma_environment::run(iface::displayer& displayer_) const
 {
-  displayer_.show_cpp_code(_env.get_all());
+  displayer_.show_cpp_code(_shell.env().get_all());
 }
@@ -23,15 +23,14 @@
 
 using namespace metashell;
 
-pragma_environment_save::pragma_environment_save(const data::config& config_,
-                                                 const iface::environment& env_)
-  : _config(config_), _env(env_)
+pragma_environment_save::pragma_environment_save(const shell& shell_)
+  : _shell(shell_)
 {
 }
 
 iface::pragma_handler* pragma_environment_save::clone() const
 {
-  return new pragma_environment_save(_config, _env);
+  return new pragma_environment_save(_shell);
 }
 
 std::string pragma_environment_save::arguments() const { return "<path>"; }
@@ -49,7 +48,7 @@ void pragma_environment_save::run(const data::command::iterator&,
                                   const data::command::iterator& args_end_,
                                   iface::displayer& displayer_) const
 {
-  if (_config.saving_enabled)
+  if (_shell.get_config().saving_enabled)
   {
     const std::string fn =
         boost::trim_copy(tokens_to_string(args_begin_, args_end_)).value();
@@ -62,7 +61,7 @@ void pragma_environment_save::run(const data::command::iterator&,
     else
     {
       std::ofstream f(fn.c_str());
-      f << _env.get_all() << std::endl;
+      f << _shell.env().get_all() << std::endl;
       if (f.fail() || f.bad())
       {
         displayer_.show_error("Failed to save the environment into file " + fn);
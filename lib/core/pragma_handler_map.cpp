@@ -19,6 +19,8 @@
 #include <metashell/pragma_handler_map.hpp>
 #include <metashell/shell.hpp>
 
+#include <metashell/pragma_cache.hpp>
+#include <metashell/pragma_cache_clear.hpp>
 #include <metashell/pragma_config.hpp>
 #include <metashell/pragma_config_load.hpp>
 #include <metashell/pragma_config_show.hpp>
@@ -35,6 +37,7 @@
 #include <metashell/pragma_help.hpp>
 #include <metashell/pragma_included_headers.hpp>
 #include <metashell/pragma_includes.hpp>
+#include <metashell/pragma_limit.hpp>
 #include <metashell/pragma_ls.hpp>
 #include <metashell/pragma_macro.hpp>
 #include <metashell/pragma_macro_names.hpp>
@@ -198,15 +201,14 @@ pragma_handler_map::build_default(shell& shell_,
                "precompiled header usage",
                [&shell_]() { return shell_.using_precompiled_headers(); },
                [&shell_](bool v_) { shell_.using_precompiled_headers(v_); }))
-      .add("environment", pragma_environment(shell_.env()))
+      .add("environment", pragma_environment(shell_))
       .add("environment", "push", pragma_environment_push(shell_))
       .add("environment", "pop", pragma_environment_pop(shell_))
       .add("environment", "stack", pragma_environment_stack(shell_))
       .add("environment", "add", pragma_environment_add(shell_))
       .add("environment", "reset", pragma_environment_reset(shell_))
       .add("environment", "reload", pragma_environment_reload(shell_))
-      .add("environment", "save",
-           pragma_environment_save(shell_.get_config(), shell_.env()))
+      .add("environment", "save", pragma_environment_save(shell_))
       .add("preprocessed", "echo",
            pragma_switch("display preprocessed commands",
                          [&shell_]() { return shell_.echo(); },
@@ -241,6 +243,32 @@ pragma_handler_map::build_default(shell& shell_,
       .add("config", pragma_config(shell_))
       .add("config", "show", pragma_config_show(shell_))
       .add("config", "load", pragma_config_load(shell_))
+      .add("cache", pragma_cache(shell_))
+      .add("cache", "clear", pragma_cache_clear(shell_))
+      .add("limit", "timeout",
+           pragma_limit("wall-clock time", "seconds",
+                        [&shell_]() { return shell_.limits().wall_time; },
+                        [&shell_](int v_) {
+                          data::resource_limits l = shell_.limits();
+                          l.wall_time = v_;
+                          shell_.limits(l);
+                        }))
+      .add("limit", "cpu_time",
+           pragma_limit("CPU time", "seconds",
+                        [&shell_]() { return shell_.limits().cpu_time; },
+                        [&shell_](int v_) {
+                          data::resource_limits l = shell_.limits();
+                          l.cpu_time = v_;
+                          shell_.limits(l);
+                        }))
+      .add("limit", "memory",
+           pragma_limit("memory", "megabytes",
+                        [&shell_]() { return shell_.limits().memory; },
+                        [&shell_](int v_) {
+                          data::resource_limits l = shell_.limits();
+                          l.memory = v_;
+                          shell_.limits(l);
+                        }))
       .add("quit", pragma_quit(shell_));
 }
 
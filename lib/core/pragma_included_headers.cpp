@@ -51,9 +51,8 @@ void pragma_included_headers::run(const data::command::iterator&,
 {
   const data::cpp_code env = _shell.env().get_all();
 
-  auto& header_discoverer = _shell.engine().header_discoverer();
-
-  const auto by_current_env = header_discoverer.files_included_by(env);
+  const std::set<boost::filesystem::path> by_current_env =
+      _shell.files_included_by(env).headers();
 
   if (args_begin_ == args_end_)
   {
@@ -61,11 +60,11 @@ void pragma_included_headers::run(const data::command::iterator&,
   }
   else
   {
-    const auto by_ext_env = header_discoverer.files_included_by(
+    const data::include_graph by_ext_env = _shell.files_included_by(
         env + "\n" + data::tokens_to_string(args_begin_, args_end_));
 
     std::set<boost::filesystem::path> new_headers;
-    for (const boost::filesystem::path& p : by_ext_env)
+    for (const boost::filesystem::path& p : by_ext_env.headers())
     {
       if (by_current_env.find(p) == by_current_env.end())
       {
@@ -0,0 +1,105 @@
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <metashell/metashell_pragma.hpp>
+#include <metashell/pragma_limit.hpp>
+
+#include <boost/optional.hpp>
+
+#include <cctype>
+#include <limits>
+
+using namespace metashell;
+
+namespace
+{
+  boost::optional<int> parse_limit(const std::string& s_)
+  {
+    long long value = 0;
+    for (char c : s_)
+    {
+      if (!std::isdigit(static_cast<unsigned char>(c)))
+      {
+        return boost::none;
+      }
+      value = value * 10 + (c - '0');
+      if (value > std::numeric_limits<int>::max())
+      {
+        return boost::none;
+      }
+    }
+    return s_.empty() ? boost::none : boost::make_optional(int(value));
+  }
+}
+
+pragma_limit::pragma_limit(const std::string& name_,
+                           const std::string& unit_,
+                           const std::function<int()>& query_,
+                           const std::function<void(int)>& update_)
+  : _query(query_), _update(update_), _name(name_), _unit(unit_)
+{
+}
+
+iface::pragma_handler* pragma_limit::clone() const
+{
+  return new pragma_limit(_name, _unit, _query, _update);
+}
+
+std::string pragma_limit::arguments() const { return "[<" + _unit + ">]"; }
+
+std::string pragma_limit::description() const
+{
+  return "Sets the " + _name + " limit of the compiler in " + _unit +
+         ". 0 means no limit. When no arguments are used, it displays the "
+         "current limit.";
+}
+
+void pragma_limit::run(const data::command::iterator&,
+                       const data::command::iterator&,
+                       const data::command::iterator& args_begin_,
+                       const data::command::iterator& args_end_,
+                       iface::displayer& displayer_) const
+{
+  auto i = args_begin_;
+
+  if (i != args_end_)
+  {
+    const std::string v = i->value().value();
+    if (const boost::optional<int> limit = parse_limit(v))
+    {
+      ++i;
+      if (i == args_end_)
+      {
+        _update(*limit);
+      }
+      else
+      {
+        displayer_.show_error("Invalid arguments after " + v + ": " +
+                              tokens_to_string(i, args_end_).value());
+      }
+    }
+    else
+    {
+      displayer_.show_error("Invalid argument " + v +
+                            ". It should be a non-negative integer.");
+    }
+  }
+
+  const int limit = _query();
+  displayer_.show_comment(
+      data::text(_name + " limit: " +
+                 (limit == 0 ? "none" : std::to_string(limit) + " " + _unit)));
+}
@@ -66,19 +66,6 @@ namespace
     return result;
   }
 
-  boost::filesystem::path resolve_symlink(boost::filesystem::path p_)
-  {
-    std::set<boost::filesystem::path> visited;
-
-    while (visited.find(p_) == visited.end() && is_symlink(p_))
-    {
-      visited.insert(p_);
-      p_ = read_symlink(p_);
-    }
-
-    return p_;
-  }
-
   void display(iface::displayer& displayer_,
                const std::string& type_,
                const std::set<data::include_argument>& paths_,
@@ -128,8 +115,7 @@ void pragma_ls::run(const data::command::iterator& name_begin_,
   std::set<data::include_argument> headers;
 
   include_path_cache paths(_shell.engine().header_discoverer());
-
-  const boost::filesystem::directory_iterator end;
+  include_index& index = _shell.include_path_index();
 
   for (const data::include_argument& arg :
        parse_arguments(data::tokens_to_string(name_begin_, name_end_).value(),
@@ -137,28 +123,31 @@ void pragma_ls::run(const data::command::iterator& name_begin_,
   {
     for (const boost::filesystem::path& p : paths[arg.type])
     {
-      const boost::filesystem::path path = resolve_symlink(p / arg.path);
+      const boost::optional<include_index::entry_type> type =
+          arg.path.empty() ? include_index::entry_type::directory :
+                             index.type(p / arg.path);
 
-      if (is_regular_file(path))
+      if (type == include_index::entry_type::file)
       {
         headers.insert({arg.type, arg.path});
       }
-      else if (is_directory(path))
+      else if (type == include_index::entry_type::directory)
       {
-        for (boost::filesystem::directory_iterator i(path); i != end; ++i)
+        if (const auto entries = index.list(p / arg.path))
         {
-          const boost::filesystem::path f = resolve_symlink(i->path());
-
-          const data::include_argument entry{
-              arg.type, arg.path / i->path().filename()};
-
-          if (is_regular_file(*i))
-          {
-            headers.insert(entry);
-          }
-          else if (is_directory(*i))
+          for (const auto& entry : *entries)
           {
-            dirs.insert(entry);
+            const data::include_argument include{
+                arg.type, arg.path / entry.first};
+
+            if (entry.second == include_index::entry_type::file)
+            {
+              headers.insert(include);
+            }
+            else if (entry.second == include_index::entry_type::directory)
+            {
+              dirs.insert(include);
+            }
           }
         }
       }
@@ -84,6 +84,5 @@ std::string pragma_macro_names::description() const
 
 void pragma_macro_names::run(iface::displayer& displayer_) const
 {
-  displayer_.show_cpp_code(extract_macro_names(
-      _shell.engine().macro_discovery().macros(_shell.env())));
+  displayer_.show_cpp_code(extract_macro_names(_shell.macros()));
 }
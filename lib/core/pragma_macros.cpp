@@ -32,6 +32,5 @@ std::string pragma_macros::description() const
 
 void pragma_macros::run(iface::displayer& displayer_) const
 {
-  displayer_.show_cpp_code(
-      _shell.engine().macro_discovery().macros(_shell.env()));
+  displayer_.show_cpp_code(_shell.macros());
 }
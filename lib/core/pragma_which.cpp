@@ -56,11 +56,12 @@ void pragma_which::run(const data::command::iterator& name_begin_,
                       args_begin_, args_end_);
   const auto include_path =
       _shell.engine().header_discoverer().include_path(args.header.type);
+  include_index& index = _shell.include_path_index();
   const auto files =
       include_path |
       transformed(std::function<path(const path&)>(
           [&args](const path& path_) { return path_ / args.header.path; })) |
-      filtered([](const path& path_) { return exists(path_); });
+      filtered([&index](const path& path_) { return bool(index.type(path_)); });
 
   if (files.empty())
   {
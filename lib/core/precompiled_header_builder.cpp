@@ -0,0 +1,590 @@
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <metashell/content_hash.hpp>
+#include <metashell/exception.hpp>
+#include <metashell/file_versions.hpp>
+#include <metashell/precompiled_header_builder.hpp>
+#include <metashell/process/cancelled.hpp>
+
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/algorithm/string/trim.hpp>
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <set>
+
+namespace metashell
+{
+  namespace
+  {
+    // The number of precompiled headers in a chain before it is replaced by
+    // one precompiled header.
+    const std::vector<boost::filesystem::path>::size_type max_chain_length =
+        8;
+
+    void write_file(const boost::filesystem::path& fn_,
+                    const std::string& content_)
+    {
+      std::ofstream f(fn_.string(), std::ios::binary);
+      if (!(f << content_))
+      {
+        throw exception("Error writing " + fn_.string());
+      }
+    }
+
+    boost::filesystem::path code_of(boost::filesystem::path pch_)
+    {
+      return pch_.replace_extension(".hpp");
+    }
+
+    boost::filesystem::path dependencies_of(boost::filesystem::path pch_)
+    {
+      return pch_.replace_extension(".d");
+    }
+
+    void remove_chunk(const boost::filesystem::path& pch_)
+    {
+      boost::system::error_code ec;
+      boost::filesystem::remove(pch_, ec);
+      boost::filesystem::remove(code_of(pch_), ec);
+      boost::filesystem::remove(dependencies_of(pch_), ec);
+    }
+
+    // The headers in the dependency file clang writes (-MD -MF) about an
+    // element of the chain, apart from the code of the element itself. The
+    // format is "<target>: <header> <header> \<new line> <header> ...",
+    // where spaces in the file names are escaped by a backslash.
+    data::include_graph read_dependencies(const boost::filesystem::path& pch_)
+    {
+      std::ifstream f(dependencies_of(pch_).string());
+      const std::string deps{
+          std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>()};
+
+      data::include_graph result;
+      const auto target_end = deps.find(": ");
+      if (target_end == std::string::npos)
+      {
+        return result;
+      }
+
+      const auto add = [&result, &pch_](const std::string& header_) {
+        if (!header_.empty() && header_ != code_of(pch_).string())
+        {
+          result.add(boost::filesystem::path(), header_);
+        }
+      };
+
+      std::string header;
+      for (auto i = deps.begin() + target_end + 1, e = deps.end(); i != e; ++i)
+      {
+        if (*i == '\\' && i + 1 != e && (i[1] == ' ' || i[1] == '\n'))
+        {
+          ++i;
+          if (*i == ' ')
+          {
+            header += ' ';
+          }
+        }
+        else if (*i == ' ' || *i == '\n' || *i == '\t' || *i == '\r')
+        {
+          add(header);
+          header.clear();
+        }
+        else
+        {
+          header += *i;
+        }
+      }
+      add(header);
+      return result;
+    }
+
+    std::string versions_of(const data::include_graph& headers_)
+    {
+      content_hash h;
+      add_file_versions(h, headers_);
+      return h.hex();
+    }
+
+    std::uintmax_t size_of_chunk(const boost::filesystem::path& pch_)
+    {
+      return boost::filesystem::file_size(pch_) +
+             boost::filesystem::file_size(code_of(pch_));
+    }
+
+    bool accepted(const data::process_output& o_)
+    {
+      const std::string err =
+          boost::algorithm::trim_copy(o_.standard_output + o_.standard_error);
+
+      // clang displays this even when "-w" is used. This can be ignored
+      return o_.exit_code == data::exit_code_t(0) &&
+             (err.empty() ||
+              err == "warning: precompiled header used __DATE__ or __TIME__." ||
+              err == "warning: precompiled header used __DATE__ or __TIME__. "
+                     "[-Wpch-date-time]");
+    }
+  }
+
+  precompiled_header_builder::precompiled_header_builder(
+      clang_binary clang_binary_,
+      std::uintmax_t max_cache_size_,
+      logger* logger_)
+    : _clang_binary(std::move(clang_binary_)),
+      _compiler_id(_clang_binary.id()),
+      _max_cache_size(max_cache_size_),
+      _logger(logger_),
+      _thread([this] { run(); })
+  {
+  }
+
+  precompiled_header_builder::~precompiled_header_builder()
+  {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _stopping = true;
+    }
+    _changed.notify_all();
+    _thread.join();
+  }
+
+  void
+  precompiled_header_builder::update(const boost::filesystem::path& header_,
+                                     std::string content_)
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    // The precompiled header of this version has already been built. It is
+    // published again, because another builder may have replaced it.
+    if (!_next && !_building && reuse(content_))
+    {
+      try
+      {
+        publish_precompiled_header(_chain.back(), header_);
+        return;
+      }
+      catch (const std::exception& e)
+      {
+        METASHELL_LOG(_logger, "Error publishing precompiled header of " +
+                                   header_.string() + ": " + e.what());
+      }
+    }
+
+    // The precompiled header of the previous version can not be used any
+    // more.
+    boost::system::error_code ec;
+    boost::filesystem::remove(precompiled_header_of(header_), ec);
+
+    _next = job{header_, std::move(content_)};
+    _changed.notify_all();
+  }
+
+  void precompiled_header_builder::wait()
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _changed.wait(lock, [this] { return !_next && !_building; });
+  }
+
+  data::result
+  precompiled_header_builder::precompile(const boost::filesystem::path& header_,
+                                         std::string content_)
+  {
+    // The chain is extended by the current thread
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _changed.wait(lock, [this] { return !_next && !_building; });
+      _building = true;
+    }
+
+    const auto done = [this] {
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _building = false;
+      }
+      _changed.notify_all();
+    };
+
+    data::result result;
+    try
+    {
+      const job j{header_, std::move(content_)};
+      const data::process_output o = compile(j, true);
+      const std::string err = o.standard_output + o.standard_error;
+
+      result.successful = accepted(o);
+      result.error = result.successful ? std::string() : err;
+      if (result.successful)
+      {
+        publish_precompiled_header(_chain.back(), j.header);
+      }
+    }
+    catch (const process::cancelled&)
+    {
+      // Cancelling the validation (Ctrl-C) is reported by the shell
+      done();
+      throw;
+    }
+    catch (const std::exception& e)
+    {
+      result = data::result(false, "", e.what(), "");
+    }
+
+    done();
+    return result;
+  }
+
+  void precompiled_header_builder::run()
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true)
+    {
+      _changed.wait(
+          lock, [this] { return _stopping || (_next && !_building); });
+      if (_stopping)
+      {
+        return;
+      }
+
+      const job j = std::move(*_next);
+      _next = boost::none;
+      _building = true;
+
+      lock.unlock();
+      bool built = false;
+      bool cancelled = false;
+      try
+      {
+        built = build(j);
+      }
+      catch (const process::cancelled&)
+      {
+        cancelled = true;
+      }
+      lock.lock();
+
+      // Cancelling the running compilers (Ctrl-C) kills the compiler
+      // building the precompiled header as well. It is not an error of the
+      // header, therefore the build is started again unless the header has
+      // changed in the meantime.
+      if (cancelled && !_next)
+      {
+        _next = j;
+      }
+
+      // When the header has changed in the meantime, the result is not
+      // published, but the chain can still be extended by the next job.
+      if (built && !_next)
+      {
+        try
+        {
+          publish_precompiled_header(_chain.back(), j.header);
+        }
+        catch (const std::exception& e)
+        {
+          METASHELL_LOG(_logger, "Error publishing precompiled header of " +
+                                     j.header.string() + ": " + e.what());
+        }
+      }
+
+      _building = false;
+      _changed.notify_all();
+    }
+  }
+
+  bool precompiled_header_builder::build(const job& job_)
+  {
+    // <header>.pch has already been removed, therefore the chunks of the
+    // current chain can be reused.
+    if (!extends_chain(job_.content))
+    {
+      _chain.clear();
+    }
+
+    try
+    {
+      const data::process_output o = compile(job_, false);
+      if (!accepted(o))
+      {
+        throw exception("Error precompiling header " + job_.header.string() +
+                        ": " + o.standard_output + o.standard_error);
+      }
+    }
+    catch (const process::cancelled&)
+    {
+      // The chain is not changed by a cancelled compilation
+      throw;
+    }
+    catch (const std::exception& e)
+    {
+      // The header is included by clang without the precompiled header
+      METASHELL_LOG(_logger, e.what());
+      _chain.clear();
+      _precompiled.clear();
+      return false;
+    }
+    return true;
+  }
+
+  bool
+  precompiled_header_builder::extends_chain(const std::string& content_) const
+  {
+    return !_chain.empty() && _chain.size() < max_chain_length &&
+           boost::starts_with(content_, _precompiled) &&
+           std::all_of(_chain.begin(), _chain.end(),
+                       [this](const boost::filesystem::path& pch_) {
+                         return up_to_date(pch_);
+                       });
+  }
+
+  bool precompiled_header_builder::up_to_date(
+      const boost::filesystem::path& pch_) const
+  {
+    const auto i = _chunks.find(pch_);
+    return i != _chunks.end() && boost::filesystem::exists(pch_) &&
+           versions_of(i->second.headers) == i->second.versions;
+  }
+
+  data::process_output
+  precompiled_header_builder::compile(const job& job_, bool report_warnings_)
+  {
+    const data::process_output no_diagnostics{data::exit_code_t(0), "", ""};
+
+    const bool extends = extends_chain(job_.content);
+    if (extends && job_.content.size() == _precompiled.size())
+    {
+      return no_diagnostics;
+    }
+
+    // The diagnostics of the code are needed when validating it
+    if (!report_warnings_ && reuse(job_.content))
+    {
+      return no_diagnostics;
+    }
+
+    // The header itself can not be used to build the elements of the chain,
+    // because it is overwritten after every change and clang refuses to use
+    // precompiled headers built from modified files. The elements are named
+    // after what they are built from, therefore the files of an element are
+    // never overwritten.
+    const std::string code =
+        extends ? job_.content.substr(_precompiled.size()) : job_.content;
+    const std::string chunk =
+        job_.header.string() + "." +
+        content_hash()
+            .add(_compiler_id)
+            .add(extends ? _chain.back().string() : std::string())
+            .add(report_warnings_ ? "1" : "0")
+            .add(code)
+            .hex();
+    const boost::filesystem::path pch = chunk + ".pch";
+
+    data::process_output o = no_diagnostics;
+    if (!up_to_date(pch))
+    {
+      METASHELL_LOG(
+          _logger, "Generating precompiled header for " + job_.header.string() +
+                       (extends ? " on top of " + _chain.back().string() :
+                                  std::string()));
+
+      try
+      {
+        write_file(chunk + ".hpp", code);
+
+        std::vector<std::string> args{"-iquote", "."};
+        if (!report_warnings_)
+        {
+          args.push_back("-w");
+        }
+        if (extends)
+        {
+          args.push_back("-include-pch");
+          args.push_back(_chain.back().string());
+        }
+        args.insert(args.end(), {"-MD", "-MF", dependencies_of(pch).string(),
+                                 "-o", pch.string(), chunk + ".hpp"});
+
+        o = _clang_binary.run(args, "");
+        if (!accepted(o))
+        {
+          remove_chunk(pch);
+          return o;
+        }
+
+        // The element has to be rebuilt when one of the headers it includes
+        // or the element it is built on top of changes.
+        chunk_info info{size_of_chunk(pch), read_dependencies(pch), ""};
+        if (extends)
+        {
+          info.headers.add(boost::filesystem::path(), _chain.back());
+        }
+        info.versions = versions_of(info.headers);
+        _chunks[pch] = std::move(info);
+      }
+      catch (...)
+      {
+        remove_chunk(pch);
+        throw;
+      }
+    }
+
+    if (!extends)
+    {
+      _chain.clear();
+    }
+    _chain.push_back(pch);
+    _precompiled = job_.content;
+    remember(job_.content);
+    return o;
+  }
+
+  bool precompiled_header_builder::reuse(const std::string& content_)
+  {
+    const auto i = _cache.find(content_hash().add(content_).hex());
+    if (i == _cache.end())
+    {
+      return false;
+    }
+    else if (std::all_of(i->second.chain.begin(), i->second.chain.end(),
+                         [this](const boost::filesystem::path& pch_) {
+                           return up_to_date(pch_);
+                         }))
+    {
+      i->second.last_used = ++_uses;
+      _chain = i->second.chain;
+      _precompiled = content_;
+      return true;
+    }
+    else
+    {
+      _cache.erase(i);
+      return false;
+    }
+  }
+
+  void precompiled_header_builder::remember(const std::string& content_)
+  {
+    _cache[content_hash().add(content_).hex()] = cached_chain{_chain, ++_uses};
+    evict();
+  }
+
+  void precompiled_header_builder::evict()
+  {
+    std::uintmax_t size = 0;
+    for (const auto& c : _chunks)
+    {
+      size += c.second.size;
+    }
+
+    while (size > _max_cache_size)
+    {
+      // The current chain is never dropped
+      auto lru = _cache.end();
+      for (auto i = _cache.begin(); i != _cache.end(); ++i)
+      {
+        if (i->second.chain != _chain &&
+            (lru == _cache.end() ||
+             i->second.last_used < lru->second.last_used))
+        {
+          lru = i;
+        }
+      }
+      if (lru == _cache.end())
+      {
+        return;
+      }
+      _cache.erase(lru);
+
+      std::set<boost::filesystem::path> used(_chain.begin(), _chain.end());
+      for (const auto& c : _cache)
+      {
+        used.insert(c.second.chain.begin(), c.second.chain.end());
+      }
+
+      for (auto i = _chunks.begin(); i != _chunks.end();)
+      {
+        if (used.find(i->first) == used.end())
+        {
+          remove_chunk(i->first);
+          size -= i->second.size;
+          i = _chunks.erase(i);
+        }
+        else
+        {
+          ++i;
+        }
+      }
+    }
+  }
+
+  boost::filesystem::path
+  precompiled_header_of(const boost::filesystem::path& header_)
+  {
+    return header_.string() + ".pch";
+  }
+
+  void publish_precompiled_header(const boost::filesystem::path& pch_,
+                                  const boost::filesystem::path& header_)
+  {
+    publish_precompiled_header(
+        pch_, header_,
+        [](const boost::filesystem::path& from_,
+           const boost::filesystem::path& to_, boost::system::error_code& ec_) {
+          boost::filesystem::create_hard_link(from_, to_, ec_);
+        });
+  }
+
+  void publish_precompiled_header(const boost::filesystem::path& pch_,
+                                  const boost::filesystem::path& header_,
+                                  const link_function& link_)
+  {
+    // The temporary file is next to the published precompiled header, so
+    // renaming it is atomic even when the hard link can not be created (eg.
+    // the precompiled header is on another file system).
+    const boost::filesystem::path target = precompiled_header_of(header_);
+    const boost::filesystem::path tmp = target.string() + ".tmp";
+
+    boost::system::error_code ec;
+    boost::filesystem::remove(tmp, ec);
+    ec.clear();
+    link_(pch_, tmp, ec);
+    try
+    {
+      if (ec)
+      {
+        boost::filesystem::copy_file(
+            pch_, tmp, boost::filesystem::copy_option::overwrite_if_exists);
+      }
+      boost::filesystem::rename(tmp, target);
+    }
+    catch (...)
+    {
+      boost::filesystem::remove(tmp, ec);
+      throw;
+    }
+  }
+
+  std::vector<std::string>
+  include_precompiled(const boost::filesystem::path& header_)
+  {
+    const boost::filesystem::path pch = precompiled_header_of(header_);
+    return boost::filesystem::exists(pch) ?
+               std::vector<std::string>{"-include-pch", pch.string()} :
+               std::vector<std::string>{"-include", header_.string()};
+  }
+}
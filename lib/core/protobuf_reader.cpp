@@ -0,0 +1,602 @@
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <metashell/protobuf_reader.hpp>
+
+#include <boost/optional.hpp>
+
+#ifdef METASHELL_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace metashell
+{
+  namespace
+  {
+    // Thrown when the buffer ends in the middle of a message
+    struct truncated
+    {
+    };
+
+    enum wire_type
+    {
+      varint_wire = 0,
+      fixed64_wire = 1,
+      length_delimited_wire = 2,
+      start_group_wire = 3,
+      end_group_wire = 4,
+      fixed32_wire = 5
+    };
+
+    // The initial size of the buffer used for reading streams
+    constexpr std::size_t stream_buffer_size = 64 * 1024;
+
+    constexpr unsigned int wire(unsigned int tag_, wire_type type_)
+    {
+      return (tag_ << 3) | type_;
+    }
+
+    std::uint64_t read_varint(const char*& p_, const char* end_)
+    {
+      std::uint64_t result = 0;
+      for (int shift = 0; p_ != end_ && shift < 64; shift += 7)
+      {
+        const std::uint8_t c = static_cast<std::uint8_t>(*p_++);
+        result |= std::uint64_t(c & 0x7f) << shift;
+        if ((c & 0x80) == 0)
+        {
+          return result;
+        }
+      }
+      throw truncated();
+    }
+
+    double read_double(const char*& p_, const char* end_)
+    {
+      if (end_ - p_ < 8)
+      {
+        throw truncated();
+      }
+
+      // Stored in little endian byte order
+      std::uint64_t bits = 0;
+      for (int i = 7; i >= 0; --i)
+      {
+        bits = (bits << 8) | static_cast<std::uint8_t>(p_[i]);
+      }
+      p_ += 8;
+
+      double result;
+      std::memcpy(&result, &bits, sizeof(result));
+      return result;
+    }
+
+    // The end of the length-delimited field starting at p_. p_ is moved to
+    // the content of the field.
+    const char* read_length(const char*& p_, const char* end_)
+    {
+      const std::uint64_t length = read_varint(p_, end_);
+      if (length > std::uint64_t(end_ - p_))
+      {
+        throw truncated();
+      }
+      return p_ + length;
+    }
+
+    boost::string_view read_string(const char*& p_, const char* end_)
+    {
+      const char* end = read_length(p_, end_);
+      const boost::string_view result(p_, end - p_);
+      p_ = end;
+      return result;
+    }
+
+    void skip(unsigned int wire_, const char*& p_, const char* end_)
+    {
+      switch (wire_ & 7)
+      {
+      case varint_wire:
+        read_varint(p_, end_);
+        break;
+      case fixed64_wire:
+        if (end_ - p_ < 8)
+        {
+          throw truncated();
+        }
+        p_ += 8;
+        break;
+      case length_delimited_wire:
+        p_ = read_length(p_, end_);
+        break;
+      case fixed32_wire:
+        if (end_ - p_ < 4)
+        {
+          throw truncated();
+        }
+        p_ += 4;
+        break;
+      default:
+        // Groups are used only for the traces themselves
+        throw truncated();
+      }
+    }
+
+    unsigned int read_wire(const char*& p_, const char* end_)
+    {
+      return static_cast<unsigned int>(read_varint(p_, end_));
+    }
+
+    int read_int(const char*& p_, const char* end_)
+    {
+      return static_cast<int>(read_varint(p_, end_));
+    }
+
+    boost::optional<std::string> decompress(boost::string_view compressed_)
+    {
+#ifdef METASHELL_HAVE_ZLIB
+      z_stream stream;
+      std::memset(&stream, 0, sizeof(stream));
+      stream.next_in =
+          reinterpret_cast<Bytef*>(const_cast<char*>(compressed_.data()));
+      stream.avail_in = static_cast<uInt>(compressed_.size());
+
+      if (inflateInit(&stream) != Z_OK)
+      {
+        return boost::none;
+      }
+
+      std::string result;
+      int status = Z_OK;
+      while (status == Z_OK)
+      {
+        char buff[1024];
+        stream.next_out = reinterpret_cast<Bytef*>(buff);
+        stream.avail_out = sizeof(buff);
+        status = inflate(&stream, Z_NO_FLUSH);
+        result.append(buff, sizeof(buff) - stream.avail_out);
+      }
+      inflateEnd(&stream);
+
+      return status == Z_STREAM_END ? boost::make_optional(result) :
+                                      boost::none;
+#else
+      // Metashell was built without zlib
+      (void)compressed_;
+      return boost::none;
+#endif
+    }
+  }
+
+  protobuf_reader::protobuf_reader(const char* begin_, const char* end_)
+    : _current(begin_),
+      _end(end_),
+      _trace_end(nullptr),
+      _in_group(false),
+      _version(0)
+  {
+  }
+
+  protobuf_reader::protobuf_reader(read_function read_)
+    : _read(std::move(read_)),
+      _buffer(stream_buffer_size),
+      _current(_buffer.data()),
+      _end(_buffer.data()),
+      _trace_end(nullptr),
+      _in_group(false),
+      _version(0)
+  {
+  }
+
+  protobuf_reader::chunk protobuf_reader::next()
+  {
+    while (true)
+    {
+      const char* chunk_begin = _current;
+      const char* trace_end = _trace_end;
+      const bool in_group = _in_group;
+
+      try
+      {
+        return read_chunk();
+      }
+      catch (const truncated&)
+      {
+        if (_read)
+        {
+          // The rest of the chunk has not been written yet. It is read again
+          // from its beginning once more data is available.
+          _current = chunk_begin;
+          _trace_end = trace_end;
+          _in_group = in_group;
+          if (read_more())
+          {
+            continue;
+          }
+        }
+
+        _current = _end;
+        _trace_end = nullptr;
+        _in_group = false;
+        return chunk::end_of_file;
+      }
+    }
+  }
+
+  const protobuf_reader::begin_entry& protobuf_reader::last_begin_entry() const
+  {
+    return _last_begin_entry;
+  }
+
+  const protobuf_reader::end_entry& protobuf_reader::last_end_entry() const
+  {
+    return _last_end_entry;
+  }
+
+  unsigned int protobuf_reader::version() const { return _version; }
+
+  boost::string_view protobuf_reader::source_name() const
+  {
+    return _source_name;
+  }
+
+  bool protobuf_reader::read_more()
+  {
+    // The processed part of the buffer is dropped. The rest is moved to the
+    // beginning of the buffer and the buffer is grown when it is full.
+    const std::size_t unprocessed = _end - _current;
+    const std::ptrdiff_t trace_end = _trace_end ? _trace_end - _current : -1;
+
+    std::memmove(_buffer.data(), _current, unprocessed);
+    if (unprocessed == _buffer.size())
+    {
+      _buffer.resize(_buffer.size() * 2);
+    }
+
+    const std::size_t len =
+        _read(_buffer.data() + unprocessed, _buffer.size() - unprocessed);
+
+    _current = _buffer.data();
+    _end = _current + unprocessed + len;
+    _trace_end = trace_end >= 0 ? _current + trace_end : nullptr;
+
+    return len > 0;
+  }
+
+  protobuf_reader::chunk protobuf_reader::read_chunk()
+  {
+    while (true)
+    {
+      if (!_in_group && (_trace_end == nullptr || _current == _trace_end))
+      {
+        // repeated TemplightTrace traces = 1;
+        if (_current == _end)
+        {
+          throw truncated();
+        }
+
+        switch (read_wire(_current, _end))
+        {
+        case wire(1, length_delimited_wire):
+          _trace_end = read_length(_current, _end);
+          break;
+        case wire(1, start_group_wire):
+          _trace_end = nullptr;
+          _in_group = true;
+          break;
+        default:
+          _current = _end;
+          _trace_end = nullptr;
+          return chunk::end_of_file;
+        }
+        _file_names.clear();
+        _template_names.clear();
+        _decompressed_names.clear();
+      }
+
+      // The end of a group is known only when its end is reached
+      const char* trace_end = _in_group ? _end : _trace_end;
+
+      const unsigned int w = read_wire(_current, trace_end);
+      switch (w)
+      {
+      case wire(1, end_group_wire):
+        if (!_in_group)
+        {
+          throw truncated();
+        }
+        _in_group = false;
+        break;
+      case wire(1, length_delimited_wire):
+      {
+        const char* end = read_length(_current, trace_end);
+        read_header(end);
+        _current = end;
+        return chunk::header;
+      }
+      case wire(2, length_delimited_wire):
+      {
+        const char* end = read_length(_current, trace_end);
+        const unsigned int entry_wire = read_wire(_current, end);
+        const char* entry_end = read_length(_current, end);
+        chunk result = chunk::other;
+        if (entry_wire == wire(1, length_delimited_wire))
+        {
+          read_begin_entry(entry_end);
+          result = chunk::begin_entry;
+        }
+        else if (entry_wire == wire(2, length_delimited_wire))
+        {
+          read_end_entry(entry_end);
+          result = chunk::end_entry;
+        }
+        _current = end;
+        return result;
+      }
+      case wire(3, length_delimited_wire):
+      {
+        const char* end = read_length(_current, trace_end);
+        read_dictionary_entry(end);
+        _current = end;
+        return chunk::other;
+      }
+      default:
+        skip(w, _current, trace_end);
+        break;
+      }
+    }
+  }
+
+  void protobuf_reader::read_header(const char* end_)
+  {
+    _version = 0;
+    _source_name.clear();
+
+    while (_current != end_)
+    {
+      const unsigned int w = read_wire(_current, end_);
+      switch (w)
+      {
+      case wire(1, varint_wire):
+        _version = static_cast<unsigned int>(read_varint(_current, end_));
+        break;
+      case wire(2, length_delimited_wire):
+        _source_name = read_string(_current, end_).to_string();
+        break;
+      default:
+        skip(w, _current, end_);
+        break;
+      }
+    }
+  }
+
+  void protobuf_reader::read_begin_entry(const char* end_)
+  {
+    _last_begin_entry = begin_entry();
+
+    while (_current != end_)
+    {
+      const unsigned int w = read_wire(_current, end_);
+      switch (w)
+      {
+      case wire(1, varint_wire):
+        _last_begin_entry.kind = read_int(_current, end_);
+        break;
+      case wire(2, length_delimited_wire):
+      {
+        const char* end = read_length(_current, end_);
+        read_template_name(end);
+        _current = end;
+        break;
+      }
+      case wire(3, length_delimited_wire):
+      {
+        const char* end = read_length(_current, end_);
+        read_location(end, _last_begin_entry.point_of_instantiation);
+        _current = end;
+        break;
+      }
+      case wire(4, fixed64_wire):
+        _last_begin_entry.timestamp = read_double(_current, end_);
+        break;
+      case wire(5, varint_wire):
+        _last_begin_entry.memory_usage = read_varint(_current, end_);
+        break;
+      case wire(6, length_delimited_wire):
+      {
+        const char* end = read_length(_current, end_);
+        read_location(end, _last_begin_entry.template_origin);
+        _current = end;
+        break;
+      }
+      default:
+        skip(w, _current, end_);
+        break;
+      }
+    }
+  }
+
+  void protobuf_reader::read_end_entry(const char* end_)
+  {
+    _last_end_entry = end_entry();
+
+    while (_current != end_)
+    {
+      const unsigned int w = read_wire(_current, end_);
+      switch (w)
+      {
+      case wire(1, fixed64_wire):
+        _last_end_entry.timestamp = read_double(_current, end_);
+        break;
+      case wire(2, varint_wire):
+        _last_end_entry.memory_usage = read_varint(_current, end_);
+        break;
+      default:
+        skip(w, _current, end_);
+        break;
+      }
+    }
+  }
+
+  void protobuf_reader::read_template_name(const char* end_)
+  {
+    while (_current != end_)
+    {
+      const unsigned int w = read_wire(_current, end_);
+      switch (w)
+      {
+      case wire(1, length_delimited_wire):
+        _last_begin_entry.name = read_string(_current, end_);
+        break;
+      case wire(2, length_delimited_wire):
+        _last_begin_entry.name =
+            decompressed_name(read_string(_current, end_));
+        break;
+      case wire(3, varint_wire):
+      {
+        const std::uint64_t id = read_varint(_current, end_);
+        _last_begin_entry.name = id < _template_names.size() ?
+                                     boost::string_view(_template_names[id]) :
+                                     boost::string_view();
+        break;
+      }
+      default:
+        skip(w, _current, end_);
+        break;
+      }
+    }
+  }
+
+  boost::string_view
+  protobuf_reader::decompressed_name(boost::string_view compressed_)
+  {
+    const auto i = _decompressed_names.find(compressed_);
+    if (i != _decompressed_names.end())
+    {
+      return i->second;
+    }
+    else
+    {
+      // Names that can not be decompressed are empty
+      return _decompressed_names
+          .emplace(compressed_.to_string(),
+                   decompress(compressed_).value_or(""))
+          .first->second;
+    }
+  }
+
+  void protobuf_reader::read_location(const char* end_, location& location_)
+  {
+    location_ = location();
+    bool has_file_id = false;
+    std::uint64_t file_id = 0;
+
+    while (_current != end_)
+    {
+      const unsigned int w = read_wire(_current, end_);
+      switch (w)
+      {
+      case wire(1, length_delimited_wire):
+        location_.file_name = read_string(_current, end_);
+        break;
+      case wire(2, varint_wire):
+        file_id = read_varint(_current, end_);
+        has_file_id = true;
+        break;
+      case wire(3, varint_wire):
+        location_.line = read_int(_current, end_);
+        break;
+      case wire(4, varint_wire):
+        location_.column = read_int(_current, end_);
+        break;
+      default:
+        skip(w, _current, end_);
+        break;
+      }
+    }
+
+    // The file name is provided only when the file id is used for the first
+    // time.
+    if (has_file_id)
+    {
+      if (file_id >= _file_names.size())
+      {
+        // The file ids are assigned sequentially. A file id this large
+        // means that the trace is corrupted.
+        if (file_id >= std::uint64_t(_end - _current) + _file_names.size())
+        {
+          throw truncated();
+        }
+        _file_names.resize(file_id + 1);
+      }
+
+      if (!location_.file_name.empty())
+      {
+        _file_names[file_id] = location_.file_name.to_string();
+      }
+      location_.file_name = _file_names[file_id];
+    }
+  }
+
+  void protobuf_reader::read_dictionary_entry(const char* end_)
+  {
+    boost::string_view marked_name;
+    std::vector<std::uint64_t> markers;
+
+    while (_current != end_)
+    {
+      const unsigned int w = read_wire(_current, end_);
+      switch (w)
+      {
+      case wire(1, length_delimited_wire):
+        marked_name = read_string(_current, end_);
+        break;
+      case wire(2, varint_wire):
+        markers.push_back(read_varint(_current, end_));
+        break;
+      default:
+        skip(w, _current, end_);
+        break;
+      }
+    }
+
+    // The '\0' characters of the marked name are replaced by the earlier
+    // names referred to by the markers.
+    std::string name;
+    name.reserve(marked_name.size());
+    auto marker = markers.begin();
+    for (char c : marked_name)
+    {
+      if (c == '\0' && marker != markers.end())
+      {
+        if (*marker < _template_names.size())
+        {
+          name += _template_names[*marker];
+        }
+        ++marker;
+      }
+      else
+      {
+        name += c;
+      }
+    }
+
+    _template_names.push_back(std::move(name));
+  }
+}
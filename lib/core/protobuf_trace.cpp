@@ -17,7 +17,7 @@
 #include <metashell/exception.hpp>
 #include <metashell/protobuf_trace.hpp>
 
-#include <fstream>
+#include <chrono>
 #include <string>
 
 namespace metashell
@@ -58,67 +58,125 @@ namespace metashell
             std::to_string(kind) + ")");
       }
     }
+
+    mapped_file open(const boost::filesystem::path& src_,
+                     const data::type_or_code_or_error& evaluation_result_)
+    {
+      try
+      {
+        return mapped_file(src_);
+      }
+      catch (const exception&)
+      {
+        if (evaluation_result_.is_error())
+        {
+          throw exception(evaluation_result_.get_error());
+        }
+        else
+        {
+          // Shouldn't happen
+          throw exception("Unexpected type type_or_code_or_error result");
+        }
+      }
+    }
+
+    // How long to wait for templight before checking if it has finished
+    constexpr int poll_timeout_ms = 10;
+
+    typedef std::future<data::type_or_code_or_error> evaluation;
+
+    bool finished(const evaluation& evaluation_)
+    {
+      return !evaluation_.valid() ||
+             evaluation_.wait_for(std::chrono::seconds(0)) ==
+                 std::future_status::ready;
+    }
+
+    // The named pipe is kept open for writing, therefore the end of the trace
+    // is not an end of file but the end of the evaluation.
+    protobuf_reader::read_function
+    read_from(named_pipe& src_, const evaluation& evaluation_result_)
+    {
+      return [&src_, &evaluation_result_](char* buff_, std::size_t size_) {
+        while (true)
+        {
+          // Everything has been written into the pipe when it has finished
+          const bool done = finished(evaluation_result_);
+          if (const std::size_t len = src_.read(buff_, size_))
+          {
+            return len;
+          }
+          else if (done)
+          {
+            return std::size_t(0);
+          }
+          src_.wait(poll_timeout_ms);
+        }
+      };
+    }
+
+    data::file_location
+    to_file_location(const protobuf_reader::location& location_,
+                     data::string_table& names_)
+    {
+      return data::file_location(names_.intern(location_.file_name),
+                                 location_.line, location_.column);
+    }
   }
 
   protobuf_trace::protobuf_trace(const boost::filesystem::path& src,
                                  data::type_or_code_or_error evaluation_result,
                                  data::cpp_code root_name_,
                                  data::metaprogram_mode mode_)
-      // Opening in binary mode, because some platforms interpret some
-      // characters
-      // specially in text mode, which caused parsing to fail.
-      : _src(new std::ifstream(src.string(),
-                               std::ios_base::in | std::ios_base::binary)),
+      : _src(open(src, evaluation_result)),
+        _reader(_src.begin(), _src.end()),
         _evaluation_result(
             data::event_details<data::event_kind::evaluation_end>{
                 {evaluation_result}}),
         _root_name(std::move(root_name_)),
         _mode(mode_)
   {
-    if (!*_src)
-    {
-      if (evaluation_result.is_error())
-      {
-        throw exception(evaluation_result.get_error());
-      }
-      else
-      {
-        // Shouldn't happen
-        throw exception("Unexpected type type_or_code_or_error result");
-      }
-    }
-    _reader.startOnBuffer(*_src);
+  }
+
+  protobuf_trace::protobuf_trace(
+      std::unique_ptr<named_pipe> src_,
+      std::future<data::type_or_code_or_error> evaluation_result_,
+      data::cpp_code root_name_,
+      data::metaprogram_mode mode_)
+      : _stream(new stream{std::move(evaluation_result_), std::move(src_)}),
+        _reader(read_from(*_stream->src, _stream->evaluation_result)),
+        _root_name(std::move(root_name_)),
+        _mode(mode_)
+  {
   }
 
   boost::optional<data::event_data> protobuf_trace::next()
   {
     while (true)
     {
-      switch (_reader.LastChunk)
+      switch (_reader.next())
       {
-      case templight::ProtobufReader::BeginEntry:
+      case protobuf_reader::chunk::begin_entry:
       {
-        auto begin_entry = _reader.LastBeginEntry;
-        _reader.next();
+        const protobuf_reader::begin_entry& e = _reader.last_begin_entry();
         return template_begin(
-            instantiation_kind_from_protobuf(begin_entry.InstantiationKind),
-            data::type(begin_entry.Name),
-            data::file_location(
-                begin_entry.FileName, begin_entry.Line, begin_entry.Column),
-            data::file_location(begin_entry.TempOri_FileName,
-                                begin_entry.TempOri_Line,
-                                begin_entry.TempOri_Column),
-            begin_entry.TimeStamp);
+            instantiation_kind_from_protobuf(e.kind), _names.intern(e.name),
+            to_file_location(e.point_of_instantiation, _names),
+            to_file_location(e.template_origin, _names), e.timestamp);
       }
-      case templight::ProtobufReader::EndEntry:
-      {
-        auto end_entry = _reader.LastBeginEntry;
-        _reader.next();
+      case protobuf_reader::chunk::end_entry:
         return data::event_data(
             data::event_details<data::event_kind::template_end>{
-                {}, end_entry.TimeStamp});
-      }
-      case templight::ProtobufReader::EndOfFile:
+                {}, _reader.last_end_entry().timestamp});
+      case protobuf_reader::chunk::end_of_file:
+        if (_stream && _stream->evaluation_result.valid())
+        {
+          _evaluation_result =
+              data::event_data(data::event_details<
+                               data::event_kind::evaluation_end>{
+                  {_stream->evaluation_result.get()}});
+        }
+
         if (_evaluation_result)
         {
           data::event_data result = *_evaluation_result;
@@ -129,10 +187,8 @@ namespace metashell
         {
           return boost::none;
         }
-      case templight::ProtobufReader::Other:
-      case templight::ProtobufReader::Header:
-      default:
-        _reader.next();
+      case protobuf_reader::chunk::other:
+      case protobuf_reader::chunk::header:
         break;
       }
     }
@@ -20,6 +20,7 @@
 
 #include <algorithm>
 #include <cassert>
+#include <limits>
 #include <map>
 
 namespace metashell
@@ -30,6 +31,7 @@ namespace metashell
     {
       string_,
       bool_,
+      int_,
       list_
     };
 
@@ -41,6 +43,8 @@ namespace metashell
         return "string";
       case field_type::bool_:
         return "bool";
+      case field_type::int_:
+        return "non-negative integer";
       case field_type::list_:
         return "list of strings";
       }
@@ -60,7 +64,11 @@ namespace metashell
           {"engine", field_type::string_},
           {"engine_args", field_type::list_},
           {"use_precompiled_headers", field_type::bool_},
-          {"preprocessor_mode", field_type::bool_}};
+          {"preprocessor_mode", field_type::bool_},
+          {"single_pass_evaluation", field_type::bool_},
+          {"timeout", field_type::int_},
+          {"cpu_time_limit", field_type::int_},
+          {"memory_limit", field_type::int_}};
 
       const auto i = fields.find(field_);
       return i == fields.end() ? boost::none : boost::make_optional(i->second);
@@ -232,6 +240,10 @@ namespace metashell
         {
           _config->preprocessor_mode = b_;
         }
+        else if (*_key == "single_pass_evaluation")
+        {
+          _config->single_pass_evaluation = b_;
+        }
         else
         {
           assert(false);
@@ -252,4 +264,52 @@ namespace metashell
       return false;
     }
   }
+
+  bool rapid_shell_config_parser::Int(int i_) { return integer(i_); }
+
+  bool rapid_shell_config_parser::Uint(unsigned i_) { return integer(i_); }
+
+  bool rapid_shell_config_parser::integer(std::int64_t i_)
+  {
+    not_empty();
+
+    const std::string value = std::to_string(i_);
+
+    if (_config && _key && type_of_field(*_key) == field_type::int_)
+    {
+      if (i_ >= 0 && i_ <= std::numeric_limits<int>::max())
+      {
+        const int v = static_cast<int>(i_);
+        if (*_key == "timeout")
+        {
+          _config->limits.wall_time = v;
+        }
+        else if (*_key == "cpu_time_limit")
+        {
+          _config->limits.cpu_time = v;
+        }
+        else if (*_key == "memory_limit")
+        {
+          _config->limits.memory = v;
+        }
+        else
+        {
+          assert(false);
+        }
+
+        return true;
+      }
+      else
+      {
+        fail(value + " is not a valid value for " + *_key +
+             ", which should be a " + to_string(field_type::int_));
+        return false;
+      }
+    }
+    else
+    {
+      fail("Unexpected integer element: " + value);
+      return false;
+    }
+  }
 }
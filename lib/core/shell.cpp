@@ -16,25 +16,52 @@
 
 #include <metashell/metashell.hpp>
 
+#include <metashell/content_hash.hpp>
 #include <metashell/data/command.hpp>
 #include <metashell/exception.hpp>
 #include <metashell/feature_not_supported.hpp>
 #include <metashell/header_file_environment.hpp>
+#include <metashell/in_memory_environment.hpp>
 #include <metashell/make_unique.hpp>
 #include <metashell/metashell_pragma.hpp>
 #include <metashell/null_history.hpp>
+#include <metashell/process/cancel.hpp>
+#include <metashell/process/cancelled.hpp>
 #include <metashell/shell.hpp>
 #include <metashell/to_string.hpp>
+#include <metashell/type_shell_cached.hpp>
+#include <metashell/type_shell_lazy.hpp>
 #include <metashell/version.hpp>
 
+#include <boost/filesystem.hpp>
+
 #include <algorithm>
 #include <cctype>
+#include <chrono>
 #include <sstream>
 
 using namespace metashell;
 
 namespace
 {
+  // The interval of checking the directories of the include path that can not
+  // be watched for changes
+  const std::chrono::seconds include_path_polling_interval(5);
+
+  void index_include_path(iface::engine& engine_, include_index& index_)
+  {
+    try
+    {
+      iface::header_discoverer& discoverer = engine_.header_discoverer();
+      index_.index(discoverer.include_path(data::include_type::sys));
+      index_.index(discoverer.include_path(data::include_type::quote));
+    }
+    catch (const some_feature_not_supported&)
+    {
+      // Nothing to index
+    }
+  }
+
   bool determine_echo(const data::shell_config& cfg_)
   {
     return cfg_.preprocessor_mode;
@@ -119,10 +146,29 @@ namespace
     using std::string;
     using std::pair;
 
+    // The formatted version compiles whenever the metaprogram does (format
+    // falls back to the type itself when there is no formatter for it), thus
+    // a successful query needs only one evaluation. The metaprogram is
+    // evaluated without metashell::format only to display its errors without
+    // the noise coming from metashell::format.
+
+    METASHELL_LOG(
+        logger_, "Evaluating metaprogram with metashell::format: " +
+                     tmp_exp_.value());
+
+    const data::result formatted =
+        type_shell_.eval(env_, "::metashell::format<" + tmp_exp_ + ">::type",
+                         use_precompiled_headers_);
+
+    if (formatted.successful)
+    {
+      return formatted;
+    }
+
     METASHELL_LOG(
         logger_,
-        "Checking if metaprogram can be evaluated without metashell::format: " +
-            tmp_exp_.value());
+        "Errors occured during metaprogram evaluation. Checking if the"
+        " metaprogram can be evaluated without metashell::format");
 
     const data::result simple =
         type_shell_.eval(env_, tmp_exp_, use_precompiled_headers_);
@@ -132,14 +178,11 @@ namespace
         !simple.successful ?
             "Errors occured during metaprogram evaluation. Displaying errors"
             " coming from the metaprogram without metashell::format" :
-            "No errors occured during metaprogram evaluation. Re-evaluating it"
-            " with metashell::format");
+            "No errors occured during metaprogram evaluation without"
+            " metashell::format. Displaying errors coming from"
+            " metashell::format");
 
-    return simple.successful ?
-               type_shell_.eval(env_,
-                                "::metashell::format<" + tmp_exp_ + ">::type",
-                                use_precompiled_headers_) :
-               simple;
+    return simple.successful ? formatted : simple;
   }
 
   const char default_env[] =
@@ -197,6 +240,54 @@ namespace metashell {
       return nullptr;
     }
   }
+
+  // Identifies the engine the evaluation results in the cache belong to. The
+  // compiler an engine with a type shell runs is identified by the type shell
+  // (its path, size, modification date and all of its arguments). Other
+  // engines are identified by the size and modification date of the binary
+  // in their arguments.
+  std::string engine_cache_key(const data::config& config_,
+                               iface::engine& engine_)
+  {
+    const data::shell_config& cfg = config_.active_shell_config();
+
+    content_hash h;
+    h.add(version()).add(cfg.engine).add(cfg.engine_args.size());
+    for (const std::string& arg : cfg.engine_args)
+    {
+      h.add(arg);
+    }
+
+    if (iface::type_shell* type_shell = try_to_get_shell(engine_))
+    {
+      h.add(type_shell->cache_key());
+    }
+    else if (!cfg.engine_args.empty())
+    {
+      const boost::filesystem::path compiler(cfg.engine_args.front());
+      boost::system::error_code ec;
+      const std::uintmax_t size = boost::filesystem::file_size(compiler, ec);
+      if (!ec)
+      {
+        h.add(size).add(static_cast<std::uint64_t>(
+            boost::filesystem::last_write_time(compiler, ec)));
+      }
+    }
+
+    return h.hex();
+  }
+
+  iface::macro_discovery* try_to_get_macro_discovery(iface::engine& engine_)
+  {
+    try
+    {
+      return &engine_.macro_discovery();
+    }
+    catch (const feature_not_supported<iface::macro_discovery>&)
+    {
+      return nullptr;
+    }
+  }
 }
 
 shell::shell(const data::config& config_,
@@ -218,7 +309,7 @@ shell::shell(const data::config& config_,
     _evaluate_metaprograms(
         determine_evaluate_metaprograms(config_.active_shell_config()))
 {
-  rebuild_environment();
+  build_environment_lazily();
   init(nullptr, mdb_temp_dir_);
 }
 
@@ -242,7 +333,7 @@ shell::shell(const data::config& config_,
     _evaluate_metaprograms(
         determine_evaluate_metaprograms(config_.active_shell_config()))
 {
-  rebuild_environment();
+  build_environment_lazily();
   init(&cpq_, mdb_temp_dir_);
 }
 
@@ -267,10 +358,11 @@ shell::shell(const data::config& config_,
     _evaluate_metaprograms(
         determine_evaluate_metaprograms(config_.active_shell_config()))
 {
+  _env->append(data::cpp_code(default_env));
   init(&cpq_, mdb_temp_dir_);
 }
 
-void shell::cancel_operation() {}
+void shell::cancel_operation() { process::cancel_running_processes(); }
 
 void shell::display_splash(
     iface::displayer& displayer_,
@@ -371,6 +463,10 @@ void shell::line_available(const std::string& s_,
       _line_prefix += s_.substr(0, s_.size() - 1);
     }
   }
+  catch (const process::cancelled&)
+  {
+    displayer_.show_error("Cancelled");
+  }
   catch (const std::exception& e)
   {
     displayer_.show_error(std::string("Error: ") + e.what());
@@ -389,21 +485,26 @@ std::string shell::prompt() const
 bool shell::store_in_buffer(const data::cpp_code& s_,
                             iface::displayer& displayer_)
 {
-  const data::result r = engine().cpp_validator().validate_code(
-      s_ + "\n", _config, *_env, using_precompiled_headers());
+  // Only the errors of extending the environment are displayed here, the
+  // ones about the engine are handled by the caller.
+  iface::cpp_validator& validator = engine().cpp_validator();
 
-  if (r.successful)
+  data::result r;
+  try
   {
-    try
-    {
-      _env->append(s_);
-    }
-    catch (const std::exception& e)
-    {
-      displayer_.show_error(e.what());
-      return false;
-    }
+    r = validator.validate_and_append(
+        s_, _config, env(), using_precompiled_headers());
+  }
+  catch (const process::cancelled&)
+  {
+    throw;
   }
+  catch (const std::exception& e)
+  {
+    displayer_.show_error(e.what());
+    return false;
+  }
+
   if (_show_cpp_errors || r.successful)
   {
     display(r, displayer_, true);
@@ -416,7 +517,7 @@ void shell::code_complete(const std::string& s_, std::set<std::string>& out_)
   try
   {
     engine().code_completer().code_complete(
-        *_env, s_, out_, using_precompiled_headers());
+        env(), s_, out_, using_precompiled_headers());
   }
   catch (...)
   {
@@ -427,7 +528,18 @@ void shell::code_complete(const std::string& s_, std::set<std::string>& out_)
 void shell::init(command_processor_queue* cpq_,
                  const boost::filesystem::path& mdb_temp_dir_)
 {
-  _env->append(data::cpp_code(default_env));
+  if (!_config.cache_dir.empty())
+  {
+    _eval_cache = make_unique<eval_cache>(
+        boost::filesystem::path(_config.cache_dir) / "eval",
+        _config.max_eval_cache_size);
+  }
+
+  _include_index = metashell::make_unique<include_index>(
+      _config.cache_dir.empty() ?
+          boost::filesystem::path() :
+          boost::filesystem::path(_config.cache_dir) / "include_index",
+      include_path_polling_interval, true, _logger);
 
   // TODO: move it to initialisation later
   _pragma_handlers =
@@ -458,15 +570,60 @@ void shell::using_precompiled_headers(bool enabled_)
   rebuild_environment();
 }
 
-iface::environment& shell::env() { return *_env; }
+const data::resource_limits& shell::limits() const
+{
+  return _config.active_shell_config().limits;
+}
+
+void shell::limits(const data::resource_limits& limits_)
+{
+  _config.active_shell_config().limits = limits_;
+
+  // The engines apply the limits when they are created. The old engine is
+  // kept alive until the environment using it is replaced.
+  _engine_errors.erase(_config.active_shell_config().engine);
+  const auto i = _engines.find(_config.active_shell_config().engine);
+  if (i != _engines.end())
+  {
+    const std::unique_ptr<iface::engine> old_engine = std::move(i->second);
+    _engines.erase(i);
+    rebuild_environment();
+  }
+}
+
+iface::environment& shell::env() { return built_env(); }
+
+const iface::environment& shell::env() const { return built_env(); }
 
-const iface::environment& shell::env() const { return *_env; }
+iface::environment& shell::built_env() const
+{
+  std::call_once(_env_built, [this] {
+    if (!_env)
+    {
+      _env = make_unique<header_file_environment>(
+          _lazy_type_shell.get(), _config.active_shell_config(), _internal_dir,
+          _env_filename);
+      _env->append(data::cpp_code(default_env));
+    }
+  });
+  return *_env;
+}
+
+void shell::build_environment_lazily()
+{
+  // Neither the environment (writing the internal headers), nor the engine
+  // is built before the first command needing them. The precompiled header
+  // of the environment is generated after building the engine.
+  _lazy_type_shell = make_unique<type_shell_lazy>(
+      [this] { return try_to_get_shell(built_engine()); });
+}
 
 void shell::rebuild_environment(const data::cpp_code& content_)
 {
-  _env = make_unique<header_file_environment>(try_to_get_shell(engine()),
+  _env = make_unique<header_file_environment>(try_to_get_shell(built_engine()),
                                               _config.active_shell_config(),
                                               _internal_dir, _env_filename);
+  _lazy_type_shell.reset();
 
   if (!content_.empty())
   {
@@ -476,10 +633,23 @@ void shell::rebuild_environment(const data::cpp_code& content_)
 
 void shell::rebuild_environment()
 {
-  rebuild_environment(_env ? _env->get_all() : data::cpp_code());
+  // The headers included by the environment may have changed
+  _macro_cache.clear();
+  _include_graph_cache.clear();
+
+  // An environment not built yet is built using the current config anyway,
+  // but it should not use the type shell of an earlier engine.
+  if (_env)
+  {
+    rebuild_environment(_env->get_all());
+  }
+  else
+  {
+    build_environment_lazily();
+  }
 }
 
-void shell::push_environment() { _environment_stack.push(_env->get_all()); }
+void shell::push_environment() { _environment_stack.push(env().get_all()); }
 
 void shell::pop_environment()
 {
@@ -512,13 +682,95 @@ void shell::display_environment_stack_size(iface::displayer& displayer_)
   }
 }
 
+data::cpp_code shell::macros()
+{
+  return _macro_cache.macros(
+      engine_cache_key(_config, built_engine()), env(),
+      engine().macro_discovery(),
+      [this](const data::cpp_code& code_) { return files_included_by(code_); });
+}
+
+data::include_graph shell::files_included_by(const data::cpp_code& code_)
+{
+  const std::string engine_key = engine_cache_key(_config, built_engine());
+  iface::macro_discovery* macro_discovery =
+      try_to_get_macro_discovery(engine());
+
+  include_graph_cache::macro_definitions definitions;
+  if (macro_discovery)
+  {
+    definitions = [this, &engine_key,
+                   macro_discovery](const data::cpp_code& earlier_) {
+      return _macro_cache.definitions(
+          engine_key, in_memory_environment(earlier_, _internal_dir),
+          *macro_discovery, [this](const data::cpp_code& code_) {
+            return files_included_by(code_);
+          });
+    };
+  }
+
+  return _include_graph_cache.files_included_by(
+      engine_key, code_, engine().header_discoverer(), definitions);
+}
+
+void shell::display_cache_statistics(iface::displayer& displayer_)
+{
+  if (_eval_cache)
+  {
+    std::ostringstream s;
+    s << "Evaluation cache: " << _eval_cache->directory().string()
+      << "\nHits: " << _eval_cache->hits()
+      << "\nMisses: " << _eval_cache->misses()
+      << "\nEntries: " << _eval_cache->entries()
+      << "\nSize: " << _eval_cache->size() << " bytes (limit: "
+      << _eval_cache->max_size() << " bytes)";
+    displayer_.show_comment(data::text(s.str()));
+  }
+  else
+  {
+    displayer_.show_comment(
+        data::text("Caching evaluation results is disabled. Use --cache_dir "
+                   "to enable it."));
+  }
+}
+
+void shell::clear_cache()
+{
+  if (_eval_cache)
+  {
+    _eval_cache->clear();
+  }
+}
+
 void shell::run_metaprogram(const data::cpp_code& s_,
                             iface::displayer& displayer_)
 {
   if (_evaluate_metaprograms)
   {
-    const data::result r = eval_tmp_formatted(
-        *_env, s_, using_precompiled_headers(), engine().type_shell(), _logger);
+    data::result r;
+    if (_eval_cache)
+    {
+      // The key contains the compiler and all of its arguments, which are
+      // known after building the engine. Neither the precompiled header of
+      // the environment is generated, nor the type shell of the engine is
+      // used when the result is in the cache and the environment includes
+      // no headers.
+      type_shell_lazy engine_type_shell(
+          [this] { return &engine().type_shell(); });
+      type_shell_cached type_shell(
+          engine_type_shell, *_eval_cache,
+          engine_cache_key(_config, built_engine()), limits(),
+          [this](const data::cpp_code& code_) {
+            return files_included_by(code_);
+          });
+      r = eval_tmp_formatted(
+          env(), s_, using_precompiled_headers(), type_shell, _logger);
+    }
+    else
+    {
+      r = eval_tmp_formatted(env(), s_, using_precompiled_headers(),
+                             engine().type_shell(), _logger);
+    }
     if (_show_cpp_errors || r.successful)
     {
       display(r, displayer_, true);
@@ -543,13 +795,44 @@ void shell::line_available(const std::string& s_, iface::displayer& displayer_)
 }
 
 iface::engine& shell::engine()
+{
+  iface::engine& result = built_engine();
+  if (_lazy_type_shell && !_lazy_type_shell->got())
+  {
+    // Only the precompiled header of the latest version of the environment
+    // is generated
+    built_env();
+    _lazy_type_shell->get();
+  }
+  return result;
+}
+
+iface::engine& shell::built_engine()
 {
   const auto& name = _config.active_shell_config().engine;
   const auto i = _engines.find(name);
   if (i == _engines.end())
   {
-    return *_engines.insert(std::make_pair(name, _engine_builder(_config)))
-                .first->second;
+    const auto e = _engine_errors.find(name);
+    if (e != _engine_errors.end())
+    {
+      std::rethrow_exception(e->second);
+    }
+
+    try
+    {
+      return *_engines.insert(std::make_pair(name, _engine_builder(_config)))
+                  .first->second;
+    }
+    catch (const process::cancelled&)
+    {
+      throw;
+    }
+    catch (...)
+    {
+      _engine_errors[name] = std::current_exception();
+      throw;
+    }
   }
   else
   {
@@ -558,6 +841,17 @@ iface::engine& shell::engine()
   }
 }
 
+include_index& shell::include_path_index()
+{
+  // The include path of an engine is indexed when it is looked up for the
+  // first time, not when the engine is built.
+  if (_indexed_engines.insert(_config.active_shell_config().engine).second)
+  {
+    index_include_path(engine(), *_include_index);
+  }
+  return *_include_index;
+}
+
 boost::filesystem::path shell::env_path() const
 {
   return _internal_dir / _env_filename;
@@ -568,7 +862,7 @@ bool shell::preprocess(iface::displayer& displayer_,
                        bool process_directives_)
 {
   data::result r = engine().preprocessor_shell().precompile(
-      _env->get_all() + "\n" + add_markers(exp_, process_directives_) + "\n");
+      env().get_all() + "\n" + add_markers(exp_, process_directives_) + "\n");
 
   if (r.successful)
   {
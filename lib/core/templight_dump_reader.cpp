@@ -0,0 +1,445 @@
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <metashell/templight_dump_reader.hpp>
+
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+
+namespace metashell
+{
+  namespace
+  {
+    bool is_space(char c_) { return c_ == ' ' || c_ == '\t' || c_ == '\r'; }
+
+    boost::string_view view(const char* begin_, const char* end_)
+    {
+      return boost::string_view(begin_, end_ - begin_);
+    }
+
+    const char* end_of_line(const char* p_, const char* end_)
+    {
+      const void* nl = std::memchr(p_, '\n', end_ - p_);
+      return nl ? static_cast<const char*>(nl) : end_;
+    }
+
+    // Returns the line starting at p_ without the line break and moves p_ to
+    // the beginning of the next line
+    boost::string_view read_line(const char*& p_, const char* end_)
+    {
+      const char* begin = p_;
+      const char* e = end_of_line(p_, end_);
+      p_ = e == end_ ? end_ : e + 1;
+      while (e != begin && e[-1] == '\r')
+      {
+        --e;
+      }
+      return view(begin, e);
+    }
+
+    boost::string_view trim(boost::string_view s_)
+    {
+      while (!s_.empty() && is_space(s_.front()))
+      {
+        s_.remove_prefix(1);
+      }
+      while (!s_.empty() && is_space(s_.back()))
+      {
+        s_.remove_suffix(1);
+      }
+      return s_;
+    }
+
+    bool starts_document(boost::string_view line_)
+    {
+      return line_.starts_with("---") &&
+             (line_.size() == 3 || is_space(line_[3]));
+    }
+
+    // p_ points to a line break inside a flow scalar. A single line break is
+    // folded into a space, the line breaks of the empty lines are kept.
+    void fold_line_break(const char*& p_, const char* end_, std::string& out_)
+    {
+      while (!out_.empty() && is_space(out_.back()))
+      {
+        out_.pop_back();
+      }
+
+      int empty_lines = 0;
+      ++p_;
+      while (true)
+      {
+        while (p_ != end_ && is_space(*p_))
+        {
+          ++p_;
+        }
+        if (p_ != end_ && *p_ == '\n')
+        {
+          ++empty_lines;
+          ++p_;
+        }
+        else
+        {
+          break;
+        }
+      }
+
+      if (empty_lines == 0)
+      {
+        out_ += ' ';
+      }
+      else
+      {
+        out_.append(empty_lines, '\n');
+      }
+    }
+
+    void append_utf8(std::uint32_t c_, std::string& out_)
+    {
+      if (c_ < 0x80)
+      {
+        out_ += char(c_);
+      }
+      else if (c_ < 0x800)
+      {
+        out_ += char(0xc0 | (c_ >> 6));
+        out_ += char(0x80 | (c_ & 0x3f));
+      }
+      else if (c_ < 0x10000)
+      {
+        out_ += char(0xe0 | (c_ >> 12));
+        out_ += char(0x80 | ((c_ >> 6) & 0x3f));
+        out_ += char(0x80 | (c_ & 0x3f));
+      }
+      else
+      {
+        out_ += char(0xf0 | (c_ >> 18));
+        out_ += char(0x80 | ((c_ >> 12) & 0x3f));
+        out_ += char(0x80 | ((c_ >> 6) & 0x3f));
+        out_ += char(0x80 | (c_ & 0x3f));
+      }
+    }
+
+    std::uint32_t read_hex(const char*& p_, const char* end_, int digits_)
+    {
+      std::uint32_t result = 0;
+      for (int i = 0; i != digits_ && p_ != end_ && std::isxdigit(*p_); ++i)
+      {
+        const char c = *p_++;
+        result = result * 16 +
+                 (std::isdigit(c) ? c - '0' : std::tolower(c) - 'a' + 10);
+      }
+      return result;
+    }
+
+    // p_ points after the backslash
+    void unescape(const char*& p_, const char* end_, std::string& out_)
+    {
+      if (p_ == end_)
+      {
+        return;
+      }
+
+      const char c = *p_++;
+      switch (c)
+      {
+      case '0':
+        out_ += '\0';
+        break;
+      case 'a':
+        out_ += '\a';
+        break;
+      case 'b':
+        out_ += '\b';
+        break;
+      case 't':
+        out_ += '\t';
+        break;
+      case 'n':
+        out_ += '\n';
+        break;
+      case 'v':
+        out_ += '\v';
+        break;
+      case 'f':
+        out_ += '\f';
+        break;
+      case 'r':
+        out_ += '\r';
+        break;
+      case 'e':
+        out_ += '\x1b';
+        break;
+      case 'N':
+        append_utf8(0x85, out_);
+        break;
+      case '_':
+        append_utf8(0xa0, out_);
+        break;
+      case 'L':
+        append_utf8(0x2028, out_);
+        break;
+      case 'P':
+        append_utf8(0x2029, out_);
+        break;
+      case 'x':
+        append_utf8(read_hex(p_, end_, 2), out_);
+        break;
+      case 'u':
+        append_utf8(read_hex(p_, end_, 4), out_);
+        break;
+      case 'U':
+        append_utf8(read_hex(p_, end_, 8), out_);
+        break;
+      case '\r':
+      case '\n':
+        // Escaped line break: the scalar continues without a space
+        while (p_ != end_ && (is_space(*p_) || *p_ == '\n'))
+        {
+          ++p_;
+        }
+        break;
+      default:
+        // \\, \", \/, \<space> and the invalid escapes
+        out_ += c;
+        break;
+      }
+    }
+
+    boost::string_view
+    read_single_quoted(const char*& p_, const char* end_, std::string& buff_)
+    {
+      const char* begin = ++p_;
+      bool needs_unescaping = false;
+      while (p_ != end_ && (*p_ != '\'' || (p_ + 1 != end_ && p_[1] == '\'')))
+      {
+        needs_unescaping = needs_unescaping || *p_ == '\'' || *p_ == '\n';
+        p_ += *p_ == '\'' ? 2 : 1;
+      }
+      const char* end = p_;
+      read_line(p_, end_);
+
+      if (!needs_unescaping)
+      {
+        return view(begin, end);
+      }
+
+      buff_.clear();
+      for (const char* i = begin; i != end;)
+      {
+        if (*i == '\n')
+        {
+          fold_line_break(i, end, buff_);
+        }
+        else
+        {
+          buff_ += *i;
+          i += *i == '\'' ? 2 : 1;
+        }
+      }
+      return buff_;
+    }
+
+    boost::string_view
+    read_double_quoted(const char*& p_, const char* end_, std::string& buff_)
+    {
+      const char* begin = ++p_;
+      bool needs_unescaping = false;
+      while (p_ != end_ && *p_ != '"')
+      {
+        needs_unescaping = needs_unescaping || *p_ == '\\' || *p_ == '\n';
+        p_ += (*p_ == '\\' && p_ + 1 != end_) ? 2 : 1;
+      }
+      const char* end = p_;
+      read_line(p_, end_);
+
+      if (!needs_unescaping)
+      {
+        return view(begin, end);
+      }
+
+      buff_.clear();
+      for (const char* i = begin; i != end;)
+      {
+        if (*i == '\\')
+        {
+          ++i;
+          unescape(i, end, buff_);
+        }
+        else if (*i == '\n')
+        {
+          fold_line_break(i, end, buff_);
+        }
+        else
+        {
+          buff_ += *i++;
+        }
+      }
+      return buff_;
+    }
+
+    // The continuation lines of plain scalars are indented
+    bool continues(const char* p_, const char* end_)
+    {
+      if (p_ == end_ || !is_space(*p_))
+      {
+        return false;
+      }
+      else
+      {
+        return !trim(read_line(p_, end_)).empty();
+      }
+    }
+
+    boost::string_view
+    read_plain(const char*& p_, const char* end_, std::string& buff_)
+    {
+      const boost::string_view first = trim(read_line(p_, end_));
+      if (!continues(p_, end_))
+      {
+        return first;
+      }
+
+      buff_.assign(first.begin(), first.end());
+      while (continues(p_, end_))
+      {
+        const boost::string_view line = trim(read_line(p_, end_));
+        buff_ += ' ';
+        buff_.append(line.begin(), line.end());
+      }
+      return buff_;
+    }
+
+    // Moves p_ to the beginning of the line after the scalar
+    boost::string_view
+    read_scalar(const char*& p_, const char* end_, std::string& buff_)
+    {
+      while (p_ != end_ && is_space(*p_))
+      {
+        ++p_;
+      }
+
+      if (p_ != end_ && *p_ == '\'')
+      {
+        return read_single_quoted(p_, end_, buff_);
+      }
+      else if (p_ != end_ && *p_ == '"')
+      {
+        return read_double_quoted(p_, end_, buff_);
+      }
+      else
+      {
+        return read_plain(p_, end_, buff_);
+      }
+    }
+  }
+
+  templight_dump_reader::templight_dump_reader(const char* begin_,
+                                               const char* end_)
+    : _current(begin_), _end(end_)
+  {
+  }
+
+  bool templight_dump_reader::next()
+  {
+    _last_entry = entry();
+    bool in_document = false;
+
+    while (_current != _end)
+    {
+      const char* line_begin = _current;
+      const boost::string_view line = read_line(_current, _end);
+
+      if (starts_document(line))
+      {
+        if (in_document)
+        {
+          _current = line_begin;
+          return true;
+        }
+        in_document = true;
+      }
+      else if (line == "...")
+      {
+        if (in_document)
+        {
+          return true;
+        }
+      }
+      else if (!line.empty() && !is_space(line.front()) && line[0] != '#')
+      {
+        const auto colon = line.find(':');
+        if (colon != boost::string_view::npos)
+        {
+          in_document = true;
+
+          std::string* buff = nullptr;
+          boost::string_view* value = field(line.substr(0, colon), buff);
+
+          _current = line_begin + colon + 1;
+          const boost::string_view scalar = read_scalar(_current, _end, *buff);
+          if (value)
+          {
+            *value = scalar;
+          }
+        }
+      }
+    }
+
+    return in_document;
+  }
+
+  const templight_dump_reader::entry& templight_dump_reader::last_entry() const
+  {
+    return _last_entry;
+  }
+
+  boost::string_view* templight_dump_reader::field(boost::string_view key_,
+                                                   std::string*& buff_)
+  {
+    if (key_ == "name")
+    {
+      buff_ = &_name;
+      return &_last_entry.name;
+    }
+    else if (key_ == "kind")
+    {
+      buff_ = &_kind;
+      return &_last_entry.kind;
+    }
+    else if (key_ == "event")
+    {
+      buff_ = &_event;
+      return &_last_entry.event;
+    }
+    else if (key_ == "orig")
+    {
+      buff_ = &_orig;
+      return &_last_entry.orig;
+    }
+    else if (key_ == "poi")
+    {
+      buff_ = &_poi;
+      return &_last_entry.poi;
+    }
+    else
+    {
+      buff_ = &_other;
+      return nullptr;
+    }
+  }
+}
@@ -0,0 +1,95 @@
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <metashell/file_versions.hpp>
+#include <metashell/type_shell_cached.hpp>
+
+#include <ctime>
+#include <sstream>
+
+namespace metashell
+{
+  type_shell_cached::type_shell_cached(iface::type_shell& type_shell_,
+                                       eval_cache& cache_,
+                                       std::string engine_,
+                                       data::resource_limits limits_,
+                                       included_headers included_headers_)
+    : _type_shell(type_shell_),
+      _cache(cache_),
+      _engine(std::move(engine_)),
+      _limits(limits_),
+      _included_headers(std::move(included_headers_))
+  {
+  }
+
+  data::result
+  type_shell_cached::eval(const iface::environment& env_,
+                          const boost::optional<data::cpp_code>& tmp_exp_,
+                          bool use_precompiled_headers_)
+  {
+    const data::cpp_code env = env_.get_all();
+
+    std::ostringstream key;
+    for (const std::string& field :
+         {_engine, std::to_string(_limits.wall_time),
+          std::to_string(_limits.cpu_time), std::to_string(_limits.memory),
+          std::string(use_precompiled_headers_ ? "1" : "0"), env.value(),
+          tmp_exp_ ? "1" + tmp_exp_->value() : std::string("0")})
+    {
+      key << field.size() << ':' << field;
+    }
+
+    // The entry is checked against the versions of the headers it was stored
+    // with, therefore a cache hit does not run the compiler.
+    if (const boost::optional<data::result> cached = _cache.find(key.str()))
+    {
+      return *cached;
+    }
+
+    const std::time_t started = std::time(nullptr);
+    const data::result result =
+        _type_shell.eval(env_, tmp_exp_, use_precompiled_headers_);
+    if (result.successful)
+    {
+      // The headers are looked up for the stored results only. Every include
+      // directive contains "include", they are not looked up when there is
+      // none.
+      const data::include_graph headers =
+          env.value().find("include") == std::string::npos ?
+              data::include_graph() :
+              _included_headers(env);
+
+      // The compiler may have seen the earlier version of a header modified
+      // while it was running
+      if (!modified_after(headers, started))
+      {
+        _cache.store(key.str(), result, headers, file_versions(headers));
+      }
+    }
+    return result;
+  }
+
+  void type_shell_cached::generate_precompiled_header(
+      const boost::filesystem::path& fn_)
+  {
+    _type_shell.generate_precompiled_header(fn_);
+  }
+
+  std::string type_shell_cached::cache_key()
+  {
+    return _type_shell.cache_key();
+  }
+}
@@ -16,10 +16,12 @@
 
 #include <metashell/type_shell_clang.hpp>
 
+#include <metashell/content_hash.hpp>
 #include <metashell/exception.hpp>
 #include <metashell/metashell.hpp>
 
-#include <boost/algorithm/string/trim.hpp>
+#include <fstream>
+#include <iterator>
 
 namespace metashell
 {
@@ -27,10 +29,15 @@ namespace metashell
       const boost::filesystem::path& internal_dir_,
       const boost::filesystem::path& env_filename_,
       clang_binary clang_binary_,
+      bool single_pass_evaluation_,
+      std::shared_ptr<precompiled_header_builder> precompiled_header_builder_,
       logger* logger_)
     : _clang_binary(clang_binary_),
+      _internal_dir(internal_dir_),
       _env_path(internal_dir_ / env_filename_),
-      _logger(logger_)
+      _single_pass_evaluation(single_pass_evaluation_),
+      _logger(logger_),
+      _precompiled_header_builder(std::move(precompiled_header_builder_))
   {
   }
 
@@ -44,30 +51,35 @@ namespace metashell
         use_precompiled_headers_ ?
             boost::optional<boost::filesystem::path>(_env_path) :
             boost::none,
-        boost::none, _clang_binary);
+        boost::none, _clang_binary, _single_pass_evaluation);
   }
 
   void type_shell_clang::generate_precompiled_header(
       const boost::filesystem::path& fn_)
   {
-    using boost::algorithm::trim_copy;
-
-    const std::string filename = fn_.string();
-
-    METASHELL_LOG(_logger, "Generating percompiled header for " + filename);
-
-    std::vector<std::string> args{
-        "-iquote", ".", "-w", "-o", filename + ".pch", filename};
-
-    const data::process_output o = _clang_binary.run(args, "");
-    const std::string err = o.standard_output + o.standard_error;
-    if (!err.empty()
-        // clang displays this even when "-w" is used. This can be ignored
-        &&
-        trim_copy(err) !=
-            "warning: precompiled header used __DATE__ or __TIME__.")
+    std::ifstream f(fn_.string(), std::ios::binary);
+    if (f)
+    {
+      _precompiled_header_builder->update(
+          fn_, std::string(std::istreambuf_iterator<char>(f),
+                           std::istreambuf_iterator<char>()));
+    }
+    else
     {
-      throw exception("Error precompiling header " + filename + ": " + err);
+      throw exception("Error reading " + fn_.string());
     }
   }
+
+  std::string type_shell_clang::cache_key()
+  {
+    return content_hash()
+        .add(_clang_binary.cache_key(_internal_dir))
+        .add(_single_pass_evaluation ? "1" : "0")
+        .hex();
+  }
+
+  void type_shell_clang::wait_for_precompiled_header()
+  {
+    _precompiled_header_builder->wait();
+  }
 }
@@ -35,4 +35,6 @@ namespace metashell
   {
     // ignore
   }
+
+  std::string type_shell_constant::cache_key() { return std::string(); }
 }
@@ -0,0 +1,81 @@
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <metashell/exception.hpp>
+#include <metashell/type_shell_lazy.hpp>
+
+namespace metashell
+{
+  type_shell_lazy::type_shell_lazy(std::function<iface::type_shell*()> get_)
+    : _get(std::move(get_)), _got(false), _type_shell(nullptr)
+  {
+  }
+
+  data::result
+  type_shell_lazy::eval(const iface::environment& env_,
+                        const boost::optional<data::cpp_code>& tmp_exp_,
+                        bool use_precompiled_headers_)
+  {
+    if (iface::type_shell* type_shell = get())
+    {
+      return type_shell->eval(env_, tmp_exp_, use_precompiled_headers_);
+    }
+    else
+    {
+      throw exception("The engine can not evaluate metaprograms.");
+    }
+  }
+
+  void type_shell_lazy::generate_precompiled_header(
+      const boost::filesystem::path& fn_)
+  {
+    if (_got)
+    {
+      if (_type_shell)
+      {
+        _type_shell->generate_precompiled_header(fn_);
+      }
+    }
+    else
+    {
+      _precompiled_header = fn_;
+    }
+  }
+
+  std::string type_shell_lazy::cache_key()
+  {
+    iface::type_shell* type_shell = get();
+    return type_shell ? type_shell->cache_key() : std::string();
+  }
+
+  iface::type_shell* type_shell_lazy::get()
+  {
+    if (!_got)
+    {
+      _type_shell = _get();
+      _got = true;
+
+      if (_type_shell && _precompiled_header)
+      {
+        _type_shell->generate_precompiled_header(*_precompiled_header);
+      }
+      _precompiled_header = boost::none;
+    }
+    return _type_shell;
+  }
+
+  bool type_shell_lazy::got() const { return _got; }
+}
@@ -20,6 +20,7 @@
 #include <boost/filesystem.hpp>
 
 #include <fstream>
+#include <iterator>
 
 using namespace metashell;
 
@@ -29,6 +30,18 @@ void metashell::data::generate(const data::unsaved_file& f_)
   p.remove_filename();
   create_directories(p); // Throws when fails to create the directory
   const std::string filename = f_.filename().string();
+
+  // Rewriting the file would invalidate the precompiled headers including it
+  {
+    std::ifstream current(filename.c_str(), std::ios::binary);
+    if (current && std::string(std::istreambuf_iterator<char>(current),
+                               std::istreambuf_iterator<char>()) ==
+                       f_.content())
+    {
+      return;
+    }
+  }
+
   std::ofstream f(filename.c_str());
   if (f)
   {
@@ -120,11 +120,13 @@ namespace metashell
   vc_binary::vc_binary(boost::filesystem::path cl_path_,
                        std::vector<std::string> base_args_,
                        boost::filesystem::path temp_dir_,
-                       logger* logger_)
+                       logger* logger_,
+                       data::resource_limits limits_)
     : _cl_path(std::move(cl_path_)),
       _base_args(std::move(base_args_)),
       _temp_dir(std::move(temp_dir_)),
-      _logger(logger_)
+      _logger(logger_),
+      _limits(limits_)
   {
     process::quote_arguments(_base_args);
   }
@@ -142,7 +144,8 @@ namespace metashell
                                boost::algorithm::join(cmd, " "));
 
     const data::process_output o =
-        dos2unix(process::run(_cl_path, cmd, stdin_));
+        dos2unix(process::run(_cl_path, cmd, stdin_,
+                              boost::filesystem::path(), _limits));
 
     METASHELL_LOG(_logger, "cl.exe's exit code: " + to_string(o.exit_code));
     METASHELL_LOG(_logger, "cl.exe's stdout: " + o.standard_output);
@@ -16,14 +16,12 @@
 
 #include <metashell/yaml_trace.hpp>
 
-#include <yaml-cpp/yaml.h>
-
 namespace metashell
 {
   namespace
   {
     boost::optional<data::event_kind>
-    instantiation_kind_from_yaml_dump(const std::string& s_)
+    instantiation_kind_from_yaml_dump(boost::string_view s_)
     {
       using data::event_kind;
 
@@ -78,12 +76,12 @@ namespace metashell
     }
   }
 
-  yaml_trace::yaml_trace(const std::string& trace_,
+  yaml_trace::yaml_trace(std::string trace_,
                          data::type_or_code_or_error evaluation_result_,
                          data::cpp_code root_name_,
                          data::metaprogram_mode mode_)
-    : _nodes(YAML::LoadAll(trace_)),
-      _next(_nodes.begin()),
+    : _trace(std::make_shared<const std::string>(std::move(trace_))),
+      _reader(_trace->data(), _trace->data() + _trace->size()),
       _evaluation_result(data::event_details<data::event_kind::evaluation_end>{
           {evaluation_result_}}),
       _root_name(std::move(root_name_)),
@@ -93,38 +91,37 @@ namespace metashell
 
   boost::optional<data::event_data> yaml_trace::next()
   {
-    boost::optional<data::event_data> result;
-
-    if (_next != _nodes.end())
+    while (_reader.next())
     {
-      const YAML::Node& node = *_next;
+      const templight_dump_reader::entry& e = _reader.last_entry();
 
-      if (const auto kind =
-              instantiation_kind_from_yaml_dump(node["kind"].as<std::string>()))
+      if (const auto kind = instantiation_kind_from_yaml_dump(e.kind))
       {
-        const std::string event = node["event"].as<std::string>();
-        if (event == "Begin")
+        if (e.event == "Begin")
         {
-          result = template_begin(
-              *kind, data::type(node["name"].as<std::string>()),
-              data::file_location::parse(node["poi"].as<std::string>()),
-              data::file_location::parse(node["orig"].as<std::string>()), 0);
+          return template_begin(
+              *kind, _names.intern(e.name),
+              data::file_location::parse(e.poi, _names),
+              data::file_location::parse(e.orig, _names), 0);
         }
-        else if (event == "End")
+        else if (e.event == "End")
         {
-          result = data::event_details<data::event_kind::template_end>{{}, 0};
+          return data::event_data(
+              data::event_details<data::event_kind::template_end>{{}, 0});
         }
       }
-
-      ++_next;
     }
-    else if (_evaluation_result)
+
+    if (_evaluation_result)
     {
-      result = *_evaluation_result;
+      data::event_data result = *_evaluation_result;
       _evaluation_result = boost::none;
+      return result;
+    }
+    else
+    {
+      return boost::none;
     }
-
-    return result;
   }
 
   const data::cpp_code& yaml_trace::root_name() const { return _root_name; }
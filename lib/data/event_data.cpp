@@ -53,7 +53,7 @@ namespace metashell
     }
 
     event_data template_begin(event_kind kind,
-                              const type& type,
+                              const interned_string& full_name,
                               const file_location& point_of_event,
                               const file_location& source_location,
                               double timestamp)
@@ -62,51 +62,51 @@ namespace metashell
       {
       case event_kind::template_instantiation:
         return event_details<event_kind::template_instantiation>{
-            {type, point_of_event, source_location}, timestamp};
+            {full_name, point_of_event, source_location}, timestamp};
         break;
       case event_kind::default_template_argument_instantiation:
         return event_details<
             event_kind::default_template_argument_instantiation>{
-            {type, point_of_event, source_location}, timestamp};
+            {full_name, point_of_event, source_location}, timestamp};
         break;
       case event_kind::default_function_argument_instantiation:
         return event_details<
             event_kind::default_function_argument_instantiation>{
-            {type, point_of_event, source_location}, timestamp};
+            {full_name, point_of_event, source_location}, timestamp};
         break;
       case event_kind::explicit_template_argument_substitution:
         return event_details<
             event_kind::explicit_template_argument_substitution>{
-            {type, point_of_event, source_location}, timestamp};
+            {full_name, point_of_event, source_location}, timestamp};
         break;
       case event_kind::deduced_template_argument_substitution:
         return event_details<
             event_kind::deduced_template_argument_substitution>{
-            {type, point_of_event, source_location}, timestamp};
+            {full_name, point_of_event, source_location}, timestamp};
         break;
       case event_kind::prior_template_argument_substitution:
         return event_details<event_kind::prior_template_argument_substitution>{
-            {type, point_of_event, source_location}, timestamp};
+            {full_name, point_of_event, source_location}, timestamp};
         break;
       case event_kind::default_template_argument_checking:
         return event_details<event_kind::default_template_argument_checking>{
-            {type, point_of_event, source_location}, timestamp};
+            {full_name, point_of_event, source_location}, timestamp};
         break;
       case event_kind::exception_spec_instantiation:
         return event_details<event_kind::exception_spec_instantiation>{
-            {type, point_of_event, source_location}, timestamp};
+            {full_name, point_of_event, source_location}, timestamp};
         break;
       case event_kind::declaring_special_member:
         return event_details<event_kind::declaring_special_member>{
-            {type, point_of_event, source_location}, timestamp};
+            {full_name, point_of_event, source_location}, timestamp};
         break;
       case event_kind::defining_synthesized_function:
         return event_details<event_kind::defining_synthesized_function>{
-            {type, point_of_event, source_location}, timestamp};
+            {full_name, point_of_event, source_location}, timestamp};
         break;
       case event_kind::memoization:
         return event_details<event_kind::memoization>{
-            {type, point_of_event, source_location}, timestamp};
+            {full_name, point_of_event, source_location}, timestamp};
         break;
       default:
         assert(!"Invalid event_kind");
@@ -142,6 +142,12 @@ namespace metashell
           data);
     }
 
+    interned_string full_name(const event_data& data)
+    {
+      return mpark::visit(
+          [](const auto& details) { return full_name(details.what); }, data);
+    }
+
     boost::optional<file_location> point_of_event(const event_data& data)
     {
       return mpark::visit(
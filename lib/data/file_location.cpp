@@ -31,7 +31,7 @@ namespace
     std::size_t colon_at;
   };
 
-  bool is_number(const std::string& s_, std::size_t from_, std::size_t to_)
+  bool is_number(boost::string_view s_, std::size_t from_, std::size_t to_)
   {
     assert(to_ != std::string::npos);
 
@@ -40,7 +40,7 @@ namespace
                        [](char c_) { return std::isdigit(c_); });
   }
 
-  boost::optional<number_at_end> parse_last_number(const std::string& s_,
+  boost::optional<number_at_end> parse_last_number(boost::string_view s_,
                                                    std::size_t from_)
   {
     assert(from_ != std::string::npos);
@@ -54,7 +54,8 @@ namespace
       const auto colon = s_.rfind(':', from_ - 1);
       return is_number(s_, colon, from_) ?
                  boost::make_optional(number_at_end{
-                     std::stoi(s_.substr(colon + 1, from_ - colon - 1)),
+                     std::stoi(s_.substr(colon + 1, from_ - colon - 1)
+                                   .to_string()),
                      colon}) :
                  boost::none;
     }
@@ -70,33 +71,46 @@ namespace metashell
     file_location::file_location(const boost::filesystem::path& name,
                                  int row,
                                  int column)
-      : name(name), row(row), column(column)
+      : name(name.string()), row(row), column(column)
+    {
+    }
+
+    file_location::file_location(interned_string name, int row, int column)
+      : name(std::move(name)), row(row), column(column)
     {
     }
 
     file_location file_location::parse(const std::string& s_)
+    {
+      string_table names;
+      return parse(s_, names);
+    }
+
+    file_location file_location::parse(boost::string_view s_,
+                                       string_table& names_)
     {
       if (const auto n1 = parse_last_number(s_, s_.size()))
       {
         if (const auto n2 = parse_last_number(s_, n1->colon_at))
         {
-          return file_location(
-              s_.substr(0, n2->colon_at), n2->result, n1->result);
+          return file_location(names_.intern(s_.substr(0, n2->colon_at)),
+                               n2->result, n1->result);
         }
         else
         {
-          return file_location(s_.substr(0, n1->colon_at), n1->result, 1);
+          return file_location(
+              names_.intern(s_.substr(0, n1->colon_at)), n1->result, 1);
         }
       }
       else
       {
-        return file_location(s_, 1, 1);
+        return file_location(names_.intern(s_), 1, 1);
       }
     }
 
     std::ostream& operator<<(std::ostream& os, const file_location& location)
     {
-      os << location.name.string() << ":" << location.row << ":"
+      os << location.name << ":" << location.row << ":"
          << location.column;
       return os;
     }
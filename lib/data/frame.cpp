@@ -88,6 +88,7 @@ namespace metashell
 
     frame::frame(const event_data& event_, metaprogram_mode mode_)
       : _node(to_metaprogram_node(name(event_))),
+        _full_name(data::full_name(event_)),
         _source_location(source_location_of(event_)),
         _point_of_event((mode_ == metaprogram_mode::normal ||
                          mode_ == metaprogram_mode::profile) ?
@@ -106,6 +107,8 @@ namespace metashell
 
     const metaprogram_node& frame::node() const { return _node; }
 
+    const interned_string& frame::full_name() const { return _full_name; }
+
     const file_location& frame::source_location() const
     {
       return _source_location;
@@ -0,0 +1,73 @@
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <metashell/data/include_graph.hpp>
+
+#include <iostream>
+
+namespace metashell
+{
+  namespace data
+  {
+    void include_graph::add(const boost::filesystem::path& includer_,
+                            const boost::filesystem::path& header_)
+    {
+      _headers.insert(header_);
+      _included[includer_].insert(header_);
+    }
+
+    void include_graph::add(const include_graph& graph_)
+    {
+      for (const auto& i : graph_._included)
+      {
+        for (const boost::filesystem::path& header : i.second)
+        {
+          add(i.first, header);
+        }
+      }
+    }
+
+    const std::set<boost::filesystem::path>& include_graph::headers() const
+    {
+      return _headers;
+    }
+
+    std::set<boost::filesystem::path>
+    include_graph::included_by(const boost::filesystem::path& includer_) const
+    {
+      const auto i = _included.find(includer_);
+      return i == _included.end() ? std::set<boost::filesystem::path>() :
+                                    i->second;
+    }
+
+    bool include_graph::operator==(const include_graph& g_) const
+    {
+      return _included == g_._included;
+    }
+
+    std::ostream& operator<<(std::ostream& out_, const include_graph& g_)
+    {
+      out_ << "{";
+      bool first = true;
+      for (const boost::filesystem::path& header : g_.headers())
+      {
+        out_ << (first ? "" : ", ") << header;
+        first = false;
+      }
+      return out_ << "}";
+    }
+  }
+}
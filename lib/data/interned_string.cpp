@@ -0,0 +1,94 @@
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <metashell/data/interned_string.hpp>
+
+#include <boost/functional/hash.hpp>
+
+#include <ostream>
+
+namespace metashell
+{
+  namespace data
+  {
+    interned_string::interned_string() {}
+
+    interned_string::interned_string(boost::string_view value_)
+      : _value(value_.empty() ? nullptr :
+                                std::make_shared<const std::string>(
+                                    value_.data(), value_.size()))
+    {
+    }
+
+    const std::string& interned_string::value() const
+    {
+      if (_value)
+      {
+        return *_value;
+      }
+      else
+      {
+        static const std::string empty;
+        return empty;
+      }
+    }
+
+    bool interned_string::empty() const { return !_value; }
+
+    std::string to_string(const interned_string& s_) { return s_.value(); }
+
+    std::ostream& operator<<(std::ostream& o_, const interned_string& s_)
+    {
+      return o_ << s_.value();
+    }
+
+    bool operator==(const interned_string& a_, const interned_string& b_)
+    {
+      return &a_.value() == &b_.value() || a_.value() == b_.value();
+    }
+
+    bool identical(const interned_string& a_, const interned_string& b_)
+    {
+      return &a_.value() == &b_.value();
+    }
+
+    bool operator<(const interned_string& a_, const interned_string& b_)
+    {
+      return &a_.value() != &b_.value() && a_.value() < b_.value();
+    }
+
+    interned_string string_table::intern(boost::string_view s_)
+    {
+      const auto i = _strings.find(s_);
+      if (i == _strings.end())
+      {
+        const interned_string result(s_);
+        _strings.emplace(boost::string_view(result.value()), result);
+        return result;
+      }
+      else
+      {
+        return i->second;
+      }
+    }
+
+    std::size_t string_table::string_view_hash::
+    operator()(boost::string_view s_) const
+    {
+      return boost::hash_range(s_.begin(), s_.end());
+    }
+  }
+}
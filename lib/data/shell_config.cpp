@@ -47,6 +47,18 @@ namespace metashell
       out_.key("preprocessor_mode");
       out_.bool_(cfg_.preprocessor_mode);
 
+      out_.key("single_pass_evaluation");
+      out_.bool_(cfg_.single_pass_evaluation);
+
+      out_.key("timeout");
+      out_.int_(cfg_.limits.wall_time);
+
+      out_.key("cpu_time_limit");
+      out_.int_(cfg_.limits.cpu_time);
+
+      out_.key("memory_limit");
+      out_.int_(cfg_.limits.memory);
+
       out_.end_object();
     }
   }
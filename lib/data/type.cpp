@@ -102,7 +102,12 @@ namespace metashell
 
     bool is_remove_ptr(const type& type_)
     {
-      return type_ == "metashell::impl::remove_ptr";
+      return is_remove_ptr(type_.name().value());
+    }
+
+    bool is_remove_ptr(const std::string& name_)
+    {
+      return name_ == "metashell::impl::remove_ptr";
     }
   }
 } // namespace metashell:data
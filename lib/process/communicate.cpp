@@ -0,0 +1,183 @@
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <metashell/make_unique.hpp>
+#include <metashell/process/exception.hpp>
+
+#include "communicate.hpp"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <string>
+
+namespace metashell
+{
+  namespace process
+  {
+    namespace
+    {
+      // The data is read and written in large chunks. The output is read
+      // directly into the result strings.
+      const std::size_t chunk_size = 64 * 1024;
+
+#ifndef _WIN32
+      // Writing to a pipe the reader of which has exited raises SIGPIPE. It
+      // is blocked in the calling thread while the input is written and the
+      // SIGPIPE raised by the writing is discarded.
+      class sigpipe_blocked
+      {
+      public:
+        sigpipe_blocked()
+        {
+          sigemptyset(&_sigpipe);
+          sigaddset(&_sigpipe, SIGPIPE);
+
+          sigset_t pending;
+          sigpending(&pending);
+          _was_pending = sigismember(&pending, SIGPIPE);
+
+          pthread_sigmask(SIG_BLOCK, &_sigpipe, &_old_mask);
+        }
+
+        ~sigpipe_blocked()
+        {
+          sigset_t pending;
+          sigpending(&pending);
+          if (!_was_pending && sigismember(&pending, SIGPIPE))
+          {
+            int sig;
+            sigwait(&_sigpipe, &sig);
+          }
+
+          pthread_sigmask(SIG_SETMASK, &_old_mask, nullptr);
+        }
+
+        sigpipe_blocked(const sigpipe_blocked&) = delete;
+        sigpipe_blocked& operator=(const sigpipe_blocked&) = delete;
+
+      private:
+        sigset_t _sigpipe;
+        sigset_t _old_mask;
+        bool _was_pending;
+      };
+#endif
+    }
+
+    bool read_available(input_file& in_, std::string& out_)
+    {
+      const std::size_t used = out_.size();
+      if (out_.capacity() < used + chunk_size)
+      {
+        out_.reserve(std::max(2 * out_.capacity(), used + chunk_size));
+      }
+      out_.resize(used + chunk_size);
+
+      const input_file::size_type len = in_.read(&out_[used], chunk_size);
+      out_.resize(used + (len > 0 ? len : 0));
+
+#ifdef _WIN32
+      return len > 0;
+#else
+      return len > 0 || (len < 0 && errno == EINTR);
+#endif
+    }
+
+#ifndef _WIN32
+    void communicate(output_file* in_,
+                     const std::string& input_,
+                     std::tuple<input_file&, std::string&> out1_,
+                     std::tuple<input_file&, std::string&> out2_)
+    {
+      std::get<1>(out1_).clear();
+      std::get<1>(out2_).clear();
+
+      if (in_ && input_.empty())
+      {
+        in_->close();
+        in_ = nullptr;
+      }
+
+      std::unique_ptr<sigpipe_blocked> sigpipe;
+      if (in_)
+      {
+        // Writing only as much as the pipe can take, to keep reading the
+        // output while the reader is busy.
+        fcntl(in_->fd(), F_SETFL, fcntl(in_->fd(), F_GETFL) | O_NONBLOCK);
+        sigpipe = metashell::make_unique<sigpipe_blocked>();
+      }
+
+      // A negative fd is ignored by poll. It is used for the files that have
+      // been finished.
+      pollfd fds[3] = {{in_ ? in_->fd() : -1, POLLOUT, 0},
+                       {std::get<0>(out1_).fd(), POLLIN, 0},
+                       {std::get<0>(out2_).fd(), POLLIN, 0}};
+      input_file* in[3] = {nullptr, &std::get<0>(out1_), &std::get<0>(out2_)};
+      std::string* out[3] = {nullptr, &std::get<1>(out1_), &std::get<1>(out2_)};
+
+      std::size_t written = 0;
+      int open_files = in_ ? 3 : 2;
+      while (open_files > 0)
+      {
+        if (poll(fds, 3, -1) == -1)
+        {
+          if (errno == EINTR)
+          {
+            continue;
+          }
+          throw exception(std::string("Failed to wait for the process: ") +
+                          strerror(errno));
+        }
+
+        if (fds[0].fd >= 0 && fds[0].revents != 0)
+        {
+          const output_file::size_type len =
+              in_->write(input_.data() + written,
+                         std::min(chunk_size, input_.size() - written));
+          if (len > 0)
+          {
+            written += len;
+          }
+          if (written == input_.size() ||
+              (len < 0 && errno != EAGAIN && errno != EINTR))
+          {
+            in_->close();
+            fds[0].fd = -1;
+            --open_files;
+          }
+        }
+
+        for (int i = 1; i != 3; ++i)
+        {
+          if (fds[i].fd >= 0 && fds[i].revents != 0 &&
+              !read_available(*in[i], *out[i]))
+          {
+            fds[i].fd = -1;
+            --open_files;
+          }
+        }
+      }
+    }
+#endif
+  }
+}
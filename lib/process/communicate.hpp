@@ -0,0 +1,47 @@
+#ifndef METASHELL_PROCESS_COMMUNICATE_HPP
+#define METASHELL_PROCESS_COMMUNICATE_HPP
+
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <metashell/process/input_file.hpp>
+#include <metashell/process/output_file.hpp>
+
+#include <string>
+#include <tuple>
+
+namespace metashell
+{
+  namespace process
+  {
+    // Reads the available data from in_ (at most one chunk) and appends it to
+    // out_. Returns false when there is nothing more to read.
+    bool read_available(input_file& in_, std::string& out_);
+
+#ifndef _WIN32
+    // Writes input_ to in_ and reads out1_ and out2_ until their end in one
+    // event loop. in_ is closed when the input has been written or the
+    // reader has closed its end. in_ can be null when there is no input to
+    // write.
+    void communicate(output_file* in_,
+                     const std::string& input_,
+                     std::tuple<input_file&, std::string&> out1_,
+                     std::tuple<input_file&, std::string&> out2_);
+#endif
+  }
+}
+
+#endif
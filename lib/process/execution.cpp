@@ -14,26 +14,33 @@
 // You should have received a copy of the GNU General Public License
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
+#include <metashell/make_unique.hpp>
+#include <metashell/process/cancelled.hpp>
 #include <metashell/process/exception.hpp>
 #include <metashell/process/execution.hpp>
+#include <metashell/process/limit_exceeded.hpp>
 
 #include "file_util.hpp"
+#include "process_groups.hpp"
+#include "spawn.hpp"
+#include "watchdog.hpp"
 
 #include <boost/algorithm/string/join.hpp>
 
 #ifndef _WIN32
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/time.h>
 #include <sys/types.h>
 #include <sys/wait.h>
 #endif
 
-#include <algorithm>
+#include <cerrno>
 #include <sstream>
 
+#ifdef _WIN32
 namespace
 {
-  const char* c_str(const std::string& s_) { return s_.c_str(); }
-
-#ifdef _WIN32
   void clear(PROCESS_INFORMATION& pi_)
   {
     pi_.hProcess = 0;
@@ -41,8 +48,8 @@ namespace
     pi_.dwProcessId = 0;
     pi_.dwThreadId = 0;
   }
-#endif
 }
+#endif
 
 namespace metashell
 {
@@ -51,7 +58,9 @@ namespace metashell
 #ifdef _WIN32
     execution::execution(const boost::filesystem::path& binary_,
                          const std::vector<std::string>& args_,
-                         const boost::filesystem::path& cwd_)
+                         const boost::filesystem::path& cwd_,
+                         const data::resource_limits& limits_)
+      : _limits(limits_)
     {
       const std::string cmds =
           binary_.string() + " " + boost::algorithm::join(args_, " ");
@@ -92,6 +101,14 @@ namespace metashell
 
         _standard_output.output.close();
         _standard_error.output.close();
+
+        if (_limits.wall_time > 0)
+        {
+          const HANDLE process = _process_information.hProcess;
+          _watchdog = metashell::make_unique<watchdog>(
+              std::chrono::seconds(_limits.wall_time),
+              [process] { TerminateProcess(process, 1); });
+        }
       }
       else
       {
@@ -114,58 +131,33 @@ namespace metashell
 #ifndef _WIN32
     execution::execution(const boost::filesystem::path& binary_,
                          const std::vector<std::string>& args_,
-                         const boost::filesystem::path& cwd_)
+                         const boost::filesystem::path& cwd_,
+                         const data::resource_limits& limits_)
+      : _limits(limits_),
+        _process_group(-1),
+        _terminating_signal(0),
+        _max_resident_set_size(0)
     {
-      std::vector<const char*> cmd(args_.size() + 2, 0);
-      cmd[0] = binary_.c_str();
-      std::transform(args_.begin(), args_.end(), cmd.begin() + 1, ::c_str);
+      // The child gets its own process group, so the processes it starts can
+      // be killed together with it on cancellation.
+      const int cancellations_before_start = cancellations();
 
-      pipe error_reporting;
+      _pid = spawn(binary_, args_, cwd_, _limits, _standard_input.input.fd(),
+                   _standard_output.output.fd(), _standard_error.output.fd());
 
-      switch (_pid = fork())
-      {
-      case -1:
-        throw exception("Failed to fork");
-      case 0: // in child
-        if (cwd_.empty() || chdir(cwd_.c_str()) == 0)
-        {
-          _standard_input.output.close();
-          _standard_output.input.close();
-          _standard_error.input.close();
-          error_reporting.input.close();
-          close_on_exec(error_reporting.output);
+      _process_group = register_process_group(_pid, cancellations_before_start);
 
-          use_as(_standard_input.input, STDIN_FILENO);
-          use_as(_standard_output.output, STDOUT_FILENO);
-          use_as(_standard_error.output, STDERR_FILENO);
+      _standard_input.input.close();
 
-          execv(cmd[0], const_cast<char* const*>(&cmd[0]));
-        }
-        {
-          const int err = errno;
-          std::ostringstream s;
-          s << "Error running " << binary_ << " "
-            << boost::algorithm::join(args_, " ") << ": " << strerror(err);
-          error_reporting.output.write(s.str());
-        }
-        _exit(0);
-      default: // in parent
-        _standard_input.input.close();
-
-        _standard_output.output.close();
-        _standard_error.output.close();
-
-        error_reporting.output.close();
-
-        std::string err;
-        read_all(std::tie(error_reporting.input, err));
+      _standard_output.output.close();
+      _standard_error.output.close();
 
-        if (!err.empty())
-        {
-          int status;
-          waitpid(_pid, &status, 0);
-          throw exception(err);
-        }
+      if (_limits.wall_time > 0)
+      {
+        const pid_t pid = _pid;
+        _watchdog = metashell::make_unique<watchdog>(
+            std::chrono::seconds(_limits.wall_time),
+            [pid] { kill(-pid, SIGKILL); });
       }
     }
 #endif
@@ -174,16 +166,22 @@ namespace metashell
       : _standard_input(std::move(e_._standard_input)),
         _standard_output(std::move(e_._standard_output)),
         _standard_error(std::move(e_._standard_error)),
+        _limits(e_._limits),
+        _watchdog(std::move(e_._watchdog)),
 #ifdef _WIN32
         _process_information(e_._process_information)
 #else
-        _pid(e_._pid)
+        _pid(e_._pid),
+        _process_group(e_._process_group),
+        _terminating_signal(e_._terminating_signal),
+        _max_resident_set_size(e_._max_resident_set_size)
 #endif
     {
 #ifdef _WIN32
       clear(e_._process_information);
 #else
       e_._pid = 0;
+      e_._process_group = -1;
 #endif
     }
 
@@ -194,12 +192,19 @@ namespace metashell
         _standard_input = std::move(e_._standard_input);
         _standard_output = std::move(e_._standard_output);
         _standard_error = std::move(e_._standard_error);
+        _limits = e_._limits;
+        _watchdog = std::move(e_._watchdog);
 #ifdef _WIN32
         _process_information = e_._process_information;
         clear(e_._process_information);
 #else
+        unregister_process_group(_process_group);
         _pid = e_._pid;
+        _process_group = e_._process_group;
+        _terminating_signal = e_._terminating_signal;
+        _max_resident_set_size = e_._max_resident_set_size;
         e_._pid = 0;
+        e_._process_group = -1;
 #endif
       }
       return *this;
@@ -207,8 +212,9 @@ namespace metashell
 
     execution::~execution()
     {
-      // Defined only to make sure code using the execution class does not
-      // need the destructor of execution_data
+#ifndef _WIN32
+      unregister_process_group(_process_group);
+#endif
     }
 
     output_file& execution::standard_input() { return _standard_input.output; }
@@ -222,6 +228,15 @@ namespace metashell
     {
       WaitForSingleObject(_process_information.hProcess, INFINITE);
 
+      if (_watchdog)
+      {
+        _watchdog->stop();
+        if (_watchdog->fired())
+        {
+          throw limit_exceeded(limit::wall_time, _limits.wall_time);
+        }
+      }
+
       DWORD exit_code;
       if (!GetExitCodeProcess(_process_information.hProcess, &exit_code))
       {
@@ -234,10 +249,57 @@ namespace metashell
 #ifndef _WIN32
     data::exit_code_t execution::wait()
     {
+      // The watchdog is stopped and the process group is unregistered after
+      // the process has terminated but before it is reaped, so neither the
+      // watchdog nor cancel_running_processes can kill another process
+      // reusing the pid.
+      siginfo_t info;
+      while (waitid(P_PID, _pid, &info, WEXITED | WNOWAIT) == -1 &&
+             errno == EINTR)
+      {
+      }
+      if (_watchdog)
+      {
+        _watchdog->stop();
+      }
+      const bool killed = unregister_process_group(_process_group);
+      _process_group = -1;
+
+      // The resource usage contains the children of the process it has waited
+      // for (eg. the compiler started by a compiler driver).
       int status;
-      waitpid(_pid, &status, 0);
+      rusage usage = rusage();
+      while (wait4(_pid, &status, 0, &usage) == -1 && errno == EINTR)
+      {
+      }
+#ifdef __APPLE__
+      // It is in bytes on macOS and in kilobytes elsewhere
+      _max_resident_set_size = std::uintmax_t(usage.ru_maxrss);
+#else
+      _max_resident_set_size = std::uintmax_t(usage.ru_maxrss) * 1024;
+#endif
+
+      if (killed)
+      {
+        throw cancelled();
+      }
+
+      if (_watchdog && _watchdog->fired())
+      {
+        throw limit_exceeded(limit::wall_time, _limits.wall_time);
+      }
+
+      _terminating_signal = WIFSIGNALED(status) ? WTERMSIG(status) : 0;
+
       return data::exit_code_t(WIFEXITED(status) ? WEXITSTATUS(status) : -1);
     }
+
+    int execution::terminating_signal() const { return _terminating_signal; }
+
+    std::uintmax_t execution::max_resident_set_size() const
+    {
+      return _max_resident_set_size;
+    }
 #endif
   }
 }
@@ -25,6 +25,14 @@ namespace metashell
 {
   namespace process
   {
+#ifndef _WIN32
+    std::mutex& spawn_mutex()
+    {
+      static std::mutex m;
+      return m;
+    }
+#endif
+
     void close_on_exec(output_file& file_)
     {
 #ifndef _WIN32
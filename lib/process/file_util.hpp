@@ -20,6 +20,8 @@
 #include <metashell/process/file.hpp>
 #include <metashell/process/output_file.hpp>
 
+#include <mutex>
+
 namespace metashell
 {
   namespace process
@@ -50,6 +52,12 @@ namespace metashell
     }
 #endif
 
+#ifndef _WIN32
+    // Held while starting a process and while creating a pipe on platforms
+    // where the pipe can not be made close-on-exec atomically.
+    std::mutex& spawn_mutex();
+#endif
+
     void close_on_exec(output_file& file_);
   }
 }
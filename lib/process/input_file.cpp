@@ -16,10 +16,13 @@
 
 #include <metashell/process/input_file.hpp>
 
+#include "communicate.hpp"
+
+#ifdef _WIN32
 #include <boost/thread.hpp>
+#endif
 
 #include <cassert>
-#include <sstream>
 
 namespace metashell
 {
@@ -75,15 +78,13 @@ namespace metashell
 
     void read_all(std::tuple<input_file&, std::string&> io1_)
     {
-      std::ostringstream s;
-      std::array<char, 1024> buff;
-      while (!std::get<0>(io1_).eof())
+      std::get<1>(io1_).clear();
+      while (read_available(std::get<0>(io1_), std::get<1>(io1_)))
       {
-        s.write(buff.data(), std::get<0>(io1_).read(buff));
       }
-      std::get<1>(io1_) = s.str();
     }
 
+#ifdef _WIN32
     void read_all(std::tuple<input_file&, std::string&> io1_,
                   std::tuple<input_file&, std::string&> io2_)
     {
@@ -92,6 +93,15 @@ namespace metashell
 
       reader2.join();
     }
+#endif
+
+#ifndef _WIN32
+    void read_all(std::tuple<input_file&, std::string&> io1_,
+                  std::tuple<input_file&, std::string&> io2_)
+    {
+      communicate(nullptr, std::string(), io1_, io2_);
+    }
+#endif
 
     input_file::iterator input_file::begin() const
     {
@@ -0,0 +1,56 @@
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <metashell/process/limit_exceeded.hpp>
+
+#include <cassert>
+#include <string>
+
+namespace metashell
+{
+  namespace process
+  {
+    namespace
+    {
+      std::string description(limit limit_, int value_)
+      {
+        const std::string v = std::to_string(value_);
+        switch (limit_)
+        {
+        case limit::wall_time:
+          return "Time limit (" + v + " seconds)";
+        case limit::cpu_time:
+          return "CPU time limit (" + v + " seconds)";
+        case limit::memory:
+          return "Memory limit (" + v + " MB)";
+        }
+        assert(!"Invalid limit");
+        return "";
+      }
+    }
+
+    limit_exceeded::limit_exceeded(limit limit_, int value_)
+      : exception(description(limit_, value_) + " exceeded"),
+        _limit(limit_),
+        _value(value_)
+    {
+    }
+
+    limit limit_exceeded::exceeded() const { return _limit; }
+
+    int limit_exceeded::value() const { return _value; }
+  }
+}
@@ -0,0 +1,66 @@
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <metashell/process/limit_exceeded.hpp>
+
+#include "limit_signal.hpp"
+
+#ifndef _WIN32
+#include <signal.h>
+#endif
+
+namespace metashell
+{
+  namespace process
+  {
+#ifndef _WIN32
+    namespace
+    {
+      bool allocation_failed(const std::string& standard_error_)
+      {
+        for (const char* message :
+             {"out of memory", "std::bad_alloc", "Allocation failed",
+              "Cannot allocate memory"})
+        {
+          if (standard_error_.find(message) != std::string::npos)
+          {
+            return true;
+          }
+        }
+        return false;
+      }
+    }
+
+    void check_limit_signal(int sig_,
+                            const data::resource_limits& limits_,
+                            std::uintmax_t max_resident_set_size_,
+                            const std::string& standard_error_)
+    {
+      if (sig_ == SIGXCPU && limits_.cpu_time > 0)
+      {
+        throw limit_exceeded(limit::cpu_time, limits_.cpu_time);
+      }
+      else if ((sig_ == SIGSEGV || sig_ == SIGABRT) && limits_.memory > 0 &&
+               (allocation_failed(standard_error_) ||
+                max_resident_set_size_ * 2 >=
+                    std::uintmax_t(limits_.memory) * 1024 * 1024))
+      {
+        throw limit_exceeded(limit::memory, limits_.memory);
+      }
+    }
+#endif
+  }
+}
@@ -0,0 +1,48 @@
+#ifndef METASHELL_PROCESS_LIMIT_SIGNAL_HPP
+#define METASHELL_PROCESS_LIMIT_SIGNAL_HPP
+
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <metashell/data/resource_limits.hpp>
+
+#include <cstdint>
+#include <string>
+
+namespace metashell
+{
+  namespace process
+  {
+#ifndef _WIN32
+    // Throws limit_exceeded when sig_, the signal terminating a process
+    // running with limits_, is the result of one of the limits. The CPU time
+    // limit is enforced by SIGXCPU. Allocations failing because of the memory
+    // limit make the process crash (SIGSEGV) or abort (SIGABRT), but so do
+    // the bugs of the process. These signals are attributed to the memory
+    // limit only when the process has reported a failed allocation on its
+    // standard error or its maximum resident set size (in bytes) has reached
+    // half of the limit. (The limit applies to the address space, which is
+    // larger than the resident set.) Other signals (eg. SIGKILL) are not
+    // attributed to any limit.
+    void check_limit_signal(int sig_,
+                            const data::resource_limits& limits_,
+                            std::uintmax_t max_resident_set_size_,
+                            const std::string& standard_error_);
+#endif
+  }
+}
+
+#endif
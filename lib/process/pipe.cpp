@@ -14,8 +14,11 @@
 // You should have received a copy of the GNU General Public License
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
+#include <metashell/process/exception.hpp>
 #include <metashell/process/pipe.hpp>
 
+#include "file_util.hpp"
+
 #ifdef _WIN32
 #include <windows.h>
 #else
@@ -31,6 +34,7 @@
 #include <cassert>
 #include <cstdlib>
 #include <iostream>
+#include <mutex>
 #include <sstream>
 #include <stdexcept>
 #include <string>
@@ -43,9 +47,27 @@ namespace metashell
     pipe::fds::fds()
     {
 #ifdef _WIN32
-      CreatePipe(_fd, _fd + 1, NULL, 0);
+      if (!CreatePipe(_fd, _fd + 1, NULL, 0))
+      {
+        throw exception("Failed to create pipe");
+      }
+#elif defined(__linux__)
+      // The processes started by other threads should not inherit the pipe,
+      // otherwise reading from it does not stop until they terminate.
+      if (::pipe2(_fd, O_CLOEXEC) == -1)
+      {
+        throw exception(std::string("Failed to create pipe: ") +
+                        strerror(errno));
+      }
 #else
-      ::pipe(_fd);
+      std::lock_guard<std::mutex> lock(spawn_mutex());
+      if (::pipe(_fd) == -1)
+      {
+        throw exception(std::string("Failed to create pipe: ") +
+                        strerror(errno));
+      }
+      fcntl(_fd[0], F_SETFD, FD_CLOEXEC);
+      fcntl(_fd[1], F_SETFD, FD_CLOEXEC);
 #endif
     }
 
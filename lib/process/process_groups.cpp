@@ -0,0 +1,106 @@
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <metashell/process/cancel.hpp>
+
+#include "process_groups.hpp"
+
+#ifndef _WIN32
+#include <signal.h>
+#endif
+
+#include <atomic>
+
+namespace metashell
+{
+  namespace process
+  {
+#ifndef _WIN32
+    namespace
+    {
+      const int max_process_groups = 64;
+
+      // 0 means an empty slot. The slots are updated without locking to make
+      // cancel_running_processes usable in signal handlers.
+      std::atomic<pid_t> process_groups[max_process_groups];
+      std::atomic<pid_t> killed_process_groups[max_process_groups];
+      std::atomic<int> cancellation_count(0);
+
+      void kill_process_group(int slot_, pid_t group_)
+      {
+        killed_process_groups[slot_] = group_;
+        // The process creates its group before spawn returns (the parent is
+        // suspended by vfork until the child calls exec), therefore killing
+        // the group kills the process and the processes it has started.
+        kill(-group_, SIGKILL);
+      }
+    }
+
+    int cancellations() { return cancellation_count; }
+
+    int register_process_group(pid_t group_, int cancellations_)
+    {
+      for (int i = 0; i != max_process_groups; ++i)
+      {
+        pid_t empty = 0;
+        if (process_groups[i].compare_exchange_strong(empty, group_))
+        {
+          if (cancellations_ != cancellation_count)
+          {
+            kill_process_group(i, group_);
+          }
+          return i;
+        }
+      }
+      // Too many processes running in parallel. This one can not be
+      // cancelled.
+      return -1;
+    }
+
+    bool unregister_process_group(int handle_)
+    {
+      if (handle_ < 0)
+      {
+        return false;
+      }
+      else
+      {
+        const pid_t group = process_groups[handle_];
+        const bool killed = killed_process_groups[handle_].exchange(0) == group;
+        process_groups[handle_] = 0;
+        return killed;
+      }
+    }
+
+    void cancel_running_processes()
+    {
+      ++cancellation_count;
+      for (int i = 0; i != max_process_groups; ++i)
+      {
+        const pid_t group = process_groups[i];
+        if (group != 0)
+        {
+          kill_process_group(i, group);
+        }
+      }
+    }
+#endif
+
+#ifdef _WIN32
+    void cancel_running_processes() {}
+#endif
+  }
+}
@@ -0,0 +1,45 @@
+#ifndef METASHELL_PROCESS_PROCESS_GROUPS_HPP
+#define METASHELL_PROCESS_PROCESS_GROUPS_HPP
+
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef _WIN32
+#include <sys/types.h>
+#endif
+
+namespace metashell
+{
+  namespace process
+  {
+#ifndef _WIN32
+    // The number of cancel_running_processes calls so far
+    int cancellations();
+
+    // Registers a running process group to kill on cancellation. When
+    // cancel_running_processes has been called since cancellations_ was
+    // queried, the group is killed right away. It returns a handle for
+    // unregister_process_group.
+    int register_process_group(pid_t group_, int cancellations_);
+
+    // Returns if the process group has been killed by
+    // cancel_running_processes.
+    bool unregister_process_group(int handle_);
+#endif
+  }
+}
+
+#endif
@@ -17,27 +17,140 @@
 #include <metashell/process/execution.hpp>
 #include <metashell/process/run.hpp>
 
+#include "communicate.hpp"
+#include "limit_signal.hpp"
+
+#ifdef _WIN32
+#include <boost/thread.hpp>
+#else
+#include <signal.h>
+#include <cstring>
+#endif
+
+#include <sstream>
+#include <string>
+
 namespace metashell
 {
   namespace process
   {
+#ifndef _WIN32
+    namespace
+    {
+      bool starts_with(const std::string& s_, const std::string& prefix_)
+      {
+        return s_.compare(0, prefix_.size(), prefix_) == 0;
+      }
+
+      // Compiler drivers (eg. clang) run the compiler in a child process and
+      // report when it is terminated by a signal:
+      //
+      //   clang: error: unable to execute command: Segmentation fault
+      //
+      // The driver names itself after its binary or (when it is started
+      // through a symlink) after the clang binary it points to. Returns the
+      // signal or 0 when line_ is not such a report.
+      int signal_reported_by_driver(const std::string& line_,
+                                    const boost::filesystem::path& binary_)
+      {
+        const std::string marker = ": error: unable to execute command: ";
+
+        const auto pos = line_.find(marker);
+        if (pos != std::string::npos)
+        {
+          const std::string driver = line_.substr(0, pos);
+          const std::string reason = line_.substr(pos + marker.size());
+
+          if (driver == binary_.filename().string() ||
+              (starts_with(driver, "clang") &&
+               driver.find_first_of(": \t") == std::string::npos))
+          {
+            for (int sig : {SIGXCPU, SIGSEGV, SIGABRT})
+            {
+              // The description may be followed by " (core dumped)"
+              const std::string description = strsignal(sig);
+              if (reason == description ||
+                  starts_with(reason, description + " ("))
+              {
+                return sig;
+              }
+            }
+          }
+        }
+        return 0;
+      }
+
+      // Throws limit_exceeded when the process (or the compiler started by
+      // it) has been terminated because of a limit. A process crashing for
+      // another reason is reported on its standard error.
+      void check_termination(const boost::filesystem::path& binary_,
+                             const execution& child_,
+                             data::process_output& o_,
+                             const data::resource_limits& limits_)
+      {
+        if (const int sig = child_.terminating_signal())
+        {
+          check_limit_signal(sig, limits_, child_.max_resident_set_size(),
+                             o_.standard_error);
+
+          if (!o_.standard_error.empty() && o_.standard_error.back() != '\n')
+          {
+            o_.standard_error += '\n';
+          }
+          o_.standard_error += binary_.filename().string() +
+                               ": terminated by signal: " + strsignal(sig) +
+                               "\n";
+        }
+        else if (o_.exit_code != data::exit_code_t(0))
+        {
+          std::istringstream err(o_.standard_error);
+          for (std::string line; std::getline(err, line);)
+          {
+            if (const int sig = signal_reported_by_driver(line, binary_))
+            {
+              check_limit_signal(sig, limits_,
+                                 child_.max_resident_set_size(),
+                                 o_.standard_error);
+            }
+          }
+        }
+      }
+    }
+#endif
+
     data::process_output run(const boost::filesystem::path& binary_,
                              const std::vector<std::string>& args_,
                              const std::string& input_,
-                             const boost::filesystem::path& cwd_)
+                             const boost::filesystem::path& cwd_,
+                             const data::resource_limits& limits_)
     {
-      execution child(binary_, args_, cwd_);
-
-      child.standard_input().write(input_);
-      child.standard_input().close();
+      execution child(binary_, args_, cwd_, limits_);
 
       data::process_output result{data::exit_code_t(0), "", ""};
 
+      // The input is written while the output is being read. Otherwise the
+      // process could block on writing its output while Metashell blocks on
+      // writing the input.
+#ifdef _WIN32
+      boost::thread writer([&child, &input_] {
+        child.standard_input().write(input_);
+        child.standard_input().close();
+      });
       read_all(std::tie(child.standard_output(), result.standard_output),
                std::tie(child.standard_error(), result.standard_error));
+      writer.join();
+#else
+      communicate(&child.standard_input(), input_,
+                  std::tie(child.standard_output(), result.standard_output),
+                  std::tie(child.standard_error(), result.standard_error));
+#endif
 
       result.exit_code = child.wait();
 
+#ifndef _WIN32
+      check_termination(binary_, child, result, limits_);
+#endif
+
       return result;
     }
   }
@@ -0,0 +1,208 @@
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <metashell/process/exception.hpp>
+#include <metashell/process/pipe.hpp>
+
+#include "file_util.hpp"
+#include "spawn.hpp"
+
+#include <boost/algorithm/string/join.hpp>
+
+#ifndef _WIN32
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <mutex>
+#include <sstream>
+
+#ifndef _WIN32
+namespace
+{
+  const char* c_str(const std::string& s_) { return s_.c_str(); }
+
+  // Everything the child does between vfork and exec. The child shares the
+  // memory of Metashell until it calls exec, therefore it can only make
+  // system calls: it can not allocate memory or modify any object.
+  struct child_setup
+  {
+    const char* const* argv;
+    // nullptr when the working directory is not changed
+    const char* cwd;
+    bool limit_cpu;
+    rlimit cpu;
+    bool limit_memory;
+    rlimit memory;
+    // The pipes are close-on-exec, dup2 clears it on the standard streams.
+    int stdin_fd;
+    int stdout_fd;
+    int stderr_fd;
+    // errno is written here when the child fails to start the binary
+    int error_fd;
+    sigset_t signal_mask;
+  };
+
+  child_setup prepare_child(const std::vector<const char*>& argv_,
+                            const boost::filesystem::path& cwd_,
+                            const metashell::data::resource_limits& limits_)
+  {
+    child_setup s;
+    s.argv = argv_.data();
+    s.cwd = cwd_.empty() ? nullptr : cwd_.c_str();
+
+    // The process gets SIGXCPU at the soft limit and SIGKILL at the hard
+    // limit.
+    s.limit_cpu = limits_.cpu_time > 0;
+    s.cpu.rlim_cur = limits_.cpu_time;
+    s.cpu.rlim_max = limits_.cpu_time + 1;
+
+    s.limit_memory = limits_.memory > 0;
+    s.memory.rlim_cur = rlim_t(limits_.memory) * 1024 * 1024;
+    s.memory.rlim_max = s.memory.rlim_cur;
+
+    return s;
+  }
+
+  [[noreturn]] void run_child(const child_setup& s_)
+  {
+    // The signal handlers of Metashell should not run in the child, because
+    // the child shares the memory of Metashell.
+    for (int sig = 1; sig < NSIG; ++sig)
+    {
+      struct sigaction a;
+      if (sigaction(sig, nullptr, &a) == 0 && a.sa_handler != SIG_IGN)
+      {
+        a.sa_handler = SIG_DFL;
+        a.sa_flags = 0;
+        sigaction(sig, &a, nullptr);
+      }
+    }
+    sigprocmask(SIG_SETMASK, &s_.signal_mask, nullptr);
+
+    setpgid(0, 0);
+    if (s_.limit_cpu)
+    {
+      setrlimit(RLIMIT_CPU, &s_.cpu);
+    }
+    if (s_.limit_memory)
+    {
+      setrlimit(RLIMIT_AS, &s_.memory);
+    }
+
+    if (s_.cwd == nullptr || chdir(s_.cwd) == 0)
+    {
+      dup2(s_.stdin_fd, STDIN_FILENO);
+      dup2(s_.stdout_fd, STDOUT_FILENO);
+      dup2(s_.stderr_fd, STDERR_FILENO);
+
+      execv(s_.argv[0], const_cast<char* const*>(s_.argv));
+    }
+
+    const int err = errno;
+    if (write(s_.error_fd, &err, sizeof(err)) != sizeof(err))
+    {
+      // There is no other way of reporting the error
+    }
+    _exit(127);
+  }
+}
+
+namespace metashell
+{
+  namespace process
+  {
+    pid_t spawn(const boost::filesystem::path& binary_,
+                const std::vector<std::string>& args_,
+                const boost::filesystem::path& cwd_,
+                const data::resource_limits& limits_,
+                fd_t stdin_,
+                fd_t stdout_,
+                fd_t stderr_)
+    {
+      std::vector<const char*> cmd(args_.size() + 2, 0);
+      cmd[0] = binary_.c_str();
+      std::transform(args_.begin(), args_.end(), cmd.begin() + 1, ::c_str);
+
+      pipe error_reporting;
+
+      child_setup setup = prepare_child(cmd, cwd_, limits_);
+      setup.stdin_fd = stdin_;
+      setup.stdout_fd = stdout_;
+      setup.stderr_fd = stderr_;
+      setup.error_fd = error_reporting.output.fd();
+
+      // Using vfork instead of fork, because fork has to copy the page
+      // tables of Metashell, which gets slow as Metashell grows (eg. with
+      // large debugger histories). No signal handler may run in the child
+      // before it resets them, therefore the signals are blocked around
+      // vfork.
+      sigset_t all_signals;
+      sigfillset(&all_signals);
+      pthread_sigmask(SIG_SETMASK, &all_signals, &setup.signal_mask);
+
+      pid_t pid = -1;
+      int vfork_error = 0;
+      {
+#ifndef __linux__
+        std::lock_guard<std::mutex> lock(spawn_mutex());
+#endif
+        pid = vfork();
+        if (pid == 0)
+        {
+          run_child(setup);
+        }
+        vfork_error = errno;
+      }
+
+      pthread_sigmask(SIG_SETMASK, &setup.signal_mask, nullptr);
+
+      if (pid == -1)
+      {
+        throw exception(std::string("Failed to start process: ") +
+                        strerror(vfork_error));
+      }
+
+      error_reporting.output.close();
+
+      std::string err;
+      read_all(std::tie(error_reporting.input, err));
+
+      if (!err.empty())
+      {
+        int status;
+        waitpid(pid, &status, 0);
+
+        int child_errno = 0;
+        std::memcpy(&child_errno, err.data(),
+                    std::min(err.size(), sizeof(child_errno)));
+        std::ostringstream s;
+        s << "Error running " << binary_ << " "
+          << boost::algorithm::join(args_, " ") << ": "
+          << strerror(child_errno);
+        throw exception(s.str());
+      }
+
+      return pid;
+    }
+  }
+}
+#endif
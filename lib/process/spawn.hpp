@@ -0,0 +1,52 @@
+#ifndef METASHELL_PROCESS_SPAWN_HPP
+#define METASHELL_PROCESS_SPAWN_HPP
+
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <metashell/data/resource_limits.hpp>
+#include <metashell/process/fd_t.hpp>
+
+#include <boost/filesystem/path.hpp>
+
+#ifndef _WIN32
+#include <sys/types.h>
+#endif
+
+#include <string>
+#include <vector>
+
+namespace metashell
+{
+  namespace process
+  {
+#ifndef _WIN32
+    // Starts binary_ using vfork and exec with the given file descriptors as
+    // its standard streams. It returns the pid of the process or throws
+    // process::exception when the binary can not be started. The process is
+    // put in its own process group.
+    pid_t spawn(const boost::filesystem::path& binary_,
+                const std::vector<std::string>& args_,
+                const boost::filesystem::path& cwd_,
+                const data::resource_limits& limits_,
+                fd_t stdin_,
+                fd_t stdout_,
+                fd_t stderr_);
+#endif
+  }
+}
+
+#endif
@@ -0,0 +1,56 @@
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "watchdog.hpp"
+
+namespace metashell
+{
+  namespace process
+  {
+    watchdog::watchdog(std::chrono::seconds timeout_,
+                       std::function<void()> on_timeout_)
+      : _stopping(false), _fired(false)
+    {
+      _thread = std::thread([this, timeout_, on_timeout_] {
+        std::unique_lock<std::mutex> lock(_mutex);
+        if (!_stop_requested.wait_for(
+                lock, timeout_, [this] { return _stopping; }))
+        {
+          _fired = true;
+          on_timeout_();
+        }
+      });
+    }
+
+    watchdog::~watchdog() { stop(); }
+
+    void watchdog::stop()
+    {
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopping = true;
+      }
+      _stop_requested.notify_one();
+
+      if (_thread.joinable())
+      {
+        _thread.join();
+      }
+    }
+
+    bool watchdog::fired() const { return _fired; }
+  }
+}
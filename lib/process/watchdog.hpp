@@ -0,0 +1,60 @@
+#ifndef METASHELL_PROCESS_WATCHDOG_HPP
+#define METASHELL_PROCESS_WATCHDOG_HPP
+
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace metashell
+{
+  namespace process
+  {
+    // Calls a function on a background thread when it is not stopped in
+    // time. It is used to kill processes exceeding their wall-clock time
+    // limit.
+    class watchdog
+    {
+    public:
+      watchdog(std::chrono::seconds timeout_,
+               std::function<void()> on_timeout_);
+
+      watchdog(const watchdog&) = delete;
+      watchdog& operator=(const watchdog&) = delete;
+
+      ~watchdog();
+
+      // After stop returns, the function is not called any more.
+      void stop();
+
+      // Has the function been called? It can be queried after stop.
+      bool fired() const;
+
+    private:
+      std::mutex _mutex;
+      std::condition_variable _stop_requested;
+      bool _stopping;
+      bool _fired;
+      std::thread _thread;
+    };
+  }
+}
+
+#endif
@@ -0,0 +1,106 @@
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "benchmark.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+
+namespace metashell
+{
+  namespace benchmark
+  {
+    std::map<std::string, benchmark_function>& benchmarks()
+    {
+      static std::map<std::string, benchmark_function> b;
+      return b;
+    }
+
+    registration::registration(const std::string& name_, benchmark_function f_)
+    {
+      benchmarks()[name_] = f_;
+    }
+
+    double median(std::vector<double> values_)
+    {
+      if (values_.empty())
+      {
+        throw std::runtime_error("No measurements");
+      }
+
+      std::sort(values_.begin(), values_.end());
+      return values_[values_.size() / 2];
+    }
+
+    double median_ms(int iterations_, const std::function<void()>& f_)
+    {
+      std::vector<double> times;
+      times.reserve(std::max(iterations_, 1));
+
+      for (int i = 0; i < std::max(iterations_, 1); ++i)
+      {
+        const auto start = std::chrono::steady_clock::now();
+        f_();
+        times.push_back(std::chrono::duration<double, std::milli>(
+                            std::chrono::steady_clock::now() - start)
+                            .count());
+      }
+
+      return median(std::move(times));
+    }
+
+    clang_binary clang(const arguments& args_,
+                       const boost::filesystem::path& internal_dir_)
+    {
+      if (args_.engine_args.empty())
+      {
+        throw std::runtime_error(
+            "This benchmark needs a Clang binary specified after --");
+      }
+
+      std::vector<std::string> base_args{
+          "-iquote", ".", "-x", "c++-header", "-I", internal_dir_.string()};
+      base_args.insert(base_args.end(), args_.engine_args.begin() + 1,
+                       args_.engine_args.end());
+
+      return clang_binary(args_.engine_args.front(), base_args, nullptr);
+    }
+
+    data::cpp_code environment(const arguments& args_)
+    {
+      std::string result = "namespace metashell { namespace impl {\n"
+                           "  template <class T> struct wrap {};\n"
+                           "} }\n";
+      for (const std::string& header : args_.includes)
+      {
+        result += "#include <" + header + ">\n";
+      }
+      return data::cpp_code(result);
+    }
+
+    void report(std::ostream& out_,
+                const std::string& benchmark_,
+                const std::string& measurement_,
+                double value_,
+                const std::string& unit_)
+    {
+      out_ << benchmark_ << "\t" << measurement_ << "\t" << value_ << " "
+           << unit_ << std::endl;
+    }
+  }
+}
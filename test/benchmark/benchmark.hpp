@@ -0,0 +1,83 @@
+#ifndef METASHELL_BENCHMARK_BENCHMARK_HPP
+#define METASHELL_BENCHMARK_BENCHMARK_HPP
+
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <metashell/clang_binary.hpp>
+#include <metashell/data/cpp_code.hpp>
+
+#include <boost/filesystem/path.hpp>
+
+#include <functional>
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace metashell
+{
+  namespace benchmark
+  {
+    struct arguments
+    {
+      // The compiler binary followed by its arguments (provided after --)
+      std::vector<std::string> engine_args;
+      // Headers to include in the environment of the measured evaluations
+      std::vector<std::string> includes;
+      std::string expression = "int";
+      int iterations = 10;
+      // The number of template instantiations in the synthetic traces
+      int trace_entries = 10000000;
+    };
+
+    typedef std::function<void(const arguments&, std::ostream&)>
+        benchmark_function;
+
+    std::map<std::string, benchmark_function>& benchmarks();
+
+    // Instances of this class register a benchmark during static
+    // initialisation
+    class registration
+    {
+    public:
+      registration(const std::string& name_, benchmark_function f_);
+    };
+
+    // The median of the measurements. It throws when there is no measurement
+    double median(std::vector<double> values_);
+
+    // Runs f_ iterations_ times and returns the median of the runtimes in
+    // milliseconds
+    double median_ms(int iterations_, const std::function<void()>& f_);
+
+    // The compiler provided after --. It throws when there is no compiler
+    clang_binary clang(const arguments& args_,
+                       const boost::filesystem::path& internal_dir_);
+
+    // The part of the environment Metashell's evaluation relies on, followed
+    // by the headers to include
+    data::cpp_code environment(const arguments& args_);
+
+    void report(std::ostream& out_,
+                const std::string& benchmark_,
+                const std::string& measurement_,
+                double value_,
+                const std::string& unit_);
+  }
+}
+
+#endif
@@ -0,0 +1,96 @@
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "benchmark.hpp"
+
+#include <metashell/cpp_validator_clang.hpp>
+#include <metashell/data/config.hpp>
+#include <metashell/header_file_environment.hpp>
+#include <metashell/precompiled_header_builder.hpp>
+#include <metashell/type_shell_clang.hpp>
+
+#include <just/temp.hpp>
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+using namespace metashell;
+
+namespace
+{
+  void measure_declaration(bool fused_,
+                           const benchmark::arguments& args_,
+                           std::ostream& out_)
+  {
+    just::temp::directory tmp;
+
+    const clang_binary clang = benchmark::clang(args_, tmp.path());
+    const auto pch_builder = std::make_shared<precompiled_header_builder>(
+        clang, data::config().max_pch_cache_size, nullptr);
+    type_shell_clang type_shell(
+        tmp.path(), "env.hpp", clang, false, pch_builder, nullptr);
+    cpp_validator_clang validator(
+        tmp.path(), "env.hpp", clang, pch_builder, nullptr);
+
+    data::shell_config cfg;
+    cfg.use_precompiled_headers = true;
+    header_file_environment env(&type_shell, cfg, tmp.path(), "env.hpp");
+    env.append(benchmark::environment(args_));
+    type_shell.wait_for_precompiled_header();
+
+    const data::config config;
+    int n = 0;
+    const double ms = benchmark::median_ms(args_.iterations, [&] {
+      const data::cpp_code decl("typedef int metashell_benchmark_" +
+                                std::to_string(n++) + ";");
+
+      data::result r;
+      if (fused_)
+      {
+        r = validator.validate_and_append(decl, config, env, true);
+      }
+      else
+      {
+        // Validation and precompilation before they were fused
+        r = validator.validate_code(decl + "\n", config, env, true);
+        if (r.successful)
+        {
+          env.append(decl);
+        }
+      }
+      type_shell.wait_for_precompiled_header();
+
+      if (!r.successful)
+      {
+        throw std::runtime_error("Declaration rejected: " + r.error);
+      }
+    });
+
+    benchmark::report(out_, "declaration",
+                      fused_ ? "validation building the PCH" :
+                               "validation and PCH separately",
+                      ms, "ms");
+  }
+
+  void declaration(const benchmark::arguments& args_, std::ostream& out_)
+  {
+    measure_declaration(false, args_, out_);
+    measure_declaration(true, args_, out_);
+  }
+
+  benchmark::registration r("declaration", declaration);
+}
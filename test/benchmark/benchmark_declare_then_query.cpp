@@ -0,0 +1,108 @@
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "benchmark.hpp"
+
+#include <metashell/data/config.hpp>
+#include <metashell/data/shell_config.hpp>
+#include <metashell/header_file_environment.hpp>
+#include <metashell/type_shell_clang.hpp>
+
+#include <just/temp.hpp>
+
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+
+using namespace metashell;
+
+namespace
+{
+  double ms_since(std::chrono::steady_clock::time_point start_)
+  {
+    return std::chrono::duration<double, std::milli>(
+               std::chrono::steady_clock::now() - start_)
+        .count();
+  }
+
+  // Declares a new type and queries it right after that. When
+  // wait_for_pch_ is set, the query is evaluated after the precompiled
+  // header has been updated.
+  void measure_declare_then_query(bool wait_for_pch_,
+                                  const benchmark::arguments& args_,
+                                  std::ostream& out_)
+  {
+    just::temp::directory tmp;
+
+    const clang_binary clang = benchmark::clang(args_, tmp.path());
+    type_shell_clang type_shell(
+        tmp.path(), "env.hpp", clang, true,
+        std::make_shared<precompiled_header_builder>(
+            clang, data::config().max_pch_cache_size, nullptr),
+        nullptr);
+
+    data::shell_config cfg;
+    cfg.use_precompiled_headers = true;
+    header_file_environment env(&type_shell, cfg, tmp.path(), "env.hpp");
+    env.append(benchmark::environment(args_));
+    type_shell.wait_for_precompiled_header();
+
+    std::vector<double> declare;
+    std::vector<double> query;
+    for (int i = 0; i != args_.iterations; ++i)
+    {
+      const std::string name = "t" + std::to_string(i);
+
+      const auto start = std::chrono::steady_clock::now();
+      env.append(
+          data::cpp_code("typedef " + args_.expression + " " + name + ";"));
+      if (wait_for_pch_)
+      {
+        type_shell.wait_for_precompiled_header();
+      }
+      declare.push_back(ms_since(start));
+
+      const auto query_start = std::chrono::steady_clock::now();
+      const data::result r =
+          type_shell.eval(env, data::cpp_code(name), true);
+      query.push_back(ms_since(query_start));
+
+      if (!r.successful)
+      {
+        throw std::runtime_error("Evaluation failed: " + r.error);
+      }
+    }
+    type_shell.wait_for_precompiled_header();
+
+    const std::string mode =
+        wait_for_pch_ ? "waiting for PCH" : "PCH in background";
+    benchmark::report(out_, "declare_then_query", "declaration, " + mode,
+                      benchmark::median(declare), "ms");
+    benchmark::report(out_, "declare_then_query", "query, " + mode,
+                      benchmark::median(query), "ms");
+  }
+
+  void declare_then_query(const benchmark::arguments& args_,
+                          std::ostream& out_)
+  {
+    for (bool wait_for_pch : {true, false})
+    {
+      measure_declare_then_query(wait_for_pch, args_, out_);
+    }
+  }
+
+  benchmark::registration r("declare_then_query", declare_then_query);
+}
@@ -0,0 +1,92 @@
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "benchmark.hpp"
+
+#include <metashell/data/config.hpp>
+#include <metashell/data/shell_config.hpp>
+#include <metashell/header_file_environment.hpp>
+#include <metashell/precompiled_header_builder.hpp>
+#include <metashell/type_shell_clang.hpp>
+
+#include <just/temp.hpp>
+
+#include <memory>
+
+using namespace metashell;
+
+namespace
+{
+  // Switches between two environments the way popping the environment stack
+  // does: by building a new environment with the content of an earlier one.
+  // A new builder does not know the precompiled headers built earlier.
+  void measure_environment_switch(bool keep_pchs_,
+                                  const benchmark::arguments& args_,
+                                  std::ostream& out_)
+  {
+    just::temp::directory tmp;
+
+    const clang_binary clang = benchmark::clang(args_, tmp.path());
+    const auto new_type_shell = [&clang, &tmp] {
+      return std::make_shared<type_shell_clang>(
+          tmp.path(), "env.hpp", clang, true,
+          std::make_shared<precompiled_header_builder>(
+              clang, data::config().max_pch_cache_size, nullptr),
+          nullptr);
+    };
+
+    data::shell_config cfg;
+    cfg.use_precompiled_headers = true;
+
+    const data::cpp_code env1 = benchmark::environment(args_);
+    const data::cpp_code env2 = env1 + "typedef int metashell_benchmark;\n";
+
+    std::shared_ptr<type_shell_clang> type_shell = new_type_shell();
+    for (const data::cpp_code& content : {env1, env2})
+    {
+      header_file_environment env(
+          type_shell.get(), cfg, tmp.path(), "env.hpp");
+      env.append(content);
+      type_shell->wait_for_precompiled_header();
+    }
+
+    int n = 0;
+    const double ms = benchmark::median_ms(args_.iterations, [&] {
+      if (!keep_pchs_)
+      {
+        type_shell = new_type_shell();
+      }
+      header_file_environment env(
+          type_shell.get(), cfg, tmp.path(), "env.hpp");
+      env.append(n++ % 2 == 0 ? env1 : env2);
+      type_shell->wait_for_precompiled_header();
+    });
+
+    benchmark::report(out_, "environment_switch",
+                      keep_pchs_ ? "keeping the precompiled headers" :
+                                   "rebuilding the precompiled header",
+                      ms, "ms");
+  }
+
+  void environment_switch(const benchmark::arguments& args_,
+                          std::ostream& out_)
+  {
+    measure_environment_switch(false, args_, out_);
+    measure_environment_switch(true, args_, out_);
+  }
+
+  benchmark::registration r("environment_switch", environment_switch);
+}
@@ -0,0 +1,82 @@
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "benchmark.hpp"
+
+#include <metashell/data/config.hpp>
+#include <metashell/data/shell_config.hpp>
+#include <metashell/header_file_environment.hpp>
+#include <metashell/type_shell_clang.hpp>
+
+#include <just/temp.hpp>
+
+#include <memory>
+#include <stdexcept>
+
+using namespace metashell;
+
+namespace
+{
+  void measure_evaluation(bool single_pass_,
+                          bool use_precompiled_headers_,
+                          const benchmark::arguments& args_,
+                          std::ostream& out_)
+  {
+    just::temp::directory tmp;
+
+    const clang_binary clang = benchmark::clang(args_, tmp.path());
+    type_shell_clang type_shell(
+        tmp.path(), "env.hpp", clang, single_pass_,
+        std::make_shared<precompiled_header_builder>(
+            clang, data::config().max_pch_cache_size, nullptr),
+        nullptr);
+
+    data::shell_config cfg;
+    cfg.use_precompiled_headers = use_precompiled_headers_;
+    header_file_environment env(&type_shell, cfg, tmp.path(), "env.hpp");
+    env.append(benchmark::environment(args_));
+    type_shell.wait_for_precompiled_header();
+
+    data::result last;
+    const double ms = benchmark::median_ms(args_.iterations, [&] {
+      last = type_shell.eval(
+          env, data::cpp_code(args_.expression), use_precompiled_headers_);
+    });
+
+    if (!last.successful)
+    {
+      throw std::runtime_error("Evaluation failed: " + last.error);
+    }
+
+    benchmark::report(out_, "evaluation",
+                      std::string(single_pass_ ? "single pass" : "two passes") +
+                          (use_precompiled_headers_ ? " with PCH" : ""),
+                      ms, "ms");
+  }
+
+  void evaluation(const benchmark::arguments& args_, std::ostream& out_)
+  {
+    for (bool use_precompiled_headers : {false, true})
+    {
+      for (bool single_pass : {false, true})
+      {
+        measure_evaluation(single_pass, use_precompiled_headers, args_, out_);
+      }
+    }
+  }
+
+  benchmark::registration r("evaluation", evaluation);
+}
@@ -0,0 +1,123 @@
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "benchmark.hpp"
+
+#include <metashell/process/execution.hpp>
+#include <metashell/process/run.hpp>
+
+#include <boost/thread.hpp>
+
+#include <just/temp.hpp>
+
+#include <array>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+using namespace metashell;
+
+namespace
+{
+#ifndef _WIN32
+  // The way the output was collected before using poll: a thread per
+  // stream reading through a small buffer into a stringstream
+  void thread_based_read_all(process::input_file& in_, std::string& out_)
+  {
+    std::ostringstream s;
+    std::array<char, 1024> buff;
+    while (!in_.eof())
+    {
+      const auto len = in_.read(buff);
+      if (len > 0)
+      {
+        s.write(buff.data(), len);
+      }
+    }
+    out_ = s.str();
+  }
+
+  data::process_output thread_based_run(const std::string& binary_,
+                                        const std::vector<std::string>& args_)
+  {
+    process::execution child(binary_, args_);
+    child.standard_input().close();
+
+    data::process_output result{data::exit_code_t(0), "", ""};
+    boost::thread reader([&child, &result] {
+      thread_based_read_all(child.standard_error(), result.standard_error);
+    });
+    thread_based_read_all(child.standard_output(), result.standard_output);
+    reader.join();
+
+    result.exit_code = child.wait();
+    return result;
+  }
+
+  void output_collection(const benchmark::arguments& args_, std::ostream& out_)
+  {
+    just::temp::directory tmp;
+    const std::string file = tmp.path() + "/output.txt";
+
+    for (int mb : {1, 16, 64})
+    {
+      {
+        // Looks like a preprocessed file or an AST dump
+        const std::string line =
+            "|-CXXRecordDecl 0x1234567 <line:1:1, col:8> col:8 struct foo\n";
+        std::ofstream f(file);
+        for (std::size_t written = 0; written < std::size_t(mb) * 1024 * 1024;
+             written += line.size())
+        {
+          f << line;
+        }
+      }
+
+      // The output is written to both stdout and stderr
+      const std::vector<std::string> args{
+          "-c", "cat \"$0\" & cat \"$0\" >&2; wait", file};
+
+      std::size_t size = 0;
+      const auto throughput = [&args_, &size](
+          const std::function<data::process_output()>& run_) {
+        const double ms = benchmark::median_ms(args_.iterations, [&] {
+          const data::process_output o = run_();
+          size = o.standard_output.size() + o.standard_error.size();
+        });
+        if (size == 0)
+        {
+          throw std::runtime_error("No output collected");
+        }
+        return (double(size) / (1024 * 1024)) / (ms / 1000);
+      };
+
+      const std::string measurement = std::to_string(mb) + " MB x 2";
+      benchmark::report(
+          out_, "output_collection", "threads " + measurement,
+          throughput([&args] { return thread_based_run("/bin/sh", args); }),
+          "MB/s");
+      benchmark::report(
+          out_, "output_collection", "poll " + measurement,
+          throughput([&args] { return process::run("/bin/sh", args, ""); }),
+          "MB/s");
+    }
+  }
+
+  benchmark::registration r("output_collection", output_collection);
+#endif
+}
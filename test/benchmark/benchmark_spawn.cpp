@@ -0,0 +1,85 @@
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "benchmark.hpp"
+
+#include <metashell/process/run.hpp>
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+using namespace metashell;
+
+namespace
+{
+#ifndef _WIN32
+  const char true_binary[] = "/bin/true";
+
+  // The way processes were started before using vfork
+  void fork_and_exec()
+  {
+    const pid_t pid = fork();
+    if (pid == -1)
+    {
+      throw std::runtime_error("Failed to fork");
+    }
+    else if (pid == 0)
+    {
+      execl(true_binary, true_binary, static_cast<char*>(nullptr));
+      _exit(1);
+    }
+    waitpid(pid, nullptr, 0);
+  }
+
+  void spawn(const benchmark::arguments& args_, std::ostream& out_)
+  {
+    // Simulates Metashell growing (eg. with a large debugger history)
+    std::vector<std::vector<char>> memory;
+    int allocated_mb = 0;
+
+    for (int mb : {0, 64, 256, 1024})
+    {
+      memory.emplace_back(std::size_t(mb - allocated_mb) * 1024 * 1024);
+      // Touching every page to make them resident
+      std::memset(memory.back().data(), 1, memory.back().size());
+      allocated_mb = mb;
+
+      const std::string rss = "+" + std::to_string(mb) + " MB";
+
+      benchmark::report(
+          out_, "spawn", "fork " + rss,
+          benchmark::median_ms(args_.iterations, fork_and_exec), "ms");
+      benchmark::report(out_, "spawn", "process::run " + rss,
+                        benchmark::median_ms(args_.iterations,
+                                             [] {
+                                               process::run(
+                                                   true_binary, {}, "");
+                                             }),
+                        "ms");
+    }
+  }
+
+  benchmark::registration r("spawn", spawn);
+#endif
+}
@@ -0,0 +1,119 @@
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "benchmark.hpp"
+
+#include <metashell/available_engines.hpp>
+#include <metashell/data/config.hpp>
+#include <metashell/default_environment_detector.hpp>
+#include <metashell/make_unique.hpp>
+#include <metashell/null_displayer.hpp>
+#include <metashell/shell.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <just/temp.hpp>
+
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace metashell;
+
+namespace
+{
+  // The engines getting the compiler provided after -- as their first
+  // argument. The other engines are measured without arguments.
+  const std::set<std::string> compiler_engines{"clang", "gcc", "msvc",
+                                              "templight"};
+
+  // Measures the time it takes to get from the start of the shell to the first
+  // prompt. The engine and the environment are built by the first command
+  // needing them, which is measured separately. The precompiled headers are
+  // disabled, since they are built in the background anyway.
+  void measure_startup(const std::string& engine_,
+                       const engine_entry& entry_,
+                       const benchmark::arguments& args_,
+                       std::ostream& out_)
+  {
+    just::temp::directory tmp;
+
+    data::shell_config scfg;
+    scfg.engine = engine_;
+    scfg.use_precompiled_headers = false;
+    if (compiler_engines.count(engine_))
+    {
+      scfg.engine_args = args_.engine_args;
+    }
+
+    data::config cfg;
+    cfg.push_back(scfg);
+
+    default_environment_detector det("metashell");
+    null_displayer displayer;
+
+    int n = 0;
+    std::vector<std::unique_ptr<shell>> shells;
+    const auto start_shell = [&]() -> shell& {
+      const boost::filesystem::path dir =
+          boost::filesystem::path(tmp.path()) / std::to_string(n++);
+      create_directories(dir / "shell");
+      create_directories(dir / "tmp");
+
+      shells.push_back(make_unique<shell>(
+          cfg, dir / "shell", "metashell_environment.hpp", dir / "mdb",
+          [&entry_, &det, &displayer, dir](const data::config& config_) {
+            return entry_.build(config_, dir / "shell", dir / "tmp",
+                                "metashell_environment.hpp", det, displayer,
+                                nullptr);
+          }));
+      shells.back()->prompt();
+      return *shells.back();
+    };
+
+    try
+    {
+      start_shell().engine();
+    }
+    catch (const std::exception& e_)
+    {
+      out_ << "startup\t" << engine_ << ": engine not available ("
+           << e_.what() << ")" << std::endl;
+      return;
+    }
+
+    benchmark::report(out_, "startup", engine_ + ": first prompt",
+                      benchmark::median_ms(args_.iterations, start_shell),
+                      "ms");
+
+    benchmark::report(
+        out_, "startup", engine_ + ": first prompt and first use of the engine",
+        benchmark::median_ms(
+            args_.iterations, [&start_shell] { start_shell().engine(); }),
+        "ms");
+  }
+
+  void startup(const benchmark::arguments& args_, std::ostream& out_)
+  {
+    for (const auto& engine : available_engines())
+    {
+      measure_startup(engine.first, engine.second, args_, out_);
+    }
+  }
+
+  benchmark::registration r("startup", startup);
+}
@@ -0,0 +1,157 @@
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "benchmark.hpp"
+
+#include <metashell/templight_dump_reader.hpp>
+#include <metashell/yaml_trace.hpp>
+
+#include <yaml-cpp/yaml.h>
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace metashell;
+
+namespace
+{
+  const int template_names = 1000;
+  const int file_names = 100;
+
+  // yaml-cpp needs much more time than the other readers. The dump has fewer
+  // entries than the binary trace of the templight_trace benchmark.
+  const int entries_per_trace_entry = 10;
+
+  const char* kinds[] = {"TemplateInstantiation",
+                         "DefaultTemplateArgumentInstantiation",
+                         "DefaultFunctionArgumentInstantiation",
+                         "ExplicitTemplateArgumentSubstitution",
+                         "DeducedTemplateArgumentSubstitution",
+                         "PriorTemplateArgumentSubstitution",
+                         "DefaultTemplateArgumentChecking",
+                         "ExceptionSpecInstantiation",
+                         "DeclaringSpecialMember",
+                         "DefiningSynthesizedFunction",
+                         "Memoization"};
+
+  // The -templight-dump output of Clang with entries_ template
+  // instantiations
+  std::string synthetic_dump(int entries_)
+  {
+    std::ostringstream s;
+    for (int i = 0; i != entries_; ++i)
+    {
+      const std::string fields =
+          "name:            'boost::hana::detail::type_impl<ns::type" +
+          std::to_string(i % template_names) +
+          ">::_'\n"
+          "kind:            " +
+          kinds[i % 11] + "\n";
+      const std::string locations =
+          "orig:            '/usr/include/boost/hana/detail/file" +
+          std::to_string(i % file_names) + ".hpp:" +
+          std::to_string(i % 1000 + 1) +
+          ":3'\n"
+          "poi:             '<stdin>:2:1'\n";
+
+      s << "---\n" << fields << "event:           Begin\n" << locations;
+      s << "---\n" << fields << "event:           End\n" << locations;
+    }
+    return s.str();
+  }
+
+  void check_entries(int expected_, int found_)
+  {
+    if (expected_ != found_)
+    {
+      throw std::runtime_error("Found " + std::to_string(found_) +
+                               " entries instead of " +
+                               std::to_string(expected_));
+    }
+  }
+
+  // The way the dump was processed before templight_dump_reader
+  int yaml_cpp_events(const std::string& dump_)
+  {
+    int events = 0;
+    for (const YAML::Node& node : YAML::LoadAll(dump_))
+    {
+      if (node["event"].as<std::string>() == "Begin")
+      {
+        template_begin(
+            data::event_kind::template_instantiation,
+            data::interned_string(node["name"].as<std::string>()),
+            data::file_location::parse(node["poi"].as<std::string>()),
+            data::file_location::parse(node["orig"].as<std::string>()), 0);
+      }
+      ++events;
+    }
+    return events;
+  }
+
+  void templight_dump(const benchmark::arguments& args_, std::ostream& out_)
+  {
+    const int entries = args_.trace_entries / entries_per_trace_entry;
+    const std::string dump = synthetic_dump(entries);
+
+    benchmark::report(out_, "templight_dump", "dump size",
+                      dump.size() / (1024.0 * 1024.0), "MB");
+
+    benchmark::report(out_, "templight_dump", "yaml-cpp events",
+                      benchmark::median_ms(
+                          args_.iterations,
+                          [&] {
+                            check_entries(2 * entries, yaml_cpp_events(dump));
+                          }),
+                      "ms");
+
+    benchmark::report(
+        out_, "templight_dump", "templight_dump_reader",
+        benchmark::median_ms(
+            args_.iterations,
+            [&] {
+              templight_dump_reader r(dump.data(), dump.data() + dump.size());
+              int found = 0;
+              while (r.next())
+              {
+                ++found;
+              }
+              check_entries(2 * entries, found);
+            }),
+        "ms");
+
+    benchmark::report(
+        out_, "templight_dump", "yaml_trace events",
+        benchmark::median_ms(
+            args_.iterations,
+            [&] {
+              yaml_trace t(dump, data::type("int"), data::cpp_code("int"),
+                           data::metaprogram_mode::normal);
+              int events = 0;
+              while (t.next())
+              {
+                ++events;
+              }
+              // The evaluation result is the last event
+              check_entries(2 * entries + 1, events);
+            }),
+        "ms");
+  }
+
+  benchmark::registration r("templight_dump", templight_dump);
+}
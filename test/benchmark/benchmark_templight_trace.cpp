@@ -0,0 +1,286 @@
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "benchmark.hpp"
+
+#include <metashell/mapped_file.hpp>
+#include <metashell/protobuf_reader.hpp>
+#include <metashell/protobuf_trace.hpp>
+
+#include <templight/ProtobufReader.h>
+#include <templight/ThinProtobuf.h>
+
+#include <just/temp.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+using namespace metashell;
+
+namespace
+{
+  const int template_names = 1000;
+  const int file_names = 100;
+
+  // Calls f_ with the chunks of a trace containing entries_ template
+  // instantiations. The names are stored in the dictionary of the trace.
+  void for_each_chunk(int entries_,
+                      const std::function<void(const std::string&)>& f_)
+  {
+    std::ostringstream s;
+    const auto chunk = [&s, &f_](unsigned int tag_, const std::string& msg_) {
+      s.str("");
+      thin_protobuf::saveString(s, tag_, msg_);
+      f_(s.str());
+    };
+
+    std::ostringstream msg;
+    thin_protobuf::saveVarInt(msg, 1, 1);
+    thin_protobuf::saveString(msg, 2, "synthetic.cpp");
+    chunk(1, msg.str());
+
+    for (int i = 0; i != template_names; ++i)
+    {
+      msg.str("");
+      thin_protobuf::saveString(
+          msg, 1, "boost::hana::detail::type_impl<ns::type" +
+                      std::to_string(i) + ">::_");
+      chunk(3, msg.str());
+    }
+
+    std::ostringstream location;
+    std::ostringstream entry;
+    for (int i = 0; i != entries_; ++i)
+    {
+      location.str("");
+      if (i < file_names)
+      {
+        thin_protobuf::saveString(location, 1,
+                                  "/usr/include/boost/hana/detail/file" +
+                                      std::to_string(i) + ".hpp");
+      }
+      thin_protobuf::saveVarInt(location, 2, i % file_names);
+      thin_protobuf::saveVarInt(location, 3, i % 1000 + 1);
+      thin_protobuf::saveVarInt(location, 4, 3);
+
+      msg.str("");
+      thin_protobuf::saveVarInt(msg, 3, i % template_names);
+
+      entry.str("");
+      thin_protobuf::saveVarInt(entry, 1, i % 11);
+      thin_protobuf::saveString(entry, 2, msg.str());
+      thin_protobuf::saveString(entry, 3, location.str());
+      thin_protobuf::saveDouble(entry, 4, i * 1e-6);
+      thin_protobuf::saveVarInt(entry, 5, 1024 * 1024);
+      thin_protobuf::saveString(entry, 6, location.str());
+
+      msg.str("");
+      thin_protobuf::saveString(msg, 1, entry.str());
+      chunk(2, msg.str());
+
+      entry.str("");
+      thin_protobuf::saveDouble(entry, 1, i * 1e-6 + 5e-7);
+      thin_protobuf::saveVarInt(entry, 2, 1024 * 1024);
+
+      msg.str("");
+      thin_protobuf::saveString(msg, 2, entry.str());
+      chunk(2, msg.str());
+    }
+  }
+
+  void write_trace(int entries_, const boost::filesystem::path& path_)
+  {
+    std::uint64_t size = 0;
+    for_each_chunk(entries_, [&size](const std::string& chunk_) {
+      size += chunk_.size();
+    });
+
+    std::ofstream f(path_.string(), std::ios_base::out | std::ios_base::binary);
+    thin_protobuf::saveVarInt(f, (1 << 3) | 2);
+    thin_protobuf::saveVarInt(f, size);
+    for_each_chunk(entries_, [&f](const std::string& chunk_) { f << chunk_; });
+
+    if (!f)
+    {
+      throw std::runtime_error("Error writing " + path_.string());
+    }
+  }
+
+  void check_entries(int expected_, int found_)
+  {
+    if (expected_ != found_)
+    {
+      throw std::runtime_error("Found " + std::to_string(found_) +
+                               " entries instead of " +
+                               std::to_string(expected_));
+    }
+  }
+
+  void templight_trace(const benchmark::arguments& args_, std::ostream& out_)
+  {
+    just::temp::directory tmp;
+    const boost::filesystem::path trace = tmp.path() + "/trace.pbf";
+    write_trace(args_.trace_entries, trace);
+
+    benchmark::report(out_, "templight_trace", "trace size",
+                      boost::filesystem::file_size(trace) / (1024.0 * 1024.0),
+                      "MB");
+
+    benchmark::report(
+        out_, "templight_trace", "templight::ProtobufReader on std::ifstream",
+        benchmark::median_ms(args_.iterations,
+                             [&] {
+                               std::ifstream f(trace.string(),
+                                               std::ios_base::in |
+                                                   std::ios_base::binary);
+                               templight::ProtobufReader r;
+                               int entries = 0;
+                               for (auto c = r.startOnBuffer(f);
+                                    c != templight::ProtobufReader::EndOfFile;
+                                    c = r.next())
+                               {
+                                 if (c == templight::ProtobufReader::BeginEntry)
+                                 {
+                                   ++entries;
+                                 }
+                               }
+                               check_entries(args_.trace_entries, entries);
+                             }),
+        "ms");
+
+    benchmark::report(
+        out_, "templight_trace", "protobuf_reader on mapped_file",
+        benchmark::median_ms(
+            args_.iterations,
+            [&] {
+              const mapped_file f(trace);
+              protobuf_reader r(f.begin(), f.end());
+              int entries = 0;
+              for (auto c = r.next(); c != protobuf_reader::chunk::end_of_file;
+                   c = r.next())
+              {
+                if (c == protobuf_reader::chunk::begin_entry)
+                {
+                  ++entries;
+                }
+              }
+              check_entries(args_.trace_entries, entries);
+            }),
+        "ms");
+
+    benchmark::report(
+        out_, "templight_trace", "protobuf_trace events",
+        benchmark::median_ms(
+            args_.iterations,
+            [&] {
+              protobuf_trace t(trace, data::type("int"), data::cpp_code("int"),
+                               data::metaprogram_mode::normal);
+              int events = 0;
+              while (t.next())
+              {
+                ++events;
+              }
+              // The begin and end of the entries and the evaluation result
+              check_entries(2 * args_.trace_entries + 1, events);
+            }),
+        "ms");
+  }
+
+  benchmark::registration r("templight_trace", templight_trace);
+
+#ifdef __GLIBC__
+  // Keeping every event of a full mode trace in memory
+  const int max_entries_in_memory = 1000000;
+
+  // The large blocks (eg. the buffer of the event vector) are mapped
+  // separately
+  double heap_usage_mb()
+  {
+    const struct mallinfo2 info = mallinfo2();
+    return (info.uordblks + info.hblkhd) / (1024.0 * 1024.0);
+  }
+
+  data::file_location copy_of(const data::file_location& location_)
+  {
+    return data::file_location(data::interned_string(location_.name.value()),
+                               location_.row, location_.column);
+  }
+
+  // The memory used by the events of the trace. When copy_names_ is set,
+  // every template event gets its own copy of its name and file names, like
+  // the events did before the names of a trace were shared by them.
+  double events_mb(const boost::filesystem::path& trace_,
+                   int entries_,
+                   bool copy_names_)
+  {
+    const double before = heap_usage_mb();
+
+    std::vector<data::event_data> events;
+    // The begin and end of the entries and the evaluation result
+    events.reserve(2 * entries_ + 1);
+    {
+      protobuf_trace t(trace_, data::type("int"), data::cpp_code("int"),
+                       data::metaprogram_mode::full);
+      while (boost::optional<data::event_data> e = t.next())
+      {
+        const data::interned_string name = full_name(*e);
+        if (copy_names_ && !name.empty())
+        {
+          *e = template_begin(kind_of(*e), data::interned_string(name.value()),
+                              copy_of(*point_of_event(*e)),
+                              copy_of(*source_location(*e)), *timestamp(*e));
+        }
+        events.push_back(std::move(*e));
+      }
+    }
+    check_entries(2 * entries_ + 1, static_cast<int>(events.size()));
+
+    return heap_usage_mb() - before;
+  }
+
+  void trace_memory(const benchmark::arguments& args_, std::ostream& out_)
+  {
+    const int entries = std::min(args_.trace_entries, max_entries_in_memory);
+
+    just::temp::directory tmp;
+    const boost::filesystem::path trace = tmp.path() + "/trace.pbf";
+    write_trace(entries, trace);
+
+    const std::string of_entries =
+        " of " + std::to_string(entries) + " entries";
+
+    benchmark::report(out_, "trace_memory",
+                      "events with copied names" + of_entries,
+                      events_mb(trace, entries, true), "MB");
+    benchmark::report(out_, "trace_memory",
+                      "events with shared names" + of_entries,
+                      events_mb(trace, entries, false), "MB");
+  }
+
+  benchmark::registration r_memory("trace_memory", trace_memory);
+#endif
+}
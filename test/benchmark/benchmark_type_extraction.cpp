@@ -0,0 +1,119 @@
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "benchmark.hpp"
+
+#include <metashell/exception.hpp>
+#include <metashell/metashell.hpp>
+
+#include <metashell/boost/regex.hpp>
+
+#include <boost/algorithm/string/trim.hpp>
+
+#include <just/temp.hpp>
+
+#include <stdexcept>
+
+using namespace metashell;
+
+namespace
+{
+  // The type extraction used before the AST dump was filtered
+  std::string regex_based_type_extraction(const std::string& ast)
+  {
+    std::size_t end_index = std::string::npos;
+    std::size_t start_index = ast.find_last_of('\n');
+
+    boost::regex reg(
+        ".*':'(?:struct )?metashell::impl::wrap<?(.*)>' "
+        "'void \\((?:void)?\\)"
+        "(?: __attribute__\\(\\(thiscall\\)\\)|(?:))(?: noexcept|(?:))'.*");
+
+    std::string line;
+    while (true)
+    {
+      end_index = start_index;
+      start_index = ast.find_last_of('\n', end_index - 1);
+
+      if (start_index == std::string::npos || end_index == std::string::npos)
+      {
+        throw exception("No suitable ast line in dump");
+      }
+
+      line = ast.substr(start_index + 1, end_index - start_index - 1);
+
+      boost::smatch match;
+      if (boost::regex_match(line, match, reg))
+      {
+        return repair_type_string(boost::trim_copy(std::string(match[1])));
+      }
+    }
+  }
+
+  std::string dump_ast(const benchmark::arguments& args_, bool filter_)
+  {
+    just::temp::directory tmp;
+
+    std::vector<std::string> clang_args{"-Xclang", "-ast-dump"};
+    if (filter_)
+    {
+      clang_args.insert(clang_args.end(), {"-Xclang", "-ast-dump-filter",
+                                           "-Xclang", "__metashell_v"});
+    }
+    clang_args.insert(clang_args.end(), {"-c", "-x", "c++"});
+
+    const data::process_output o = run_clang(
+        benchmark::clang(args_, tmp.path()), clang_args,
+        benchmark::environment(args_) + "::metashell::impl::wrap< " +
+            args_.expression + " > __metashell_v;\n");
+
+    if (o.exit_code != data::exit_code_t(0))
+    {
+      throw std::runtime_error("Evaluation failed: " + o.standard_error);
+    }
+    return o.standard_output;
+  }
+
+  void type_extraction(const benchmark::arguments& args_, std::ostream& out_)
+  {
+    const std::string full = dump_ast(args_, false);
+    const std::string filtered = dump_ast(args_, true);
+
+    benchmark::report(out_, "type_extraction", "full AST dump",
+                      static_cast<double>(full.size()), "bytes");
+    benchmark::report(out_, "type_extraction", "filtered AST dump",
+                      static_cast<double>(filtered.size()), "bytes");
+
+    benchmark::report(
+        out_, "type_extraction", "regex on full AST dump",
+        benchmark::median_ms(
+            args_.iterations, [&full] { regex_based_type_extraction(full); }),
+        "ms");
+    benchmark::report(
+        out_, "type_extraction", "parser on full AST dump",
+        benchmark::median_ms(
+            args_.iterations, [&full] { get_type_from_ast_string(full); }),
+        "ms");
+    benchmark::report(out_, "type_extraction", "parser on filtered AST dump",
+                      benchmark::median_ms(args_.iterations,
+                                           [&filtered] {
+                                             get_type_from_ast_string(filtered);
+                                           }),
+                      "ms");
+  }
+
+  benchmark::registration r("type_extraction", type_extraction);
+}
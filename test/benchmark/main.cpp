@@ -0,0 +1,109 @@
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "benchmark.hpp"
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace metashell;
+
+namespace
+{
+  void show_usage(const std::string& app_name_)
+  {
+    std::cerr << "Usage:\n"
+              << "  " << app_name_
+              << " [--iterations <n>] [--trace_entries <n>]"
+                 " [--include <header>]..."
+                 " [--expression <type>] [<benchmark>...]"
+                 " [-- <Clang binary> <Clang args>]\n"
+              << "\n"
+              << "Benchmarks:\n";
+    for (const auto& b : benchmark::benchmarks())
+    {
+      std::cerr << "  " << b.first << "\n";
+    }
+  }
+}
+
+int main(int argc_, const char* argv_[])
+{
+  benchmark::arguments args;
+  std::vector<std::string> to_run;
+
+  try
+  {
+    for (int i = 1; i < argc_; ++i)
+    {
+      const std::string arg = argv_[i];
+      const bool has_value = i + 1 < argc_;
+
+      if (arg == "--")
+      {
+        args.engine_args.assign(argv_ + i + 1, argv_ + argc_);
+        break;
+      }
+      else if (arg == "--iterations" && has_value)
+      {
+        args.iterations = std::stoi(argv_[++i]);
+      }
+      else if (arg == "--trace_entries" && has_value)
+      {
+        args.trace_entries = std::stoi(argv_[++i]);
+      }
+      else if (arg == "--include" && has_value)
+      {
+        args.includes.push_back(argv_[++i]);
+      }
+      else if (arg == "--expression" && has_value)
+      {
+        args.expression = argv_[++i];
+      }
+      else if (benchmark::benchmarks().count(arg))
+      {
+        to_run.push_back(arg);
+      }
+      else
+      {
+        throw std::runtime_error("Invalid argument: " + arg);
+      }
+    }
+
+    if (to_run.empty())
+    {
+      for (const auto& b : benchmark::benchmarks())
+      {
+        to_run.push_back(b.first);
+      }
+    }
+
+    for (const std::string& name : to_run)
+    {
+      benchmark::benchmarks()[name](args, std::cout);
+    }
+
+    return 0;
+  }
+  catch (const std::exception& e_)
+  {
+    std::cerr << "Error: " << e_.what() << "\n\n";
+    show_usage(argc_ > 0 ? argv_[0] : "metashell_benchmark");
+    return 1;
+  }
+}
@@ -102,6 +102,7 @@ namespace
   {
     string_,
     bool_,
+    int_,
     list_
   };
 
@@ -113,6 +114,8 @@ namespace
       return "string";
     case value_type::bool_:
       return "bool";
+    case value_type::int_:
+      return "non-negative integer";
     case value_type::list_:
       return "list of strings";
     }
@@ -125,7 +128,9 @@ namespace
     return "{\"name\":\"" + name_ +
            "\",\"engine\":\"clang\","
            "\"engine_args\":[\"arg\"],\"use_precompiled_headers\":"
-           "true,\"preprocessor_mode\":false}";
+           "true,\"preprocessor_mode\":false,"
+           "\"single_pass_evaluation\":true,\"timeout\":0,"
+           "\"cpu_time_limit\":0,\"memory_limit\":0}";
   }
 }
 
@@ -158,7 +163,10 @@ TEST(config_parsing, errors)
        {sv("name", value_type::string_), sv("engine", value_type::string_),
         sv("engine_args", value_type::list_),
         sv("use_precompiled_headers", value_type::bool_),
-        sv("preprocessor_mode", value_type::bool_)})
+        sv("preprocessor_mode", value_type::bool_),
+        sv("single_pass_evaluation", value_type::bool_),
+        sv("timeout", value_type::int_), sv("cpu_time_limit", value_type::int_),
+        sv("memory_limit", value_type::int_)})
   {
     for (auto smp : sample_value)
     {
@@ -176,6 +184,12 @@ TEST(config_parsing, errors)
   ASSERT_EQ("JSON parsing failed: Unexpected integer element: 13" + nl,
             t.error_with_configs({"{\"engine_args\":[13]}"}));
 
+  ASSERT_EQ(
+      "JSON parsing failed: -1 is not a valid value for timeout, which should "
+      "be a non-negative integer" +
+          nl,
+      t.error_with_configs({"{\"timeout\":-1}"}));
+
   ASSERT_EQ("JSON parsing failed: Unexpected double element: 13.1" + nl,
             t.error_with_configs({"{\"engine_args\":[13.1]}"}));
 
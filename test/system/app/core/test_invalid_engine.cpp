@@ -0,0 +1,59 @@
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <metashell/system_test/metashell_instance.hpp>
+#include <metashell/system_test/metashell_terminated.hpp>
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+using namespace metashell::system_test;
+
+namespace
+{
+  // Returns the standard error of Metashell when it terminates before
+  // displaying the first prompt
+  std::string error_at_startup(const std::vector<std::string>& args_)
+  {
+    try
+    {
+      metashell_instance(args_, {}, false);
+    }
+    catch (const metashell_terminated& e_)
+    {
+      return e_.standard_error();
+    }
+    return std::string();
+  }
+}
+
+TEST(invalid_engine, unknown_engine_is_reported_at_startup)
+{
+  const std::string err = error_at_startup({"--engine", "no_such_engine"});
+
+  ASSERT_EQ(0u, err.find("Error: Engine no_such_engine not found."));
+}
+
+TEST(invalid_engine, missing_compiler_is_reported_at_startup)
+{
+  const std::string err = error_at_startup(
+      {"--engine", "clang", "--", "/no/such/directory/clang++"});
+
+  ASSERT_EQ(0u, err.find("Error: The path specified as the Clang binary to "
+                         "use (/no/such/directory/clang++) does not exist."));
+}
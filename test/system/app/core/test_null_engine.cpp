@@ -96,6 +96,9 @@ TEST(null_engine, configs)
 
   ASSERT_EQ(comment({paragraph("{\"name\":\"default\",\"engine\":\"null\","
                                "\"engine_args\":[],\"use_precompiled_headers\":"
-                               "true,\"preprocessor_mode\":false}")}),
+                               "true,\"preprocessor_mode\":false,"
+                               "\"single_pass_evaluation\":true,"
+                               "\"timeout\":0,\"cpu_time_limit\":0,"
+                               "\"memory_limit\":0}")}),
             with_null_engine("#msh config show default").front());
 }
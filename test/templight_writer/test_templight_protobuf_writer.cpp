@@ -0,0 +1,191 @@
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <metashell/protobuf_reader.hpp>
+
+#include <TemplightProtobufWriter.h>
+
+#include <llvm/Support/Compression.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <string>
+
+using namespace metashell;
+
+namespace
+{
+  typedef protobuf_reader::chunk chunk;
+
+  clang::PrintableTemplightEntryBegin begin_entry(const std::string& name_)
+  {
+    clang::PrintableTemplightEntryBegin entry;
+    entry.SynthesisKind = 0;
+    entry.Name = name_;
+    entry.FileName = "foo.hpp";
+    entry.Line = 11;
+    entry.Column = 13;
+    entry.TimeStamp = 1.5;
+    entry.MemoryUsage = 0;
+    entry.TempOri_Line = 0;
+    entry.TempOri_Column = 0;
+    return entry;
+  }
+
+  clang::PrintableTemplightEntryEnd end_entry()
+  {
+    clang::PrintableTemplightEntryEnd entry;
+    entry.TimeStamp = 2.5;
+    entry.MemoryUsage = 0;
+    return entry;
+  }
+
+  // Writes a trace with one instantiation of name_
+  std::string write_trace(const std::string& name_,
+                          int compress_level_,
+                          bool stream_trace_ = false)
+  {
+    std::string result;
+    {
+      llvm::raw_string_ostream out(result);
+      clang::TemplightProtobufWriter writer(
+          out, compress_level_, stream_trace_);
+      writer.initialize("test.cpp");
+      writer.printEntry(begin_entry(name_));
+      writer.printEntry(end_entry());
+      writer.finalize();
+    }
+    return result;
+  }
+
+  // Skips the dictionary entries
+  chunk next_entry(protobuf_reader& r_)
+  {
+    chunk c = r_.next();
+    while (c == chunk::other)
+    {
+      c = r_.next();
+    }
+    return c;
+  }
+
+  void assert_trace_of(const std::string& name_, protobuf_reader& r_)
+  {
+    ASSERT_EQ(chunk::header, r_.next());
+    ASSERT_EQ("test.cpp", r_.source_name());
+
+    ASSERT_EQ(chunk::begin_entry, next_entry(r_));
+    ASSERT_EQ(name_, r_.last_begin_entry().name);
+    ASSERT_EQ(
+        "foo.hpp", r_.last_begin_entry().point_of_instantiation.file_name);
+    ASSERT_EQ(11, r_.last_begin_entry().point_of_instantiation.line);
+    ASSERT_EQ(1.5, r_.last_begin_entry().timestamp);
+
+    ASSERT_EQ(chunk::end_entry, next_entry(r_));
+    ASSERT_EQ(2.5, r_.last_end_entry().timestamp);
+
+    ASSERT_EQ(chunk::end_of_file, next_entry(r_));
+  }
+
+  void assert_trace_of(const std::string& name_, const std::string& trace_)
+  {
+    protobuf_reader r(trace_.data(), trace_.data() + trace_.size());
+    assert_trace_of(name_, r);
+  }
+
+  // Reads the trace the way it is read from a pipe: a few bytes at a time
+  void assert_stream_of(const std::string& name_, const std::string& trace_)
+  {
+    std::size_t pos = 0;
+    protobuf_reader r([&trace_, &pos](char* buff_, std::size_t size_) {
+      const std::size_t len =
+          std::min({size_, std::size_t(3), trace_.size() - pos});
+      std::copy_n(trace_.begin() + pos, len, buff_);
+      pos += len;
+      return len;
+    });
+    assert_trace_of(name_, r);
+  }
+
+  // A name that is easy to compress
+  const std::string long_name = "foo<" + std::string(1000, 'x') + ">";
+}
+
+TEST(templight_protobuf_writer, names_in_dictionary)
+{
+  assert_trace_of("foo<int>", write_trace("foo<int>", 2));
+}
+
+TEST(templight_protobuf_writer, plain_names)
+{
+  const std::string trace = write_trace(long_name, 0);
+
+  ASSERT_NE(std::string::npos, trace.find(long_name));
+  assert_trace_of(long_name, trace);
+}
+
+TEST(templight_protobuf_writer, compressed_names)
+{
+  const std::string trace = write_trace(long_name, 1);
+
+  if (llvm::zlib::isAvailable())
+  {
+    // The name is stored in the compressed_name field (2)
+    ASSERT_EQ(std::string::npos, trace.find(long_name));
+    ASSERT_LT(trace.size(), long_name.size());
+  }
+  else
+  {
+    // The writer falls back to storing the name uncompressed
+    ASSERT_NE(std::string::npos, trace.find(long_name));
+  }
+  assert_trace_of(long_name, trace);
+}
+
+TEST(templight_protobuf_writer, streamed_trace)
+{
+  const std::string trace = write_trace("foo<int>", 2, true);
+
+  // The trace is a group (wire type 3) of field 1
+  ASSERT_EQ((1 << 3) | 3, trace.front());
+  assert_stream_of("foo<int>", trace);
+}
+
+TEST(templight_protobuf_writer, streamed_trace_with_plain_names)
+{
+  assert_stream_of(long_name, write_trace(long_name, 0, true));
+}
+
+TEST(templight_protobuf_writer, streamed_trace_read_from_a_buffer)
+{
+  assert_trace_of("foo<int>", write_trace("foo<int>", 2, true));
+}
+
+TEST(templight_protobuf_writer, streamed_entries_are_written_when_printed)
+{
+  std::string result;
+  llvm::raw_string_ostream out(result);
+  clang::TemplightProtobufWriter writer(out, 0, true);
+  writer.initialize("test.cpp");
+  writer.printEntry(begin_entry(long_name));
+
+  ASSERT_NE(std::string::npos, result.find(long_name));
+
+  writer.printEntry(end_entry());
+  writer.finalize();
+}
@@ -208,3 +208,102 @@ TEST(argument_parsing, preprocessor_mode_is_set_from_command_line)
                   .cfg.active_shell_config()
                   .preprocessor_mode);
 }
+
+TEST(argument_parsing, single_pass_evaluation_is_on_by_default)
+{
+  ASSERT_TRUE(
+      parse_config({}).cfg.active_shell_config().single_pass_evaluation);
+}
+
+TEST(argument_parsing, disabling_single_pass_evaluation)
+{
+  ASSERT_FALSE(parse_config({"--no_single_pass_evaluation"})
+                   .cfg.active_shell_config()
+                   .single_pass_evaluation);
+}
+
+TEST(argument_parsing, evaluation_results_are_not_cached_by_default)
+{
+  ASSERT_EQ("", parse_config({}).cfg.cache_dir);
+}
+
+TEST(argument_parsing, setting_cache_dir)
+{
+  ASSERT_EQ(
+      "/tmp/cache", parse_config({"--cache_dir", "/tmp/cache"}).cfg.cache_dir);
+}
+
+TEST(argument_parsing, setting_eval_cache_size)
+{
+  ASSERT_EQ(1024u * 1024u,
+            parse_config({"--eval_cache_size", "1"}).cfg.max_eval_cache_size);
+}
+
+TEST(argument_parsing, setting_pch_cache_size)
+{
+  ASSERT_EQ(2u * 1024u * 1024u,
+            parse_config({"--pch_cache_size", "2"}).cfg.max_pch_cache_size);
+}
+
+TEST(argument_parsing, setting_code_completion_timeout)
+{
+  ASSERT_EQ(
+      500,
+      parse_config({"--code_completion_timeout", "500"})
+          .cfg.code_completion_timeout);
+}
+
+TEST(argument_parsing, negative_code_completion_timeout_is_an_error)
+{
+  ASSERT_TRUE(fails_and_displays_error({"--code_completion_timeout=-1"}));
+}
+
+TEST(argument_parsing, template_names_are_not_compressed_by_default)
+{
+  ASSERT_FALSE(parse_config({}).cfg.compress_template_names);
+}
+
+TEST(argument_parsing, compressing_template_names)
+{
+  ASSERT_TRUE(
+      parse_config({"--compress_template_names"}).cfg.compress_template_names);
+}
+
+TEST(argument_parsing, templight_trace_is_not_streamed_by_default)
+{
+  ASSERT_FALSE(parse_config({}).cfg.stream_templight_trace);
+}
+
+TEST(argument_parsing, streaming_the_templight_trace)
+{
+  ASSERT_TRUE(
+      parse_config({"--stream_templight_trace"}).cfg.stream_templight_trace);
+}
+
+TEST(argument_parsing, resource_limits_are_not_set_by_default)
+{
+  const data::resource_limits limits =
+      parse_config({}).cfg.active_shell_config().limits;
+
+  ASSERT_EQ(0, limits.wall_time);
+  ASSERT_EQ(0, limits.cpu_time);
+  ASSERT_EQ(0, limits.memory);
+}
+
+TEST(argument_parsing, setting_resource_limits)
+{
+  const data::resource_limits limits =
+      parse_config({"--timeout", "10", "--cpu_time_limit", "5",
+                    "--memory_limit", "512"})
+          .cfg.active_shell_config()
+          .limits;
+
+  ASSERT_EQ(10, limits.wall_time);
+  ASSERT_EQ(5, limits.cpu_time);
+  ASSERT_EQ(512, limits.memory);
+}
+
+TEST(argument_parsing, negative_resource_limit_is_an_error)
+{
+  ASSERT_TRUE(fails_and_displays_error({"--timeout=-1"}));
+}
@@ -0,0 +1,72 @@
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <metashell/breakpoint.hpp>
+
+#include <gtest/gtest.h>
+
+using namespace metashell;
+
+namespace
+{
+  data::frame template_frame(const data::interned_string& name_)
+  {
+    return data::frame(
+        data::template_begin(data::event_kind::template_instantiation, name_,
+                             data::file_location("foo.cpp", 1, 2),
+                             data::file_location("foo.cpp", 3, 4), 0),
+        data::metaprogram_mode::normal);
+  }
+}
+
+TEST(breakpoint, frame_with_matching_name_is_matched)
+{
+  data::string_table names;
+  const breakpoint bp(1, boost::regex("fib<"));
+
+  ASSERT_TRUE(bp.match(template_frame(names.intern("fib<3>"))));
+  ASSERT_FALSE(bp.match(template_frame(names.intern("fact<3>"))));
+}
+
+TEST(breakpoint, result_of_a_name_does_not_change)
+{
+  data::string_table names;
+  const breakpoint bp(1, boost::regex("fib<"));
+
+  for (int i = 0; i != 3; ++i)
+  {
+    ASSERT_TRUE(bp.match(template_frame(names.intern("fib<3>"))));
+    ASSERT_FALSE(bp.match(template_frame(names.intern("fact<3>"))));
+  }
+}
+
+TEST(breakpoint, equal_names_of_different_traces_are_matched)
+{
+  data::string_table names1;
+  data::string_table names2;
+  const breakpoint bp(1, boost::regex("fib<"));
+
+  ASSERT_TRUE(bp.match(template_frame(names1.intern("fib<3>"))));
+  ASSERT_TRUE(bp.match(template_frame(names2.intern("fib<3>"))));
+}
+
+TEST(breakpoint, frames_without_interned_names_are_matched_by_node)
+{
+  const breakpoint bp(1, boost::regex("fib<"));
+
+  ASSERT_TRUE(bp.match(data::frame(data::type("fib<3>"))));
+  ASSERT_FALSE(bp.match(data::frame(data::type("fact<3>"))));
+}
@@ -0,0 +1,68 @@
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <metashell/clang_binary.hpp>
+
+#include <gtest/gtest.h>
+
+#include <just/temp.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <ctime>
+#include <fstream>
+#include <string>
+
+using namespace metashell;
+
+namespace
+{
+  void write(const boost::filesystem::path& path_, const std::string& s_)
+  {
+    std::ofstream(path_.string()) << s_;
+  }
+
+  std::string cache_key_of(const boost::filesystem::path& clang_,
+                           const boost::filesystem::path& internal_dir_)
+  {
+    return clang_binary(clang_, {"-I", internal_dir_.string()}, nullptr)
+        .cache_key(internal_dir_);
+  }
+}
+
+TEST(clang_binary, cache_key_does_not_depend_on_the_internal_dir)
+{
+  just::temp::directory tmp;
+  const boost::filesystem::path clang = tmp.path() + "/clang";
+  write(clang, "clang");
+
+  ASSERT_EQ(cache_key_of(clang, "/tmp/internal1"),
+            cache_key_of(clang, "/tmp/internal2"));
+}
+
+TEST(clang_binary, cache_key_changes_when_the_binary_is_replaced)
+{
+  just::temp::directory tmp;
+  const boost::filesystem::path clang = tmp.path() + "/clang";
+  write(clang, "clang");
+  boost::filesystem::last_write_time(clang, std::time(nullptr) - 10);
+  const std::string key = cache_key_of(clang, "/tmp/internal");
+
+  write(clang, "clang");
+  boost::filesystem::last_write_time(clang, std::time(nullptr));
+
+  ASSERT_NE(key, cache_key_of(clang, "/tmp/internal"));
+}
@@ -0,0 +1,222 @@
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <metashell/code_completer_clang.hpp>
+#include <metashell/exception.hpp>
+#include <metashell/header_file_environment.hpp>
+#include <metashell/in_memory_environment.hpp>
+#include <metashell/make_unique.hpp>
+
+#include <gtest/gtest.h>
+
+#include <just/temp.hpp>
+
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+
+using namespace metashell;
+
+namespace
+{
+  // Completes code using a script listing the same candidates every time
+  // instead of clang. The script takes a second when the code contains
+  // "slow" and fails when it contains "fail".
+  class completer
+  {
+  public:
+    // header_file_ uses an environment referred to by including it
+    explicit completer(std::chrono::milliseconds timeout_,
+                       bool header_file_ = false)
+      : _env(environment(header_file_)),
+        _use_precompiled_headers(header_file_),
+        _completer(
+            _tmp.path(),
+            _tmp.path(),
+            "env.hpp",
+            clang_binary("/bin/sh",
+                         {"-c",
+                          "for a; do f=\"$a\"; done; echo run >> " + log() +
+                              "; if grep -q slow \"$f\"; then sleep 1; fi; "
+                              "echo 'COMPLETION: foo : [#int#]foo'; "
+                              "echo 'COMPLETION: bar : bar'; "
+                              "echo 'COMPLETION: foobar : foobar'; "
+                              "! grep -q fail \"$f\"",
+                          "clang"},
+                         nullptr),
+            timeout_,
+            nullptr)
+    {
+      _env->append(data::cpp_code("int x;"));
+    }
+
+    std::set<std::string> operator()(const std::string& src_)
+    {
+      std::set<std::string> result;
+      _completer.code_complete(
+          *_env, src_, result, _use_precompiled_headers);
+      return result;
+    }
+
+    void append_to_env(const std::string& code_)
+    {
+      _env->append(data::cpp_code(code_));
+    }
+
+    int runs() const
+    {
+      std::ifstream f(log());
+      std::vector<std::string> lines;
+      for (std::string line; std::getline(f, line);)
+      {
+        lines.push_back(line);
+      }
+      return lines.size();
+    }
+
+  private:
+    just::temp::directory _tmp;
+    std::unique_ptr<iface::environment> _env;
+    bool _use_precompiled_headers;
+    code_completer_clang _completer;
+
+    std::string log() const { return _tmp.path() + "/runs.txt"; }
+
+    std::unique_ptr<iface::environment> environment(bool header_file_) const
+    {
+      if (header_file_)
+      {
+        data::shell_config cfg;
+        cfg.use_precompiled_headers = true;
+        return metashell::make_unique<header_file_environment>(
+            nullptr, cfg, _tmp.path(), "env.hpp");
+      }
+      else
+      {
+        return metashell::make_unique<in_memory_environment>(
+            data::cpp_code(), _tmp.path());
+      }
+    }
+  };
+}
+
+TEST(code_completer_clang, candidates_are_filtered_by_the_prefix)
+{
+  completer c(std::chrono::milliseconds(0));
+
+  ASSERT_EQ((std::set<std::string>{"o", "obar"}), c("fo"));
+  ASSERT_EQ((std::set<std::string>{"bar"}), c("foo"));
+  ASSERT_EQ((std::set<std::string>{}), c("foobar"));
+}
+
+TEST(code_completer_clang, extending_the_prefix_does_not_run_clang)
+{
+  completer c(std::chrono::milliseconds(0));
+
+  c("f");
+  c("fo");
+  c("foo");
+  c("fo");
+
+  ASSERT_EQ(1, c.runs());
+}
+
+TEST(code_completer_clang, changing_the_code_runs_clang_again)
+{
+  completer c(std::chrono::milliseconds(0));
+
+  c("f");
+  c("x + f");
+  c.append_to_env("int y;");
+  c("x + f");
+
+  ASSERT_EQ(3, c.runs());
+}
+
+TEST(code_completer_clang, changing_the_included_environment_runs_clang_again)
+{
+  completer c(std::chrono::milliseconds(0), true);
+
+  c("f");
+  c.append_to_env("struct foo {};");
+  c("f");
+
+  ASSERT_EQ(2, c.runs());
+}
+
+TEST(code_completer_clang, candidates_of_failed_runs_are_not_remembered)
+{
+  completer c(std::chrono::milliseconds(0));
+  c.append_to_env("// fail");
+
+  ASSERT_THROW(c("f"), exception);
+  ASSERT_THROW(c("fo"), exception);
+  ASSERT_EQ(2, c.runs());
+}
+
+TEST(code_completer_clang, earlier_candidates_are_not_displayed_after_timeout)
+{
+  completer c(std::chrono::milliseconds(100));
+
+  ASSERT_EQ((std::set<std::string>{"oo", "oobar"}), c("f"));
+
+  c.append_to_env("// slow");
+  const auto start = std::chrono::steady_clock::now();
+  ASSERT_EQ((std::set<std::string>{}), c("fo"));
+  ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(1));
+}
+
+TEST(code_completer_clang, candidates_of_changed_environment_are_dropped)
+{
+  completer c(std::chrono::milliseconds(100), true);
+  c.append_to_env("// slow");
+
+  // The completion finishes in the background after the change
+  c("f");
+  c.append_to_env("int y;");
+  std::this_thread::sleep_for(std::chrono::milliseconds(1500));
+
+  ASSERT_EQ((std::set<std::string>{}), c("f"));
+}
+
+TEST(code_completer_clang, timeout_without_earlier_candidates_displays_nothing)
+{
+  completer c(std::chrono::milliseconds(100));
+  c.append_to_env("// slow");
+
+  ASSERT_EQ((std::set<std::string>{}), c("f"));
+}
+
+TEST(code_completer_clang, superseded_completions_are_skipped)
+{
+  completer c(std::chrono::milliseconds(100));
+  c.append_to_env("// slow");
+
+  c("f");
+  c("x + f");
+  c("y + f");
+  std::this_thread::sleep_for(std::chrono::milliseconds(2500));
+
+  ASSERT_EQ((std::set<std::string>{"oo", "oobar"}), c("y + f"));
+  ASSERT_EQ(2, c.runs());
+}
+#endif
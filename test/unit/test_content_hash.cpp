@@ -0,0 +1,47 @@
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <metashell/content_hash.hpp>
+
+#include <gtest/gtest.h>
+
+using namespace metashell;
+
+TEST(content_hash, hash_is_32_hex_digits)
+{
+  const std::string h = content_hash().add("hello").hex();
+
+  ASSERT_EQ(32u, h.size());
+  ASSERT_EQ(std::string::npos, h.find_first_not_of("0123456789abcdef"));
+}
+
+TEST(content_hash, hash_is_deterministic)
+{
+  ASSERT_EQ(content_hash().add("foo").add(13).hex(),
+            content_hash().add("foo").add(13).hex());
+}
+
+TEST(content_hash, hash_depends_on_content)
+{
+  ASSERT_NE(content_hash().add("foo").hex(), content_hash().add("bar").hex());
+  ASSERT_NE(content_hash().hex(), content_hash().add("").hex());
+}
+
+TEST(content_hash, boundaries_of_strings_are_hashed)
+{
+  ASSERT_NE(content_hash().add("ab").add("c").hex(),
+            content_hash().add("a").add("bc").hex());
+}
@@ -0,0 +1,185 @@
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <metashell/content_hash.hpp>
+#include <metashell/eval_cache.hpp>
+#include <metashell/file_versions.hpp>
+
+#include <gtest/gtest.h>
+
+#include <just/temp.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <fstream>
+
+using namespace metashell;
+
+namespace
+{
+  const data::result int_result(true, "int", "", "");
+
+  boost::filesystem::path entry(const boost::filesystem::path& dir_,
+                                const std::string& key_)
+  {
+    return dir_ / content_hash().add(key_).hex();
+  }
+
+  void age(const boost::filesystem::path& entry_, int seconds_)
+  {
+    boost::filesystem::last_write_time(
+        entry_, boost::filesystem::last_write_time(entry_) - seconds_);
+  }
+}
+
+TEST(eval_cache, empty_cache_has_no_entries)
+{
+  just::temp::directory tmp;
+  eval_cache cache(tmp.path(), 1024);
+
+  ASSERT_FALSE(cache.find("foo"));
+  ASSERT_EQ(0, cache.hits());
+  ASSERT_EQ(1, cache.misses());
+  ASSERT_EQ(0, cache.entries());
+}
+
+TEST(eval_cache, stored_result_is_found)
+{
+  just::temp::directory tmp;
+  eval_cache cache(tmp.path(), 1024);
+
+  const data::result r(false, "out\n", "error\n", "\n\ninfo");
+  cache.store("foo", r);
+  const boost::optional<data::result> found = cache.find("foo");
+
+  ASSERT_TRUE(found);
+  ASSERT_EQ(r.successful, found->successful);
+  ASSERT_EQ(r.output, found->output);
+  ASSERT_EQ(r.error, found->error);
+  ASSERT_EQ(r.info, found->info);
+  ASSERT_EQ(1, cache.hits());
+  ASSERT_EQ(0, cache.misses());
+}
+
+TEST(eval_cache, cache_is_persistent)
+{
+  just::temp::directory tmp;
+  eval_cache(tmp.path(), 1024).store("foo", int_result);
+
+  eval_cache cache(tmp.path(), 1024);
+
+  ASSERT_TRUE(cache.find("foo"));
+  ASSERT_EQ(1, cache.entries());
+}
+
+TEST(eval_cache, directory_is_created)
+{
+  just::temp::directory tmp;
+  eval_cache cache(tmp.path() + "/a/b", 1024);
+
+  cache.store("foo", int_result);
+
+  ASSERT_TRUE(cache.find("foo"));
+}
+
+TEST(eval_cache, corrupted_entry_is_a_miss)
+{
+  just::temp::directory tmp;
+  eval_cache cache(tmp.path(), 1024);
+
+  std::ofstream(entry(tmp.path(), "foo").string())
+      << "metashell eval cache 3\n3\nfoo1\n100\nint";
+
+  ASSERT_FALSE(cache.find("foo"));
+  ASSERT_EQ(1, cache.misses());
+}
+
+TEST(eval_cache, least_recently_used_entry_is_evicted)
+{
+  just::temp::directory tmp;
+  const boost::filesystem::path dir(tmp.path());
+
+  eval_cache(dir, 1024).store("a", int_result);
+  eval_cache(dir, 1024).store("b", int_result);
+  age(entry(dir, "a"), 20);
+  age(entry(dir, "b"), 10);
+
+  eval_cache cache(dir, 1024);
+  const std::uintmax_t entry_size = cache.size() / 2;
+  cache.find("a");
+
+  eval_cache(dir, 2 * entry_size).store("c", int_result);
+
+  ASSERT_TRUE(boost::filesystem::exists(entry(dir, "a")));
+  ASSERT_FALSE(boost::filesystem::exists(entry(dir, "b")));
+  ASSERT_TRUE(boost::filesystem::exists(entry(dir, "c")));
+}
+
+TEST(eval_cache, clearing_the_cache)
+{
+  just::temp::directory tmp;
+  eval_cache cache(tmp.path(), 1024);
+
+  cache.store("foo", int_result);
+  cache.clear();
+
+  ASSERT_EQ(0, cache.entries());
+  ASSERT_EQ(0u, cache.size());
+  ASSERT_FALSE(cache.find("foo"));
+}
+
+TEST(eval_cache, entry_of_another_key_with_the_same_name_is_a_miss)
+{
+  just::temp::directory tmp;
+  const boost::filesystem::path dir(tmp.path());
+  eval_cache cache(dir, 1024);
+
+  // Simulate a hash collision
+  cache.store("foo", int_result);
+  boost::filesystem::rename(entry(dir, "foo"), entry(dir, "bar"));
+
+  ASSERT_FALSE(cache.find("bar"));
+}
+
+TEST(eval_cache, size_of_entry_does_not_depend_on_the_size_of_the_key)
+{
+  just::temp::directory tmp;
+  eval_cache cache(tmp.path(), 1024 * 1024);
+
+  const std::string large_key(100 * 1024, 'x');
+  cache.store(large_key, int_result);
+
+  ASSERT_TRUE(cache.find(large_key));
+  ASSERT_LT(cache.size(), 1024u);
+}
+
+TEST(eval_cache, entry_is_a_miss_after_changing_its_header)
+{
+  just::temp::directory tmp;
+  const boost::filesystem::path dir(tmp.path());
+  const boost::filesystem::path header = dir / "foo.hpp";
+  std::ofstream(header.string()) << "typedef int x;";
+
+  data::include_graph headers;
+  headers.add("", header);
+
+  eval_cache cache(dir / "cache", 1024);
+  cache.store("foo", int_result, headers, file_versions(headers));
+  ASSERT_TRUE(cache.find("foo"));
+
+  std::ofstream(header.string()) << "typedef double x;";
+  ASSERT_FALSE(cache.find("foo"));
+}
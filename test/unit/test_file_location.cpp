@@ -23,7 +23,7 @@ using namespace metashell::data;
 TEST(file_location, empty)
 {
   file_location f;
-  ASSERT_EQ(f.name, "");
+  ASSERT_EQ(f.name.value(), "");
   ASSERT_EQ(f.row, -1);
   ASSERT_EQ(f.column, -1);
 }
@@ -31,7 +31,7 @@ TEST(file_location, empty)
 TEST(file_location, construction)
 {
   file_location f("foo.cpp", 10, 20);
-  ASSERT_EQ(f.name, "foo.cpp");
+  ASSERT_EQ(f.name.value(), "foo.cpp");
   ASSERT_EQ(f.row, 10);
   ASSERT_EQ(f.column, 20);
 }
@@ -68,3 +68,15 @@ TEST(file_location, parsing)
         file_location(filename, 3, 4), file_location::parse(filename + ":3:4"));
   }
 }
+
+TEST(file_location, parsing_interns_the_file_name)
+{
+  string_table names;
+
+  const file_location f1 = file_location::parse("foo.cpp:1:2", names);
+  const file_location f2 = file_location::parse("foo.cpp:3", names);
+
+  ASSERT_EQ(file_location("foo.cpp", 1, 2), f1);
+  ASSERT_EQ(file_location("foo.cpp", 3, 1), f2);
+  ASSERT_TRUE(identical(f1.name, f2.name));
+}
@@ -0,0 +1,60 @@
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <metashell/data/include_graph.hpp>
+
+#include <gtest/gtest.h>
+
+#include <set>
+
+using namespace metashell::data;
+
+using path_set = std::set<boost::filesystem::path>;
+
+TEST(include_graph, empty_graph)
+{
+  const include_graph g;
+
+  ASSERT_EQ(path_set{}, g.headers());
+  ASSERT_EQ(path_set{}, g.included_by(""));
+}
+
+TEST(include_graph, headers_included_directly_and_indirectly)
+{
+  include_graph g;
+  g.add("", "a.hpp");
+  g.add("a.hpp", "b.hpp");
+
+  ASSERT_EQ((path_set{"a.hpp", "b.hpp"}), g.headers());
+  ASSERT_EQ(path_set{"a.hpp"}, g.included_by(""));
+  ASSERT_EQ(path_set{"b.hpp"}, g.included_by("a.hpp"));
+  ASSERT_EQ(path_set{}, g.included_by("b.hpp"));
+}
+
+TEST(include_graph, adding_a_graph)
+{
+  include_graph g1;
+  g1.add("", "a.hpp");
+
+  include_graph g2;
+  g2.add("", "b.hpp");
+  g2.add("b.hpp", "a.hpp");
+
+  g1.add(g2);
+
+  ASSERT_EQ((path_set{"a.hpp", "b.hpp"}), g1.included_by(""));
+  ASSERT_EQ(path_set{"a.hpp"}, g1.included_by("b.hpp"));
+}
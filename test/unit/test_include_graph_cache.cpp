@@ -0,0 +1,166 @@
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <metashell/include_graph_cache.hpp>
+
+#include <gtest/gtest.h>
+
+#include <just/temp.hpp>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace metashell;
+
+namespace
+{
+  // Every "#include <header>" line of the code includes header directly. It
+  // records the processed code.
+  class fake_header_discoverer : public iface::header_discoverer
+  {
+  public:
+    virtual std::vector<boost::filesystem::path>
+    include_path(data::include_type) override
+    {
+      return {};
+    }
+
+    virtual data::include_graph
+    files_included_by(const data::cpp_code& exp_) override
+    {
+      processed.push_back(exp_.value());
+
+      data::include_graph result;
+      std::istringstream s(exp_.value());
+      for (std::string line; std::getline(s, line);)
+      {
+        if (line.size() > 11 && line.compare(0, 10, "#include <") == 0)
+        {
+          result.add("", line.substr(10, line.size() - 11));
+        }
+      }
+      return result;
+    }
+
+    std::vector<std::string> processed;
+  };
+
+  data::cpp_code definitions_of(const data::cpp_code&)
+  {
+    return data::cpp_code("#define A\n");
+  }
+
+  data::include_graph graph(const std::vector<std::string>& headers_)
+  {
+    data::include_graph result;
+    for (const std::string& header : headers_)
+    {
+      result.add("", header);
+    }
+    return result;
+  }
+}
+
+TEST(include_graph_cache, included_headers_are_determined_once)
+{
+  fake_header_discoverer hd;
+  include_graph_cache cache;
+
+  const data::cpp_code code("#include <a.hpp>\n");
+
+  ASSERT_EQ(graph({"a.hpp"}),
+            cache.files_included_by("engine", code, hd, definitions_of));
+  ASSERT_EQ(graph({"a.hpp"}),
+            cache.files_included_by("engine", code, hd, definitions_of));
+  ASSERT_EQ(1u, hd.processed.size());
+}
+
+TEST(include_graph_cache, only_new_code_is_processed_after_extension)
+{
+  fake_header_discoverer hd;
+  include_graph_cache cache;
+
+  const std::string code = "#include <a.hpp>\n";
+  cache.files_included_by("engine", data::cpp_code(code), hd, definitions_of);
+  hd.processed.clear();
+
+  ASSERT_EQ(graph({"a.hpp", "b.hpp"}),
+            cache.files_included_by(
+                "engine", data::cpp_code(code + "#include <b.hpp>\n"), hd,
+                definitions_of));
+  ASSERT_EQ(std::vector<std::string>{"#define A\n#include <b.hpp>\n"},
+            hd.processed);
+}
+
+TEST(include_graph_cache, code_is_processed_entirely_without_definitions)
+{
+  fake_header_discoverer hd;
+  include_graph_cache cache;
+
+  const std::string code = "#include <a.hpp>\n#include <b.hpp>\n";
+  cache.files_included_by(
+      "engine", data::cpp_code("#include <a.hpp>\n"), hd, nullptr);
+  cache.files_included_by("engine", data::cpp_code(code), hd, nullptr);
+
+  ASSERT_EQ(code, hd.processed.back());
+}
+
+TEST(include_graph_cache, included_headers_are_determined_again_after_clear)
+{
+  fake_header_discoverer hd;
+  include_graph_cache cache;
+
+  const data::cpp_code code("#include <a.hpp>\n");
+  cache.files_included_by("engine", code, hd, definitions_of);
+  cache.clear();
+  cache.files_included_by("engine", code, hd, definitions_of);
+
+  ASSERT_EQ(2u, hd.processed.size());
+}
+
+TEST(include_graph_cache, graphs_of_different_engines_are_not_mixed)
+{
+  fake_header_discoverer hd;
+  include_graph_cache cache;
+
+  const data::cpp_code code("#include <a.hpp>\n");
+  cache.files_included_by("engine1", code, hd, definitions_of);
+  cache.files_included_by("engine2", code, hd, definitions_of);
+
+  ASSERT_EQ(2u, hd.processed.size());
+}
+
+TEST(include_graph_cache, included_headers_are_determined_again_after_change)
+{
+  just::temp::directory tmp;
+  const std::string header = tmp.path() + "/a.hpp";
+  std::ofstream(header) << "// empty\n";
+
+  fake_header_discoverer hd;
+  include_graph_cache cache;
+
+  const data::cpp_code code("#include <" + header + ">\n");
+  cache.files_included_by("engine", code, hd, definitions_of);
+
+  // The size of the header changes, therefore the change is noticed even when
+  // the modification time remains the same.
+  std::ofstream(header) << "#include <b.hpp>\n";
+  cache.files_included_by("engine", code, hd, definitions_of);
+
+  ASSERT_EQ(2u, hd.processed.size());
+}
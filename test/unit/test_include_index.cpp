@@ -0,0 +1,184 @@
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <metashell/include_index.hpp>
+
+#include <gtest/gtest.h>
+
+#include <just/temp.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <chrono>
+#include <fstream>
+#include <thread>
+
+using namespace metashell;
+
+namespace
+{
+  typedef include_index::entry_type entry_type;
+
+  void create_file(const boost::filesystem::path& path_)
+  {
+    std::ofstream f(path_.string());
+  }
+
+  boost::filesystem::path
+  create_include_dir(const just::temp::directory& tmp_)
+  {
+    const boost::filesystem::path dir = tmp_.path() + "/include";
+    create_directories(dir / "boost/mpl");
+    create_file(dir / "boost/mpl/int.hpp");
+    create_file(dir / "foo.hpp");
+    return dir;
+  }
+
+  // Changes are noticed asynchronously
+  bool eventually_found(include_index& index_,
+                        const boost::filesystem::path& path_)
+  {
+    const auto until =
+        std::chrono::steady_clock::now() + std::chrono::seconds(30);
+    while (!index_.type(path_))
+    {
+      if (std::chrono::steady_clock::now() > until)
+      {
+        return false;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return true;
+  }
+
+  void test_new_file_is_found(bool use_inotify_)
+  {
+    just::temp::directory tmp;
+    const boost::filesystem::path dir = create_include_dir(tmp);
+
+    include_index index(
+        "", std::chrono::milliseconds(10), use_inotify_, nullptr);
+    index.index({dir});
+    index.wait();
+
+    ASSERT_FALSE(index.type(dir / "boost/mpl/bool.hpp"));
+
+    create_file(dir / "boost/mpl/bool.hpp");
+
+    ASSERT_TRUE(eventually_found(index, dir / "boost/mpl/bool.hpp"));
+  }
+}
+
+TEST(include_index, type_of_indexed_entries)
+{
+  just::temp::directory tmp;
+  const boost::filesystem::path dir = create_include_dir(tmp);
+
+  include_index index("", std::chrono::seconds(1), true, nullptr);
+  index.index({dir});
+  index.wait();
+
+  ASSERT_EQ(entry_type::file, index.type(dir / "boost/mpl/int.hpp"));
+  ASSERT_EQ(entry_type::directory, index.type(dir / "boost/mpl"));
+  ASSERT_EQ(entry_type::directory, index.type(dir / "boost/mpl/"));
+  ASSERT_EQ(entry_type::file, index.type(dir / "boost/./mpl/../../foo.hpp"));
+  ASSERT_FALSE(index.type(dir / "boost/mpl/bool.hpp"));
+  ASSERT_FALSE(index.type(dir / "bar/foo.hpp"));
+}
+
+TEST(include_index, listing_directories)
+{
+  just::temp::directory tmp;
+  const boost::filesystem::path dir = create_include_dir(tmp);
+
+  include_index index("", std::chrono::seconds(1), true, nullptr);
+  index.index({dir});
+  index.wait();
+
+  ASSERT_EQ((include_index::entries{{"boost", entry_type::directory},
+                                    {"foo.hpp", entry_type::file}}),
+            index.list(dir));
+  ASSERT_FALSE(index.list(dir / "foo.hpp"));
+  ASSERT_FALSE(index.list(dir / "bar"));
+}
+
+TEST(include_index, not_indexed_directory_is_listed_when_used)
+{
+  just::temp::directory tmp;
+  const boost::filesystem::path dir = create_include_dir(tmp);
+
+  include_index index("", std::chrono::seconds(1), true, nullptr);
+
+  ASSERT_EQ(entry_type::file, index.type(dir / "boost/mpl/int.hpp"));
+  ASSERT_EQ((include_index::entries{{"int.hpp", entry_type::file}}),
+            index.list(dir / "boost/mpl"));
+}
+
+TEST(include_index, new_file_is_found_using_inotify)
+{
+  test_new_file_is_found(true);
+}
+
+TEST(include_index, new_file_is_found_using_polling)
+{
+  test_new_file_is_found(false);
+}
+
+TEST(include_index, index_is_stored_in_the_cache_dir)
+{
+  just::temp::directory tmp;
+  const boost::filesystem::path dir = create_include_dir(tmp);
+  const boost::filesystem::path cache_dir = tmp.path() + "/cache";
+
+  {
+    include_index index(cache_dir, std::chrono::seconds(1), true, nullptr);
+    index.index({dir});
+    index.wait();
+  }
+
+  ASSERT_FALSE(boost::filesystem::is_empty(cache_dir));
+
+  remove(dir / "foo.hpp");
+
+  include_index index(cache_dir, std::chrono::seconds(1), true, nullptr);
+  index.index({dir});
+  index.wait();
+
+  ASSERT_EQ(entry_type::file, index.type(dir / "boost/mpl/int.hpp"));
+  ASSERT_FALSE(index.type(dir / "foo.hpp"));
+}
+
+TEST(include_index, removed_directories_are_dropped_from_the_stored_index)
+{
+  just::temp::directory tmp;
+  const boost::filesystem::path dir = create_include_dir(tmp);
+  const boost::filesystem::path cache_dir = tmp.path() + "/cache";
+
+  {
+    include_index index(cache_dir, std::chrono::seconds(1), true, nullptr);
+    index.index({dir});
+    index.wait();
+  }
+
+  remove_all(dir / "boost/mpl");
+
+  include_index index(cache_dir, std::chrono::seconds(1), true, nullptr);
+  index.index({dir});
+  index.wait();
+
+  ASSERT_FALSE(index.type(dir / "boost/mpl/int.hpp"));
+  ASSERT_FALSE(index.list(dir / "boost/mpl"));
+}
@@ -0,0 +1,152 @@
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <metashell/includes_cache.hpp>
+
+#include <gtest/gtest.h>
+
+#include <just/temp.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+
+using namespace metashell;
+
+namespace
+{
+  // A script displaying an include path the way clang -v does and counting
+  // how many times it has been run.
+  class fake_clang
+  {
+  public:
+    fake_clang() : _binary(_tmp.path() + "/clang")
+    {
+      std::ofstream f(_binary);
+      f << "echo run >> " << _tmp.path() << "/runs\n"
+        << "echo '#include \"...\" search starts here:' 1>&2\n"
+        << "echo ' /quote' 1>&2\n"
+        << "echo '#include <...> search starts here:' 1>&2\n"
+        << "echo \" /usr/include\" 1>&2\n"
+        << "echo \" $1\" 1>&2\n"
+        << "echo 'End of search list.' 1>&2\n";
+    }
+
+    data::includes includes(const std::string& cache_dir_,
+                            const std::string& internal_dir_,
+                            const std::string& arg_ = "")
+    {
+      return *includes_cache(
+          clang_binary("/bin/sh", {_binary, internal_dir_ + arg_}, nullptr),
+          cache_dir_, internal_dir_);
+    }
+
+    int runs() const
+    {
+      std::ifstream f(_tmp.path() + "/runs");
+      return std::count(std::istreambuf_iterator<char>(f),
+                        std::istreambuf_iterator<char>(), '\n');
+    }
+
+  private:
+    just::temp::directory _tmp;
+    std::string _binary;
+  };
+
+  std::vector<boost::filesystem::path>
+  paths(const std::vector<std::string>& paths_)
+  {
+    return std::vector<boost::filesystem::path>(paths_.begin(), paths_.end());
+  }
+}
+
+TEST(includes_cache, include_path_is_determined_by_running_the_compiler)
+{
+  fake_clang clang;
+  const data::includes includes = clang.includes("", "/internal");
+
+  ASSERT_EQ(paths({"/usr/include", "/internal"}), includes.sys);
+  ASSERT_EQ(paths({"/quote", "/usr/include", "/internal"}), includes.quote);
+  ASSERT_EQ(1, clang.runs());
+}
+
+TEST(includes_cache, stored_include_path_is_used_by_later_processes)
+{
+  just::temp::directory cache;
+  fake_clang clang;
+  clang.includes(cache.path(), "/internal1");
+
+  const data::includes includes = clang.includes(cache.path(), "/internal2");
+
+  ASSERT_EQ(paths({"/usr/include", "/internal2"}), includes.sys);
+  ASSERT_EQ(paths({"/quote", "/usr/include", "/internal2"}), includes.quote);
+  ASSERT_EQ(1, clang.runs());
+}
+
+TEST(includes_cache, path_sharing_a_prefix_with_the_internal_dir_is_kept)
+{
+  just::temp::directory cache;
+  fake_clang clang;
+  // /usr/include starts with /usr/inc, but it is not in it
+  clang.includes(cache.path(), "/usr/inc");
+
+  const data::includes includes = clang.includes(cache.path(), "/internal");
+
+  ASSERT_EQ(paths({"/usr/include", "/internal"}), includes.sys);
+  ASSERT_EQ(1, clang.runs());
+}
+
+TEST(includes_cache, include_path_is_not_shared_between_different_arguments)
+{
+  just::temp::directory cache;
+  fake_clang clang;
+  clang.includes(cache.path(), "/internal", "/a");
+
+  const data::includes includes =
+      clang.includes(cache.path(), "/internal", "/b");
+
+  ASSERT_EQ(paths({"/usr/include", "/internal/b"}), includes.sys);
+  ASSERT_EQ(2, clang.runs());
+}
+
+TEST(includes_cache, corrupt_cache_entry_is_ignored)
+{
+  just::temp::directory cache;
+  fake_clang clang;
+  clang.includes(cache.path(), "/internal");
+
+  for (boost::filesystem::directory_iterator
+           i(boost::filesystem::path(cache.path()) / "includes"),
+       e;
+       i != e; ++i)
+  {
+    std::ofstream f(i->path().string());
+    f << "metashell includes cache 1\n2\na/usr/include\n";
+  }
+
+  const data::includes includes = clang.includes(cache.path(), "/internal");
+
+  ASSERT_EQ(paths({"/usr/include", "/internal"}), includes.sys);
+  ASSERT_EQ(2, clang.runs());
+}
+
+#endif
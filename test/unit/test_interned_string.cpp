@@ -0,0 +1,112 @@
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <metashell/data/interned_string.hpp>
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+using namespace metashell::data;
+
+TEST(interned_string, default_value_is_empty)
+{
+  const interned_string s;
+
+  ASSERT_TRUE(s.empty());
+  ASSERT_EQ("", s.value());
+  ASSERT_EQ(interned_string(""), s);
+}
+
+TEST(interned_string, value_is_stored)
+{
+  ASSERT_EQ("foo<int>", interned_string("foo<int>").value());
+  ASSERT_FALSE(interned_string("foo<int>").empty());
+}
+
+TEST(interned_string, equal_strings_are_stored_once_in_a_table)
+{
+  string_table t;
+  const std::string name = "bar<double>";
+
+  ASSERT_EQ(&t.intern(name).value(), &t.intern("bar<double>").value());
+}
+
+TEST(interned_string, different_tables_store_the_strings_separately)
+{
+  string_table t1;
+  string_table t2;
+
+  const interned_string s1 = t1.intern("foo");
+  const interned_string s2 = t2.intern("foo");
+
+  ASSERT_NE(&s1.value(), &s2.value());
+  ASSERT_EQ(s1, s2);
+}
+
+TEST(interned_string, different_strings_are_not_equal)
+{
+  string_table t;
+
+  ASSERT_NE(t.intern("foo"), t.intern("bar"));
+  ASSERT_NE(t.intern("foo"), t.intern("foo "));
+}
+
+TEST(interned_string, ordering_follows_the_strings)
+{
+  string_table t;
+  const interned_string z = t.intern("zz");
+  const interned_string a = t.intern("aa");
+
+  ASSERT_LT(a, z);
+  ASSERT_FALSE(z < a);
+  ASSERT_FALSE(a < a);
+}
+
+TEST(interned_string, strings_outlive_the_table)
+{
+  interned_string s;
+  {
+    string_table t;
+    s = t.intern("outlives_the_table");
+  }
+
+  ASSERT_EQ("outlives_the_table", s.value());
+}
+
+TEST(interned_string, strings_remain_valid_when_more_are_interned)
+{
+  string_table t;
+  const interned_string first = t.intern("remains_valid");
+  const std::string& value = first.value();
+
+  for (int i = 0; i != 10000; ++i)
+  {
+    t.intern("remains_valid_" + std::to_string(i));
+  }
+
+  ASSERT_EQ(&value, &t.intern("remains_valid").value());
+  ASSERT_EQ("remains_valid", value);
+}
+
+TEST(interned_string, strings_of_a_table_are_equal_only_when_identical)
+{
+  string_table t;
+
+  ASSERT_TRUE(identical(t.intern("foo"), t.intern("foo")));
+  ASSERT_FALSE(identical(t.intern("foo"), t.intern("bar")));
+  ASSERT_FALSE(identical(interned_string("foo"), interned_string("foo")));
+}
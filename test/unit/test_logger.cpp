@@ -25,6 +25,8 @@
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <thread>
+#include <vector>
 
 using namespace metashell;
 using ::testing::NiceMock;
@@ -185,3 +187,29 @@ TEST(logger, log_is_written_to_file)
   l.log_into_file("/tmp/foo.txt");
   l.log("foo");
 }
+
+TEST(logger, messages_from_multiple_threads_are_all_logged)
+{
+  in_memory_displayer d;
+  NiceMock<mock_file_writer> w;
+  logger lg(d, w);
+  lg.log_to_console();
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i != 4; ++i)
+  {
+    threads.emplace_back([&lg] {
+      for (int j = 0; j != 100; ++j)
+      {
+        METASHELL_LOG(&lg, "foo bar");
+      }
+    });
+  }
+  for (std::thread& t : threads)
+  {
+    t.join();
+  }
+
+  ASSERT_EQ(std::vector<data::text>(400, data::text("Log: foo bar")),
+            d.comments());
+}
@@ -0,0 +1,214 @@
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <metashell/empty_environment.hpp>
+#include <metashell/macro_cache.hpp>
+
+#include <gtest/gtest.h>
+
+#include <just/temp.hpp>
+
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace metashell;
+
+namespace
+{
+  // Processes #define and #undef lines and the headers included by
+  // "#include <header>" lines. __P is defined before processing the code. It
+  // records the processed code.
+  class fake_macro_discovery : public iface::macro_discovery
+  {
+  public:
+    virtual data::cpp_code macros(const iface::environment& env_) override
+    {
+      processed.push_back(env_.get_all().value());
+
+      std::map<std::string, std::string> defined{{"__P", "1"}};
+      process(env_.get_all().value(), defined);
+
+      std::string result;
+      for (const auto& d : defined)
+      {
+        result += "#define " + d.first + " " + d.second + "\n";
+      }
+      return data::cpp_code(result);
+    }
+
+    std::vector<std::string> processed;
+
+  private:
+    static void process(const std::string& code_,
+                        std::map<std::string, std::string>& defined_)
+    {
+      std::istringstream s(code_);
+      for (std::string directive, name; s >> directive >> name;)
+      {
+        std::string value;
+        std::getline(s, value);
+        if (directive == "#define")
+        {
+          defined_[name] = value.empty() ? "" : value.substr(1);
+        }
+        else if (directive == "#include")
+        {
+          std::ifstream f(name.substr(1, name.size() - 2));
+          process(std::string(std::istreambuf_iterator<char>(f),
+                              std::istreambuf_iterator<char>()),
+                  defined_);
+        }
+        else
+        {
+          defined_.erase(name);
+        }
+      }
+    }
+  };
+
+  // Every "#include <header>" line of the code includes header directly
+  data::include_graph included_headers(const data::cpp_code& code_)
+  {
+    data::include_graph result;
+    std::istringstream s(code_.value());
+    for (std::string directive, name; s >> directive >> name;)
+    {
+      if (directive == "#include")
+      {
+        result.add("", name.substr(1, name.size() - 2));
+      }
+    }
+    return result;
+  }
+
+  class environment : public empty_environment
+  {
+  public:
+    explicit environment(const std::string& code_)
+      : empty_environment(""), _code(code_)
+    {
+    }
+
+    virtual data::cpp_code get_all() const override { return _code; }
+
+  private:
+    data::cpp_code _code;
+  };
+}
+
+TEST(macro_cache, macros_of_an_environment_are_determined_once)
+{
+  fake_macro_discovery md;
+  macro_cache cache;
+
+  const environment env("#define A 1\n");
+  const data::cpp_code macros =
+      cache.macros("engine", env, md, included_headers);
+
+  ASSERT_EQ(data::cpp_code("#define A 1\n#define __P 1\n"), macros);
+  ASSERT_EQ(macros, cache.macros("engine", env, md, included_headers));
+  ASSERT_EQ(std::vector<std::string>{"#define A 1\n"}, md.processed);
+}
+
+TEST(macro_cache, only_new_code_is_processed_after_extending_the_environment)
+{
+  fake_macro_discovery md;
+  macro_cache cache;
+
+  cache.macros("engine", environment("#define A 1\n"), md, included_headers);
+  md.processed.clear();
+
+  ASSERT_EQ(data::cpp_code("#define A 1\n#define B 2\n#define __P 1\n"),
+            cache.macros("engine", environment("#define A 1\n#define B 2\n"),
+                         md, included_headers));
+  ASSERT_EQ(
+      (std::vector<std::string>{"", "#define A 1\n#define B 2\n"}),
+      md.processed);
+}
+
+TEST(macro_cache, changes_of_predefined_macros_are_kept_after_extension)
+{
+  fake_macro_discovery md;
+  macro_cache cache;
+
+  const std::string env = "#undef __P\n#define A 1\n";
+  cache.macros("engine", environment(env), md, included_headers);
+
+  ASSERT_EQ(data::cpp_code("#define A 1\n#define B 2\n"),
+            cache.macros("engine", environment(env + "#define B 2\n"), md,
+                         included_headers));
+}
+
+TEST(macro_cache, macros_of_different_engines_are_not_mixed)
+{
+  fake_macro_discovery md;
+  macro_cache cache;
+
+  const environment env("#define A 1\n");
+  cache.macros("engine1", env, md, included_headers);
+  cache.macros("engine2", env, md, included_headers);
+
+  ASSERT_EQ(2u, md.processed.size());
+}
+
+TEST(macro_cache, macros_are_determined_again_after_clearing_the_cache)
+{
+  fake_macro_discovery md;
+  macro_cache cache;
+
+  const environment env("#define A 1\n");
+  cache.macros("engine", env, md, included_headers);
+  cache.clear();
+  cache.macros("engine", env, md, included_headers);
+
+  ASSERT_EQ(2u, md.processed.size());
+}
+
+TEST(macro_cache, number_of_remembered_environments_is_limited)
+{
+  fake_macro_discovery md;
+  macro_cache cache(1);
+
+  cache.macros("engine", environment("#define A 1\n"), md, included_headers);
+  cache.macros("engine", environment("#define B 1\n"), md, included_headers);
+  cache.macros("engine", environment("#define A 1\n"), md, included_headers);
+
+  ASSERT_EQ(3u, md.processed.size());
+}
+
+TEST(macro_cache, macros_are_determined_again_after_changing_a_header)
+{
+  just::temp::directory tmp;
+  const std::string header = tmp.path() + "/a.hpp";
+  std::ofstream(header) << "#define A 1\n";
+
+  fake_macro_discovery md;
+  macro_cache cache;
+
+  const environment env("#include <" + header + ">\n");
+  ASSERT_EQ(data::cpp_code("#define A 1\n#define __P 1\n"),
+            cache.macros("engine", env, md, included_headers));
+
+  // The size of the header changes, therefore the change is noticed even when
+  // the modification time remains the same.
+  std::ofstream(header) << "#define A 12\n";
+  ASSERT_EQ(data::cpp_code("#define A 12\n#define __P 1\n"),
+            cache.macros("engine", env, md, included_headers));
+}
@@ -0,0 +1,79 @@
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <metashell/exception.hpp>
+#include <metashell/mapped_file.hpp>
+
+#include <gtest/gtest.h>
+
+#include <just/temp.hpp>
+
+#include <fstream>
+#include <string>
+#include <utility>
+
+using namespace metashell;
+
+namespace
+{
+  std::string write_file(const just::temp::directory& tmp_,
+                         const std::string& content_)
+  {
+    const std::string path = tmp_.path() + "/test.txt";
+    std::ofstream f(path, std::ios_base::out | std::ios_base::binary);
+    f << content_;
+    return path;
+  }
+}
+
+TEST(mapped_file, content_of_the_file_is_mapped)
+{
+  just::temp::directory tmp;
+  const std::string content("hello\0world", 11);
+
+  const mapped_file f(write_file(tmp, content));
+
+  ASSERT_EQ(content.size(), f.size());
+  ASSERT_EQ(content, std::string(f.begin(), f.end()));
+}
+
+TEST(mapped_file, empty_file)
+{
+  just::temp::directory tmp;
+
+  const mapped_file f(write_file(tmp, ""));
+
+  ASSERT_EQ(0u, f.size());
+  ASSERT_EQ(f.begin(), f.end());
+}
+
+TEST(mapped_file, mapping_is_moved)
+{
+  just::temp::directory tmp;
+  mapped_file f1(write_file(tmp, "hello"));
+
+  const mapped_file f2(std::move(f1));
+
+  ASSERT_EQ(0u, f1.size());
+  ASSERT_EQ("hello", std::string(f2.begin(), f2.end()));
+}
+
+TEST(mapped_file, mapping_missing_file_throws)
+{
+  just::temp::directory tmp;
+
+  ASSERT_THROW(mapped_file(tmp.path() + "/missing.txt"), exception);
+}
@@ -48,10 +48,10 @@ namespace
     return std::unique_ptr<counting_event_data_sequence>(
         new counting_event_data_sequence(
             {event_details<event_kind::template_instantiation>{
-                 {type("foo<int>"), loc, loc}, 0},
+                 {interned_string("foo<int>"), loc, loc}, 0},
              event_details<event_kind::template_end>{{}, 10},
              event_details<event_kind::template_instantiation>{
-                 {type("foo<char>"), loc, loc}, 10},
+                 {interned_string("foo<char>"), loc, loc}, 10},
              event_details<event_kind::template_end>{{}, 20},
              event_details<event_kind::evaluation_end>{
                  {type_or_code_or_error(type("int"))}}},
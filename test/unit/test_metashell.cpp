@@ -16,6 +16,7 @@
 
 #include <gtest/gtest.h>
 
+#include <metashell/exception.hpp>
 #include <metashell/metashell.hpp>
 
 using namespace metashell;
@@ -268,3 +269,30 @@ TranslationUnitDecl 0x7febd883d2c0 <<invalid sloc>> <invalid sloc>
 )";
   ASSERT_EQ("int", get_type_from_ast_string(ast));
 }
+
+TEST(metashell, type_from_filtered_ast_string)
+{
+  std::string ast = R"(Dumping __metashell_v:
+VarDecl 0x7febd8881a30 <<stdin>:2:1, col:59> col:59 __metashell_v '::metashell::impl::wrap< ::metashell::format<int>::type>':'struct metashell::impl::wrap<int>' callinit
+`-CXXConstructExpr 0x7febd8881ad8 <col:59> '::metashell::impl::wrap< ::metashell::format<int>::type>':'struct metashell::impl::wrap<int>' 'void (void) noexcept'
+)";
+  ASSERT_EQ("int", get_type_from_ast_string(ast));
+}
+
+TEST(metashell, type_from_ast_string_without_trailing_new_line)
+{
+  std::string ast =
+      "`-CXXConstructExpr 0x7febd8881ad8 <col:59> "
+      "'::metashell::impl::wrap<int>':'metashell::impl::wrap<int>' "
+      "'void () noexcept'";
+  ASSERT_EQ("int", get_type_from_ast_string(ast));
+}
+
+TEST(metashell, type_from_ast_string_without_type)
+{
+  ASSERT_THROW(get_type_from_ast_string(""), exception);
+  ASSERT_THROW(
+      get_type_from_ast_string("Dumping __metashell_v:\nVarDecl 0x7febd8881a30 "
+                               "'metashell::impl::wrap<int>' callinit\n"),
+      exception);
+}
@@ -0,0 +1,120 @@
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <metashell/exception.hpp>
+#include <metashell/named_pipe.hpp>
+
+#include <gtest/gtest.h>
+
+#include <just/temp.hpp>
+
+#include <boost/filesystem/operations.hpp>
+
+#include <array>
+#include <fstream>
+#include <string>
+
+using namespace metashell;
+
+#ifdef _WIN32
+
+TEST(named_pipe, not_supported_on_windows)
+{
+  just::temp::directory tmp;
+
+  ASSERT_THROW(named_pipe(tmp.path() + "/test.pipe"), exception);
+}
+
+#else
+
+namespace
+{
+  std::string read_available(named_pipe& pipe_)
+  {
+    std::array<char, 1024> buff;
+    std::string result;
+    while (const std::size_t len = pipe_.read(buff.data(), buff.size()))
+    {
+      result.append(buff.data(), len);
+    }
+    return result;
+  }
+}
+
+TEST(named_pipe, data_written_into_it_is_read)
+{
+  just::temp::directory tmp;
+  named_pipe pipe(tmp.path() + "/test.pipe");
+
+  std::ofstream f(pipe.path().string(), std::ios_base::binary);
+  f << "hello";
+  f.flush();
+  pipe.wait(1000);
+
+  ASSERT_EQ("hello", read_available(pipe));
+
+  f << " world";
+  f.close();
+  pipe.wait(1000);
+
+  ASSERT_EQ(" world", read_available(pipe));
+}
+
+TEST(named_pipe, reading_does_not_block_without_data)
+{
+  just::temp::directory tmp;
+  named_pipe pipe(tmp.path() + "/test.pipe");
+
+  ASSERT_EQ("", read_available(pipe));
+
+  std::ofstream f(pipe.path().string(), std::ios_base::binary);
+  f.close();
+
+  ASSERT_EQ("", read_available(pipe));
+}
+
+TEST(named_pipe, existing_file_is_replaced)
+{
+  just::temp::directory tmp;
+  const std::string path = tmp.path() + "/test.pipe";
+  std::ofstream(path) << "leftover";
+
+  named_pipe pipe(path);
+
+  ASSERT_EQ("", read_available(pipe));
+}
+
+TEST(named_pipe, pipe_is_removed_by_the_destructor)
+{
+  just::temp::directory tmp;
+  const std::string path = tmp.path() + "/test.pipe";
+
+  {
+    named_pipe pipe(path);
+    ASSERT_TRUE(boost::filesystem::exists(path));
+  }
+
+  ASSERT_FALSE(boost::filesystem::exists(path));
+}
+
+TEST(named_pipe, creating_pipe_in_missing_directory_throws)
+{
+  just::temp::directory tmp;
+
+  ASSERT_THROW(named_pipe(tmp.path() + "/missing/test.pipe"), exception);
+}
+
+#endif
@@ -0,0 +1,87 @@
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <metashell/in_memory_displayer.hpp>
+#include <metashell/metashell_pragma.hpp>
+#include <metashell/pragma_handler.hpp>
+#include <metashell/pragma_limit.hpp>
+
+#include <gtest/gtest.h>
+
+using namespace metashell;
+
+namespace
+{
+  int no_limit() { return 0; }
+}
+
+TEST(pragma_limit, calls_updating_callback)
+{
+  int limit = 0;
+  in_memory_displayer d;
+
+  pragma_limit p(
+      "test", "seconds", no_limit, [&limit](int value_) { limit = value_; });
+  run(p, data::cpp_code("13"), d);
+
+  ASSERT_EQ(13, limit);
+  ASSERT_TRUE(d.errors().empty());
+}
+
+TEST(pragma_limit, displays_the_limit)
+{
+  in_memory_displayer d;
+
+  pragma_limit p("test", "seconds", [] { return 10; }, [](int) {});
+  run(p, data::cpp_code(""), d);
+
+  ASSERT_EQ(std::vector<data::text>{data::text("test limit: 10 seconds")},
+            d.comments());
+}
+
+TEST(pragma_limit, displays_missing_limit)
+{
+  in_memory_displayer d;
+
+  pragma_limit p("test", "seconds", no_limit, [](int) {});
+  run(p, data::cpp_code(""), d);
+
+  ASSERT_EQ(std::vector<data::text>{data::text("test limit: none")},
+            d.comments());
+}
+
+TEST(pragma_limit, displays_error_for_invalid_limit)
+{
+  bool was_called = false;
+  in_memory_displayer d;
+
+  pragma_limit p("test", "seconds", no_limit,
+                 [&was_called](int) { was_called = true; });
+  run(p, data::cpp_code("foo"), d);
+
+  ASSERT_FALSE(was_called);
+  ASSERT_FALSE(d.errors().empty());
+}
+
+TEST(pragma_limit, displays_error_when_extra_arguments_are_given)
+{
+  in_memory_displayer d;
+
+  pragma_limit p("test", "seconds", no_limit, [](int) {});
+  run(p, data::cpp_code("13 foo"), d);
+
+  ASSERT_FALSE(d.errors().empty());
+}
@@ -0,0 +1,177 @@
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <metashell/precompiled_header_builder.hpp>
+#include <metashell/process/cancel.hpp>
+#include <metashell/process/cancelled.hpp>
+
+#include <gtest/gtest.h>
+
+#include <just/temp.hpp>
+
+#include <boost/filesystem/operations.hpp>
+#include <boost/filesystem/path.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace metashell;
+
+TEST(precompiled_header_builder, header_is_included_without_precompiled_header)
+{
+  just::temp::directory tmp;
+  const boost::filesystem::path header =
+      boost::filesystem::path(tmp.path()) / "env.hpp";
+
+  ASSERT_EQ((std::vector<std::string>{"-include", header.string()}),
+            include_precompiled(header));
+}
+
+TEST(precompiled_header_builder, published_precompiled_header_is_included)
+{
+  just::temp::directory tmp;
+  const boost::filesystem::path header =
+      boost::filesystem::path(tmp.path()) / "env.hpp";
+  std::ofstream(precompiled_header_of(header).string()) << "pch";
+
+  ASSERT_EQ((std::vector<std::string>{
+                "-include-pch", precompiled_header_of(header).string()}),
+            include_precompiled(header));
+}
+
+namespace
+{
+  std::string read_file(const boost::filesystem::path& path_)
+  {
+    std::ifstream f(path_.string());
+    return std::string(
+        std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+  }
+
+  // Fails the way creating a hard link on another file system does
+  void failing_link(const boost::filesystem::path&,
+                    const boost::filesystem::path&,
+                    boost::system::error_code& ec_)
+  {
+    ec_ = boost::system::errc::make_error_code(
+        boost::system::errc::cross_device_link);
+  }
+}
+
+TEST(precompiled_header_builder, precompiled_header_is_published)
+{
+  just::temp::directory tmp;
+  const boost::filesystem::path header =
+      boost::filesystem::path(tmp.path()) / "env.hpp";
+  const boost::filesystem::path pch =
+      boost::filesystem::path(tmp.path()) / "chunk.pch";
+  std::ofstream(pch.string()) << "pch";
+
+  publish_precompiled_header(pch, header);
+
+  ASSERT_EQ("pch", read_file(precompiled_header_of(header)));
+  ASSERT_EQ((std::vector<std::string>{
+                "-include-pch", precompiled_header_of(header).string()}),
+            include_precompiled(header));
+}
+
+TEST(precompiled_header_builder,
+     precompiled_header_is_copied_when_it_can_not_be_linked)
+{
+  just::temp::directory tmp;
+  const boost::filesystem::path header =
+      boost::filesystem::path(tmp.path()) / "env.hpp";
+  const boost::filesystem::path pch =
+      boost::filesystem::path(tmp.path()) / "chunk.pch";
+  std::ofstream(pch.string()) << "pch";
+  std::ofstream(precompiled_header_of(header).string()) << "old pch";
+
+  publish_precompiled_header(pch, header, failing_link);
+
+  ASSERT_EQ("pch", read_file(precompiled_header_of(header)));
+  ASSERT_EQ(1u, boost::filesystem::hard_link_count(pch));
+  ASSERT_FALSE(boost::filesystem::exists(
+      precompiled_header_of(header).string() + ".tmp"));
+  ASSERT_EQ((std::vector<std::string>{
+                "-include-pch", precompiled_header_of(header).string()}),
+            include_precompiled(header));
+}
+
+TEST(precompiled_header_builder, failed_copy_publishes_nothing)
+{
+  just::temp::directory tmp;
+  const boost::filesystem::path header =
+      boost::filesystem::path(tmp.path()) / "env.hpp";
+
+  ASSERT_ANY_THROW(publish_precompiled_header(
+      boost::filesystem::path(tmp.path()) / "missing.pch", header,
+      failing_link));
+
+  ASSERT_FALSE(boost::filesystem::exists(precompiled_header_of(header)));
+  ASSERT_FALSE(boost::filesystem::exists(
+      precompiled_header_of(header).string() + ".tmp"));
+  ASSERT_EQ((std::vector<std::string>{"-include", header.string()}),
+            include_precompiled(header));
+}
+
+#ifndef _WIN32
+
+TEST(precompiled_header_builder, cancelled_validation_is_reported)
+{
+  just::temp::directory tmp;
+  const boost::filesystem::path header =
+      boost::filesystem::path(tmp.path()) / "env.hpp";
+
+  // A "compiler" running until it gets killed. The arguments of the
+  // compiler are passed to the script as positional parameters.
+  precompiled_header_builder builder(
+      clang_binary("/bin/sh", {"-c", "sleep 60 & sleep 60; wait", "--"},
+                   nullptr),
+      1024 * 1024, nullptr);
+
+  std::atomic<bool> done(false);
+  std::thread canceller([&done] {
+    while (!done)
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+      process::cancel_running_processes();
+    }
+  });
+
+  bool cancelled = false;
+  try
+  {
+    builder.precompile(header, "typedef int x;\n");
+  }
+  catch (const process::cancelled&)
+  {
+    cancelled = true;
+  }
+  done = true;
+  canceller.join();
+
+  ASSERT_TRUE(cancelled);
+
+  // The builder can still be used
+  builder.wait();
+}
+
+#endif
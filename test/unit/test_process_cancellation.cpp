@@ -0,0 +1,82 @@
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <metashell/process/cancel.hpp>
+#include <metashell/process/cancelled.hpp>
+#include <metashell/process/run.hpp>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <thread>
+
+#ifndef _WIN32
+
+using namespace metashell;
+
+namespace
+{
+  const char shell[] = "/bin/sh";
+
+  // Starts a process sleeping for a long time in the background, keeping
+  // the standard output of the process open.
+  const std::vector<std::string> sleep_in_background{
+      "-c", "sleep 60 & sleep 60; wait"};
+
+  // Keeps cancelling the running processes while f_ is running
+  void cancel_while_running(const std::function<void()>& f_)
+  {
+    std::atomic<bool> done(false);
+    std::thread canceller([&done] {
+      while (!done)
+      {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        process::cancel_running_processes();
+      }
+    });
+
+    try
+    {
+      f_();
+    }
+    catch (...)
+    {
+      done = true;
+      canceller.join();
+      throw;
+    }
+    done = true;
+    canceller.join();
+  }
+}
+
+TEST(process_cancellation, running_process_is_killed)
+{
+  ASSERT_THROW(cancel_while_running(
+                   [] { process::run(shell, sleep_in_background, ""); }),
+               process::cancelled);
+}
+
+TEST(process_cancellation, processes_started_after_cancellation_run)
+{
+  process::cancel_running_processes();
+
+  ASSERT_EQ("foo", process::run(shell, {"-c", "cat"}, "foo").standard_output);
+}
+
+#endif
@@ -0,0 +1,253 @@
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <metashell/process/limit_exceeded.hpp>
+#include <metashell/process/run.hpp>
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+
+#include <signal.h>
+
+#include <cstring>
+
+using namespace metashell;
+
+namespace
+{
+  const char shell[] = "/bin/sh";
+
+  // Starts a process sleeping for a long time in the background, keeping
+  // the standard output of the process open.
+  const std::vector<std::string> sleep_in_background{
+      "-c", "sleep 60 & sleep 60; wait"};
+
+  const std::vector<std::string> busy_loop{"-c", "while :; do :; done"};
+
+  const std::vector<std::string> out_of_memory{
+      "-c", "echo 'LLVM ERROR: out of memory' >&2; exit 1"};
+
+  const std::vector<std::string> abort_after_out_of_memory{
+      "-c", "echo 'LLVM ERROR: out of memory' >&2; kill -ABRT $$"};
+
+  // Keeps about 160 MB in the memory of one of its children before crashing
+  const std::vector<std::string> crash_after_using_memory{
+      "-c",
+      "head -c 160000000 /dev/zero | tail -n 1 > /dev/null; kill -SEGV $$"};
+
+  // Terminates the shell with a signal
+  std::vector<std::string> kill_self(const std::string& signal_)
+  {
+    return {"-c", "kill -" + signal_ + " $$"};
+  }
+
+  // Reports that the compiler started by the driver has been terminated by
+  // sig_ the way clang does.
+  std::vector<std::string> driver_reporting(int sig_)
+  {
+    return {"-c", std::string("echo 'clang: error: unable to execute "
+                              "command: ") +
+                      strsignal(sig_) + "' >&2; exit 1"};
+  }
+
+  data::resource_limits wall_time(int seconds_)
+  {
+    data::resource_limits l;
+    l.wall_time = seconds_;
+    return l;
+  }
+
+  data::resource_limits cpu_time(int seconds_)
+  {
+    data::resource_limits l;
+    l.cpu_time = seconds_;
+    return l;
+  }
+
+  data::resource_limits memory(int megabytes_)
+  {
+    data::resource_limits l;
+    l.memory = megabytes_;
+    return l;
+  }
+
+  template <class F>
+  process::limit exceeded_limit(F f_)
+  {
+    try
+    {
+      f_();
+    }
+    catch (const process::limit_exceeded& e_)
+    {
+      return e_.exceeded();
+    }
+    throw std::runtime_error("No limit has been exceeded");
+  }
+}
+
+TEST(process_limits, process_within_limits_is_not_affected)
+{
+  data::resource_limits limits;
+  limits.wall_time = 60;
+  limits.cpu_time = 60;
+  limits.memory = 1024;
+
+  const data::process_output o =
+      process::run(shell, {"-c", "echo hello"}, "", "", limits);
+
+  ASSERT_EQ(data::exit_code_t(0), o.exit_code);
+  ASSERT_EQ("hello\n", o.standard_output);
+}
+
+TEST(process_limits, process_exceeding_wall_time_is_killed)
+{
+  ASSERT_EQ(process::limit::wall_time, exceeded_limit([] {
+              process::run(shell, sleep_in_background, "", "", wall_time(1));
+            }));
+}
+
+TEST(process_limits, process_exceeding_cpu_time_is_stopped)
+{
+  ASSERT_EQ(process::limit::cpu_time, exceeded_limit([] {
+              process::run(shell, busy_loop, "", "", cpu_time(1));
+            }));
+}
+
+TEST(process_limits, reported_out_of_memory_error_with_memory_limit)
+{
+  ASSERT_EQ(data::exit_code_t(1),
+            process::run(shell, out_of_memory, "", "", memory(1024)).exit_code);
+}
+
+TEST(process_limits, reported_out_of_memory_error_without_memory_limit)
+{
+  ASSERT_EQ(data::exit_code_t(1),
+            process::run(shell, out_of_memory, "").exit_code);
+}
+
+TEST(process_limits, crash_with_generous_memory_limit_is_a_crash)
+{
+  for (const char* sig : {"SEGV", "ABRT"})
+  {
+    const data::process_output o =
+        process::run(shell, kill_self(sig), "", "", memory(1024));
+
+    ASSERT_EQ(data::exit_code_t(-1), o.exit_code);
+  }
+}
+
+TEST(process_limits, crash_after_failed_allocation_with_memory_limit)
+{
+  ASSERT_EQ(process::limit::memory, exceeded_limit([] {
+              process::run(
+                  shell, abort_after_out_of_memory, "", "", memory(1024));
+            }));
+}
+
+TEST(process_limits, crash_close_to_memory_limit)
+{
+  ASSERT_EQ(process::limit::memory, exceeded_limit([] {
+              process::run(
+                  shell, crash_after_using_memory, "", "", memory(256));
+            }));
+}
+
+TEST(process_limits, crash_is_reported)
+{
+  const data::process_output o =
+      process::run(shell, kill_self("SEGV"), "", "", memory(1024));
+
+  ASSERT_EQ(std::string("sh: terminated by signal: ") + strsignal(SIGSEGV) +
+                "\n",
+            o.standard_error);
+}
+
+TEST(process_limits, other_signals_are_not_attributed_to_limits)
+{
+  data::resource_limits limits;
+  limits.cpu_time = 60;
+  limits.memory = 1024;
+
+  ASSERT_EQ(data::exit_code_t(-1),
+            process::run(shell, kill_self("KILL"), "", "", limits).exit_code);
+  ASSERT_EQ(data::exit_code_t(-1),
+            process::run(shell, kill_self("TERM"), "", "", limits).exit_code);
+}
+
+TEST(process_limits, crash_without_memory_limit)
+{
+  ASSERT_EQ(data::exit_code_t(-1),
+            process::run(shell, kill_self("SEGV"), "").exit_code);
+}
+
+TEST(process_limits, crash_reported_by_driver_with_memory_limit)
+{
+  ASSERT_EQ(data::exit_code_t(1),
+            process::run(shell, driver_reporting(SIGABRT), "", "", memory(1024))
+                .exit_code);
+}
+
+TEST(process_limits, failed_allocation_reported_by_driver_with_memory_limit)
+{
+  ASSERT_EQ(process::limit::memory, exceeded_limit([] {
+              process::run(
+                  shell,
+                  {"-c", std::string("echo 'LLVM ERROR: out of memory' >&2; "
+                                     "echo 'clang: error: unable to execute "
+                                     "command: ") +
+                             strsignal(SIGABRT) + "' >&2; exit 1"},
+                  "", "", memory(1024));
+            }));
+}
+
+TEST(process_limits, cpu_time_limit_reported_by_driver)
+{
+  ASSERT_EQ(process::limit::cpu_time, exceeded_limit([] {
+              process::run(shell, driver_reporting(SIGXCPU), "", "",
+                           cpu_time(60));
+            }));
+}
+
+TEST(process_limits, only_the_crash_report_of_the_driver_is_checked)
+{
+  data::resource_limits limits;
+  limits.cpu_time = 60;
+  limits.memory = 1024;
+
+  for (const char* err :
+       {"std::bad_alloc", "Cannot allocate memory", "CPU time limit exceeded",
+        "foo.cpp:1:2: error: unable to execute command: Aborted"})
+  {
+    const std::string cmd = std::string("echo '") + err + "' >&2; exit 1";
+    ASSERT_EQ(data::exit_code_t(1),
+              process::run(shell, {"-c", cmd}, "", "", limits).exit_code);
+  }
+}
+
+TEST(process_limits, message_describes_the_limit)
+{
+  ASSERT_EQ(std::string("Time limit (10 seconds) exceeded"),
+            process::limit_exceeded(process::limit::wall_time, 10).what());
+  ASSERT_EQ(std::string("Memory limit (512 MB) exceeded"),
+            process::limit_exceeded(process::limit::memory, 512).what());
+}
+
+#endif
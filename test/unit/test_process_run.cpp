@@ -0,0 +1,158 @@
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <metashell/process/exception.hpp>
+#include <metashell/process/run.hpp>
+
+#include <gtest/gtest.h>
+
+#include <just/temp.hpp>
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+#ifndef _WIN32
+
+#include <sys/resource.h>
+
+using namespace metashell;
+
+namespace
+{
+  const char shell[] = "/bin/sh";
+
+  // Lets the process open no new file descriptors while it is alive
+  class no_new_file_descriptors
+  {
+  public:
+    no_new_file_descriptors()
+    {
+      getrlimit(RLIMIT_NOFILE, &_original);
+      rlimit none = _original;
+      none.rlim_cur = 0;
+      setrlimit(RLIMIT_NOFILE, &none);
+    }
+
+    ~no_new_file_descriptors() { setrlimit(RLIMIT_NOFILE, &_original); }
+
+  private:
+    rlimit _original;
+  };
+}
+
+TEST(process_run, output_and_exit_code_are_collected)
+{
+  const data::process_output o =
+      process::run(shell, {"-c", "echo out; echo err >&2; exit 3"}, "");
+
+  ASSERT_EQ(data::exit_code_t(3), o.exit_code);
+  ASSERT_EQ("out\n", o.standard_output);
+  ASSERT_EQ("err\n", o.standard_error);
+}
+
+TEST(process_run, large_outputs_on_both_streams_are_collected)
+{
+  const data::process_output o = process::run(
+      shell, {"-c", "head -c 1000000 /dev/zero | tr '\\0' a;"
+                    "head -c 1000000 /dev/zero | tr '\\0' b >&2;"
+                    "head -c 1000000 /dev/zero | tr '\\0' a"},
+      "");
+
+  ASSERT_EQ(std::string(2000000, 'a'), o.standard_output);
+  ASSERT_EQ(std::string(1000000, 'b'), o.standard_error);
+}
+
+TEST(process_run, input_is_passed_to_the_process)
+{
+  ASSERT_EQ("foo", process::run(shell, {"-c", "cat"}, "foo").standard_output);
+}
+
+TEST(process_run, large_input_and_output_are_streamed)
+{
+  // cat writes its output while its input is being written. Writing all the
+  // input first would fill the pipes and block both processes.
+  const std::string input(4 * 1024 * 1024, 'x');
+
+  ASSERT_EQ(input, process::run(shell, {"-c", "cat"}, input).standard_output);
+}
+
+TEST(process_run, process_does_not_have_to_read_its_input)
+{
+  const data::process_output o = process::run(
+      shell, {"-c", "echo done"}, std::string(4 * 1024 * 1024, 'x'));
+
+  ASSERT_EQ(data::exit_code_t(0), o.exit_code);
+  ASSERT_EQ("done\n", o.standard_output);
+}
+
+TEST(process_run, process_is_started_in_the_working_directory)
+{
+  just::temp::directory tmp;
+
+  ASSERT_EQ(tmp.path() + "\n",
+            process::run(shell, {"-c", "pwd -P"}, "", tmp.path())
+                .standard_output);
+}
+
+TEST(process_run, error_is_reported_for_missing_binary)
+{
+  try
+  {
+    process::run("/no/such/binary", {"foo"}, "");
+    FAIL() << "process::exception expected";
+  }
+  catch (const process::exception& e_)
+  {
+    const std::string msg = e_.what();
+    ASSERT_EQ(0u, msg.find("Error running \"/no/such/binary\" foo: "));
+  }
+}
+
+TEST(process_run, error_is_reported_when_no_pipe_can_be_created)
+{
+  no_new_file_descriptors guard;
+
+  ASSERT_THROW(process::run(shell, {"-c", "true"}, ""), process::exception);
+}
+
+TEST(process_run, error_is_reported_for_missing_working_directory)
+{
+  ASSERT_THROW(process::run(shell, {"-c", "true"}, "", "/no/such/directory"),
+               process::exception);
+}
+
+TEST(process_run, process_started_by_another_thread_does_not_delay_the_result)
+{
+  // The long running process is started while the input of the short one is
+  // being written.
+  std::thread other([] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    process::run(shell, {"-c", "sleep 4"}, "");
+  });
+
+  const auto start = std::chrono::steady_clock::now();
+  const data::process_output o =
+      process::run(shell, {"-c", "sleep 1; cat > /dev/null; echo done"},
+                   std::string(1024 * 1024, 'x'));
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+  other.join();
+
+  ASSERT_EQ("done\n", o.standard_output);
+  ASSERT_LT(elapsed, std::chrono::seconds(3));
+}
+
+#endif
@@ -0,0 +1,431 @@
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <metashell/protobuf_reader.hpp>
+
+#include <templight/ThinProtobuf.h>
+
+#include <gtest/gtest.h>
+
+#ifdef METASHELL_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace metashell;
+
+namespace
+{
+  typedef protobuf_reader::chunk chunk;
+
+  std::string header(const std::string& source_name_)
+  {
+    std::ostringstream s;
+    thin_protobuf::saveVarInt(s, 1, 1);
+    thin_protobuf::saveString(s, 2, source_name_);
+    return s.str();
+  }
+
+  std::string location(const std::string& file_name_,
+                       int file_id_,
+                       int line_,
+                       int column_)
+  {
+    std::ostringstream s;
+    if (!file_name_.empty())
+    {
+      thin_protobuf::saveString(s, 1, file_name_);
+    }
+    thin_protobuf::saveVarInt(s, 2, file_id_);
+    thin_protobuf::saveVarInt(s, 3, line_);
+    thin_protobuf::saveVarInt(s, 4, column_);
+    return s.str();
+  }
+
+  std::string name(const std::string& name_)
+  {
+    std::ostringstream s;
+    thin_protobuf::saveString(s, 1, name_);
+    return s.str();
+  }
+
+#ifdef METASHELL_HAVE_ZLIB
+  std::string compressed_name(const std::string& name_)
+  {
+    std::string compressed(compressBound(name_.size()), '\0');
+    uLongf len = compressed.size();
+    compress(reinterpret_cast<Bytef*>(&compressed[0]), &len,
+             reinterpret_cast<const Bytef*>(name_.data()), name_.size());
+    compressed.resize(len);
+
+    std::ostringstream s;
+    thin_protobuf::saveString(s, 2, compressed);
+    return s.str();
+  }
+#endif
+
+  std::string name_from_dictionary(int id_)
+  {
+    std::ostringstream s;
+    thin_protobuf::saveVarInt(s, 3, id_);
+    return s.str();
+  }
+
+  std::string begin_entry(const std::string& name_,
+                          const std::string& location_,
+                          double timestamp_)
+  {
+    std::ostringstream begin;
+    thin_protobuf::saveVarInt(begin, 1, 0);
+    thin_protobuf::saveString(begin, 2, name_);
+    thin_protobuf::saveString(begin, 3, location_);
+    thin_protobuf::saveDouble(begin, 4, timestamp_);
+    thin_protobuf::saveVarInt(begin, 5, 0);
+    thin_protobuf::saveString(begin, 6, location_);
+
+    std::ostringstream entry;
+    thin_protobuf::saveString(entry, 1, begin.str());
+
+    std::ostringstream s;
+    thin_protobuf::saveString(s, 2, entry.str());
+    return s.str();
+  }
+
+  std::string end_entry(double timestamp_)
+  {
+    std::ostringstream end;
+    thin_protobuf::saveDouble(end, 1, timestamp_);
+    thin_protobuf::saveVarInt(end, 2, 0);
+
+    std::ostringstream entry;
+    thin_protobuf::saveString(entry, 2, end.str());
+
+    std::ostringstream s;
+    thin_protobuf::saveString(s, 2, entry.str());
+    return s.str();
+  }
+
+  std::string dictionary_entry(const std::string& marked_name_,
+                               const std::vector<int>& markers_)
+  {
+    std::ostringstream entry;
+    thin_protobuf::saveString(entry, 1, marked_name_);
+    for (int marker : markers_)
+    {
+      thin_protobuf::saveVarInt(entry, 2, marker);
+    }
+
+    std::ostringstream s;
+    thin_protobuf::saveString(s, 3, entry.str());
+    return s.str();
+  }
+
+  std::string trace(const std::string& content_)
+  {
+    std::ostringstream body;
+    thin_protobuf::saveString(body, 1, header("test.cpp"));
+
+    std::ostringstream s;
+    thin_protobuf::saveString(s, 1, body.str() + content_);
+    return s.str();
+  }
+
+  // The way templight -stream-trace writes it
+  std::string grouped_trace(const std::string& content_)
+  {
+    std::ostringstream s;
+    thin_protobuf::saveVarInt(s, (1 << 3) | 3);
+    thin_protobuf::saveString(s, 1, header("test.cpp"));
+    s << content_;
+    thin_protobuf::saveVarInt(s, (1 << 3) | 4);
+    return s.str();
+  }
+
+  // Provides the buffer in pieces of at most piece_size_ bytes
+  protobuf_reader::read_function
+  read_in_pieces(const std::string& buffer_, std::size_t piece_size_)
+  {
+    std::size_t pos = 0;
+    return [&buffer_, piece_size_, pos](char* out_,
+                                        std::size_t size_) mutable {
+      const std::size_t len =
+          std::min({piece_size_, size_, buffer_.size() - pos});
+      std::memcpy(out_, buffer_.data() + pos, len);
+      pos += len;
+      return len;
+    };
+  }
+
+  std::vector<chunk> chunks_of(protobuf_reader& r_)
+  {
+    std::vector<chunk> result;
+    do
+    {
+      result.push_back(r_.next());
+    } while (result.back() != chunk::end_of_file);
+    return result;
+  }
+
+  std::vector<chunk> chunks_of(const std::string& buffer_)
+  {
+    protobuf_reader r(buffer_.data(), buffer_.data() + buffer_.size());
+    return chunks_of(r);
+  }
+
+  std::vector<chunk> chunks_of_stream(const std::string& buffer_,
+                                      std::size_t piece_size_)
+  {
+    protobuf_reader r(read_in_pieces(buffer_, piece_size_));
+    return chunks_of(r);
+  }
+}
+
+TEST(protobuf_reader, empty_buffer)
+{
+  ASSERT_EQ(std::vector<chunk>{chunk::end_of_file}, chunks_of(""));
+}
+
+TEST(protobuf_reader, header)
+{
+  const std::string buffer = trace("");
+  protobuf_reader r(buffer.data(), buffer.data() + buffer.size());
+
+  ASSERT_EQ(chunk::header, r.next());
+  ASSERT_EQ(1u, r.version());
+  ASSERT_EQ("test.cpp", r.source_name());
+  ASSERT_EQ(chunk::end_of_file, r.next());
+  ASSERT_EQ(chunk::end_of_file, r.next());
+}
+
+TEST(protobuf_reader, begin_and_end_entries)
+{
+  const std::string buffer = trace(
+      begin_entry(name("foo<int>"), location("foo.hpp", 0, 11, 13), 1.5) +
+      end_entry(2.5));
+  protobuf_reader r(buffer.data(), buffer.data() + buffer.size());
+
+  ASSERT_EQ(chunk::header, r.next());
+
+  ASSERT_EQ(chunk::begin_entry, r.next());
+  const protobuf_reader::begin_entry& b = r.last_begin_entry();
+  ASSERT_EQ("foo<int>", b.name);
+  ASSERT_EQ("foo.hpp", b.point_of_instantiation.file_name);
+  ASSERT_EQ(11, b.point_of_instantiation.line);
+  ASSERT_EQ(13, b.point_of_instantiation.column);
+  ASSERT_EQ("foo.hpp", b.template_origin.file_name);
+  ASSERT_EQ(1.5, b.timestamp);
+
+  ASSERT_EQ(chunk::end_entry, r.next());
+  ASSERT_EQ(2.5, r.last_end_entry().timestamp);
+
+  ASSERT_EQ(chunk::end_of_file, r.next());
+}
+
+TEST(protobuf_reader, names_are_views_into_the_buffer)
+{
+  const std::string buffer =
+      trace(begin_entry(name("foo<int>"), location("foo.hpp", 0, 1, 1), 0));
+  protobuf_reader r(buffer.data(), buffer.data() + buffer.size());
+
+  r.next();
+  r.next();
+
+  const char* name = r.last_begin_entry().name.data();
+  ASSERT_TRUE(buffer.data() <= name && name < buffer.data() + buffer.size());
+}
+
+TEST(protobuf_reader, file_name_of_file_id_is_remembered)
+{
+  const std::string buffer =
+      trace(begin_entry(name("foo"), location("foo.hpp", 0, 1, 1), 0) +
+            begin_entry(name("bar"), location("", 0, 2, 1), 0));
+  protobuf_reader r(buffer.data(), buffer.data() + buffer.size());
+
+  r.next();
+  r.next();
+  ASSERT_EQ(chunk::begin_entry, r.next());
+  ASSERT_EQ("foo.hpp", r.last_begin_entry().point_of_instantiation.file_name);
+  ASSERT_EQ(2, r.last_begin_entry().point_of_instantiation.line);
+}
+
+TEST(protobuf_reader, names_from_the_dictionary)
+{
+  const std::string buffer =
+      trace(dictionary_entry("foo", {}) + dictionary_entry("int", {}) +
+            dictionary_entry(std::string("ns::\0<\0>", 8), {0, 1}) +
+            begin_entry(name_from_dictionary(2), location("a", 0, 1, 1), 0));
+
+  protobuf_reader r(buffer.data(), buffer.data() + buffer.size());
+
+  ASSERT_EQ(chunk::header, r.next());
+  ASSERT_EQ(chunk::other, r.next());
+  ASSERT_EQ(chunk::other, r.next());
+  ASSERT_EQ(chunk::other, r.next());
+  ASSERT_EQ(chunk::begin_entry, r.next());
+  ASSERT_EQ("ns::foo<int>", r.last_begin_entry().name);
+}
+
+#ifdef METASHELL_HAVE_ZLIB
+TEST(protobuf_reader, compressed_names)
+{
+  const std::string long_name = "foo<" + std::string(5000, 'x') + ">";
+  const std::string loc = location("a", 0, 1, 1);
+  const std::string buffer =
+      trace(begin_entry(compressed_name("foo<int>"), loc, 0) +
+            begin_entry(compressed_name(long_name), loc, 0));
+  protobuf_reader r(buffer.data(), buffer.data() + buffer.size());
+
+  ASSERT_EQ(chunk::header, r.next());
+  ASSERT_EQ(chunk::begin_entry, r.next());
+  ASSERT_EQ("foo<int>", r.last_begin_entry().name);
+  ASSERT_EQ(chunk::begin_entry, r.next());
+  ASSERT_EQ(long_name, r.last_begin_entry().name);
+}
+
+TEST(protobuf_reader, compressed_name_is_decompressed_once)
+{
+  const std::string loc = location("a", 0, 1, 1);
+  const std::string buffer =
+      trace(begin_entry(compressed_name("foo<int>"), loc, 0) +
+            begin_entry(compressed_name("foo<int>"), loc, 0));
+  protobuf_reader r(buffer.data(), buffer.data() + buffer.size());
+
+  r.next();
+  r.next();
+  const char* first = r.last_begin_entry().name.data();
+  r.next();
+
+  ASSERT_EQ(first, r.last_begin_entry().name.data());
+}
+#endif
+
+TEST(protobuf_reader, invalid_compressed_name_is_empty)
+{
+  std::ostringstream invalid;
+  thin_protobuf::saveString(invalid, 2, "not compressed");
+
+  const std::string buffer =
+      trace(begin_entry(invalid.str(), location("a", 0, 1, 1), 0));
+  protobuf_reader r(buffer.data(), buffer.data() + buffer.size());
+
+  r.next();
+  ASSERT_EQ(chunk::begin_entry, r.next());
+  ASSERT_EQ("", r.last_begin_entry().name);
+}
+
+TEST(protobuf_reader, multiple_traces)
+{
+  ASSERT_EQ((std::vector<chunk>{chunk::header, chunk::end_entry,
+                                chunk::header, chunk::end_entry,
+                                chunk::end_of_file}),
+            chunks_of(trace(end_entry(1)) + trace(end_entry(2))));
+}
+
+TEST(protobuf_reader, truncated_trace_ends_at_the_last_complete_chunk)
+{
+  const std::string buffer = trace(end_entry(1) + end_entry(2));
+
+  for (std::string::size_type len = 0; len < buffer.size(); ++len)
+  {
+    const std::vector<chunk> chunks = chunks_of(buffer.substr(0, len));
+    ASSERT_EQ(chunk::end_of_file, chunks.back());
+    ASSERT_LE(chunks.size(), 4u);
+  }
+}
+
+TEST(protobuf_reader, grouped_trace)
+{
+  ASSERT_EQ((std::vector<chunk>{chunk::header, chunk::end_entry,
+                                chunk::header, chunk::end_entry,
+                                chunk::end_of_file}),
+            chunks_of(grouped_trace(end_entry(1)) + trace(end_entry(2))));
+}
+
+TEST(protobuf_reader, truncated_grouped_trace_ends_at_the_last_complete_chunk)
+{
+  const std::string buffer = grouped_trace(end_entry(1) + end_entry(2));
+
+  for (std::string::size_type len = 0; len < buffer.size(); ++len)
+  {
+    const std::vector<chunk> chunks = chunks_of(buffer.substr(0, len));
+    ASSERT_EQ(chunk::end_of_file, chunks.back());
+    ASSERT_LE(chunks.size(), 4u);
+  }
+}
+
+TEST(protobuf_reader, stream_read_in_pieces)
+{
+  const std::string buffer = grouped_trace(
+      dictionary_entry("foo", {}) +
+      begin_entry(name_from_dictionary(0), location("foo.hpp", 0, 1, 1), 0) +
+      end_entry(1));
+
+  const std::vector<chunk> expected{chunk::header, chunk::other,
+                                    chunk::begin_entry, chunk::end_entry,
+                                    chunk::end_of_file};
+
+  for (std::size_t piece_size = 1; piece_size <= buffer.size(); ++piece_size)
+  {
+    ASSERT_EQ(expected, chunks_of_stream(buffer, piece_size));
+  }
+}
+
+TEST(protobuf_reader, names_of_stream_are_valid_till_next_chunk)
+{
+  const std::string buffer = grouped_trace(
+      begin_entry(name("foo<int>"), location("foo.hpp", 0, 1, 1), 0) +
+      begin_entry(name("bar"), location("", 0, 2, 1), 0));
+  protobuf_reader r(read_in_pieces(buffer, 3));
+
+  ASSERT_EQ(chunk::header, r.next());
+  ASSERT_EQ("test.cpp", r.source_name());
+
+  ASSERT_EQ(chunk::begin_entry, r.next());
+  ASSERT_EQ("foo<int>", r.last_begin_entry().name);
+  ASSERT_EQ("foo.hpp", r.last_begin_entry().point_of_instantiation.file_name);
+
+  ASSERT_EQ(chunk::begin_entry, r.next());
+  ASSERT_EQ("bar", r.last_begin_entry().name);
+  ASSERT_EQ("foo.hpp", r.last_begin_entry().point_of_instantiation.file_name);
+}
+
+TEST(protobuf_reader, chunk_of_stream_larger_than_the_buffer)
+{
+  const std::string long_name = "foo<" + std::string(200000, 'x') + ">";
+  const std::string buffer = trace(
+      begin_entry(name(long_name), location("foo.hpp", 0, 1, 1), 0));
+  protobuf_reader r(read_in_pieces(buffer, buffer.size()));
+
+  ASSERT_EQ(chunk::header, r.next());
+  ASSERT_EQ(chunk::begin_entry, r.next());
+  ASSERT_EQ(long_name, r.last_begin_entry().name);
+  ASSERT_EQ(chunk::end_of_file, r.next());
+}
+
+TEST(protobuf_reader, truncated_stream_ends_at_the_last_complete_chunk)
+{
+  const std::string buffer = grouped_trace(end_entry(1) + end_entry(2));
+  const std::string truncated = buffer.substr(0, buffer.size() - 3);
+
+  ASSERT_EQ((std::vector<chunk>{chunk::header, chunk::end_entry,
+                                chunk::end_of_file}),
+            chunks_of_stream(truncated, 1));
+}
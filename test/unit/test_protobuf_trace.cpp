@@ -0,0 +1,232 @@
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <metashell/make_unique.hpp>
+#include <metashell/protobuf_trace.hpp>
+
+#include <templight/ThinProtobuf.h>
+
+#include <gtest/gtest.h>
+
+#include <just/temp.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <fstream>
+#include <future>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+using namespace metashell;
+
+#ifndef _WIN32
+
+namespace
+{
+  std::string trace_begin()
+  {
+    std::ostringstream header;
+    thin_protobuf::saveVarInt(header, 1, 1);
+
+    // The way templight -stream-trace writes it
+    std::ostringstream s;
+    thin_protobuf::saveVarInt(s, (1 << 3) | 3);
+    thin_protobuf::saveString(s, 1, header.str());
+    return s.str();
+  }
+
+  std::string trace_end()
+  {
+    std::ostringstream s;
+    thin_protobuf::saveVarInt(s, (1 << 3) | 4);
+    return s.str();
+  }
+
+  std::string begin_entry(const std::string& name_)
+  {
+    std::ostringstream loc;
+    thin_protobuf::saveString(loc, 1, "foo.hpp");
+    thin_protobuf::saveVarInt(loc, 2, 0);
+    thin_protobuf::saveVarInt(loc, 3, 1);
+    thin_protobuf::saveVarInt(loc, 4, 1);
+
+    std::ostringstream name;
+    thin_protobuf::saveString(name, 1, name_);
+
+    std::ostringstream begin;
+    thin_protobuf::saveVarInt(begin, 1, 0);
+    thin_protobuf::saveString(begin, 2, name.str());
+    thin_protobuf::saveString(begin, 3, loc.str());
+    thin_protobuf::saveDouble(begin, 4, 0);
+
+    std::ostringstream entry;
+    thin_protobuf::saveString(entry, 1, begin.str());
+
+    std::ostringstream s;
+    thin_protobuf::saveString(s, 2, entry.str());
+    return s.str();
+  }
+
+  std::string end_entry()
+  {
+    std::ostringstream end;
+    thin_protobuf::saveDouble(end, 1, 0);
+
+    std::ostringstream entry;
+    thin_protobuf::saveString(entry, 2, end.str());
+
+    std::ostringstream s;
+    thin_protobuf::saveString(s, 2, entry.str());
+    return s.str();
+  }
+
+  data::event_kind kind_of_next(protobuf_trace& trace_)
+  {
+    const boost::optional<data::event_data> event = trace_.next();
+    if (!event)
+    {
+      throw std::runtime_error("Unexpected end of trace");
+    }
+    return data::kind_of(*event);
+  }
+}
+
+TEST(protobuf_trace, events_are_read_while_the_trace_is_being_written)
+{
+  just::temp::directory tmp;
+  std::unique_ptr<named_pipe> pipe =
+      metashell::make_unique<named_pipe>(tmp.path() + "/trace.pbf");
+  const std::string path = pipe->path().string();
+
+  std::promise<void> first_event_read;
+  std::future<void> first_event_read_f = first_event_read.get_future();
+
+  // Plays the role of templight. It finishes the trace only after the first
+  // event has been read from it.
+  std::future<data::type_or_code_or_error> evaluation = std::async(
+      std::launch::async, [path, &first_event_read_f] {
+        std::ofstream f(path, std::ios_base::binary);
+        f << trace_begin() << begin_entry("foo<int>") << std::flush;
+
+        const bool read_in_time =
+            first_event_read_f.wait_for(std::chrono::seconds(10)) ==
+            std::future_status::ready;
+
+        f << end_entry() << trace_end();
+        return read_in_time ?
+                   data::type_or_code_or_error::make_type(data::type("int")) :
+                   data::type_or_code_or_error::make_error("not streamed");
+      });
+
+  protobuf_trace t(std::move(pipe), std::move(evaluation),
+                   data::cpp_code("foo<int>"), data::metaprogram_mode::normal);
+
+  const boost::optional<data::event_data> first = t.next();
+  first_event_read.set_value();
+
+  ASSERT_TRUE(bool(first));
+  ASSERT_EQ(data::event_kind::template_instantiation, data::kind_of(*first));
+  ASSERT_EQ(data::type("foo<int>"), data::type_of(*first));
+
+  ASSERT_EQ(data::event_kind::template_end, kind_of_next(t));
+
+  const boost::optional<data::event_data> last = t.next();
+  ASSERT_TRUE(bool(last));
+  ASSERT_EQ(data::type_or_code_or_error::make_type(data::type("int")),
+            data::result_of(*last));
+
+  ASSERT_FALSE(t.next());
+}
+
+TEST(protobuf_trace, failed_evaluation_without_trace)
+{
+  just::temp::directory tmp;
+
+  protobuf_trace t(
+      metashell::make_unique<named_pipe>(tmp.path() + "/trace.pbf"),
+      std::async(std::launch::async,
+                 [] {
+                   return data::type_or_code_or_error::make_error("error");
+                 }),
+      data::cpp_code("foo<int>"), data::metaprogram_mode::normal);
+
+  const boost::optional<data::event_data> result = t.next();
+  ASSERT_TRUE(bool(result));
+  ASSERT_EQ(data::type_or_code_or_error::make_error("error"),
+            data::result_of(*result));
+  ASSERT_FALSE(t.next());
+}
+
+TEST(protobuf_trace, trace_not_read_till_the_end_does_not_block)
+{
+  // The writer runs in this process. It should get EPIPE instead of
+  // terminating the tests.
+  void (*old_handler)(int) = signal(SIGPIPE, SIG_IGN);
+
+  just::temp::directory tmp;
+  std::unique_ptr<named_pipe> pipe =
+      metashell::make_unique<named_pipe>(tmp.path() + "/trace.pbf");
+  const std::string path = pipe->path().string();
+
+  {
+    protobuf_trace t(
+        std::move(pipe),
+        std::async(std::launch::async,
+                   [path] {
+                     std::ofstream f(path, std::ios_base::binary);
+                     f << trace_begin();
+                     // Much more than the capacity of the pipe
+                     for (int i = 0; i != 100000 && f; ++i)
+                     {
+                       f << begin_entry("foo<int>") << end_entry()
+                         << std::flush;
+                     }
+                     return data::type_or_code_or_error::make_none();
+                   }),
+        data::cpp_code("foo<int>"), data::metaprogram_mode::normal);
+
+    ASSERT_EQ(data::event_kind::template_instantiation, kind_of_next(t));
+  }
+
+  signal(SIGPIPE, old_handler);
+}
+
+TEST(protobuf_trace, destructor_waits_for_the_evaluation)
+{
+  just::temp::directory tmp;
+  std::atomic<bool> finished(false);
+
+  {
+    protobuf_trace t(
+        metashell::make_unique<named_pipe>(tmp.path() + "/trace.pbf"),
+        std::async(std::launch::async,
+                   [&finished] {
+                     std::this_thread::sleep_for(
+                         std::chrono::milliseconds(200));
+                     finished = true;
+                     return data::type_or_code_or_error::make_none();
+                   }),
+        data::cpp_code("foo<int>"), data::metaprogram_mode::normal);
+  }
+
+  ASSERT_TRUE(finished);
+}
+
+#endif
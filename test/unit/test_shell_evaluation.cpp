@@ -0,0 +1,291 @@
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <metashell/code_completer_constant.hpp>
+#include <metashell/cpp_validator_constant.hpp>
+#include <metashell/engine.hpp>
+#include <metashell/header_discoverer_constant.hpp>
+#include <metashell/in_memory_displayer.hpp>
+#include <metashell/macro_discovery_constant.hpp>
+#include <metashell/metaprogram_tracer_constant.hpp>
+#include <metashell/preprocessor_shell_constant.hpp>
+#include <metashell/preprocessor_tracer_constant.hpp>
+#include <metashell/shell.hpp>
+
+#include <gtest/gtest.h>
+
+#include <just/temp.hpp>
+
+#include <boost/filesystem/operations.hpp>
+
+#include "test_config.hpp"
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace metashell;
+
+namespace
+{
+  // Records the evaluated expressions. The evaluation of expressions using
+  // metashell::format succeeds only when both raw_compiles_ and
+  // format_compiles_ are set.
+  class recording_type_shell : public iface::type_shell
+  {
+  public:
+    recording_type_shell(std::shared_ptr<std::vector<std::string>> evaluated_,
+                         bool raw_compiles_,
+                         bool format_compiles_,
+                         std::string cache_key_)
+      : _evaluated(evaluated_),
+        _raw_compiles(raw_compiles_),
+        _format_compiles(format_compiles_),
+        _cache_key(std::move(cache_key_))
+    {
+    }
+
+    virtual data::result eval(const iface::environment&,
+                              const boost::optional<data::cpp_code>& tmp_exp_,
+                              bool) override
+    {
+      const std::string exp = tmp_exp_ ? tmp_exp_->value() : "";
+      _evaluated->push_back(exp);
+
+      const bool formatted = exp.find("::metashell::format<") == 0;
+      if (formatted ? _raw_compiles && _format_compiles : _raw_compiles)
+      {
+        return data::result{true, "int", "", ""};
+      }
+      else
+      {
+        return data::result{
+            false, "", formatted ? "format error" : "raw error", ""};
+      }
+    }
+
+    virtual void generate_precompiled_header(
+        const boost::filesystem::path& fn_) override
+    {
+      _evaluated->push_back("precompile " + fn_.string());
+    }
+
+    virtual std::string cache_key() override { return _cache_key; }
+
+  private:
+    std::shared_ptr<std::vector<std::string>> _evaluated;
+    bool _raw_compiles;
+    bool _format_compiles;
+    std::string _cache_key;
+  };
+
+  std::vector<std::string> evaluate(const std::string& exp_,
+                                    bool raw_compiles_,
+                                    bool format_compiles_,
+                                    in_memory_displayer& displayer_,
+                                    const data::config& config_ = test_config(),
+                                    int* engines_built_ = nullptr,
+                                    const std::string& cache_key_ = "")
+  {
+    const auto evaluated = std::make_shared<std::vector<std::string>>();
+
+    shell sh(config_, "", "env.hpp", "", [&](const data::config&) {
+      if (engines_built_)
+      {
+        ++*engines_built_;
+      }
+
+      const data::result result(false, "", "Not used", "");
+      const std::vector<boost::filesystem::path> empty;
+
+      return make_engine(
+          "recording",
+          recording_type_shell(
+              evaluated, raw_compiles_, format_compiles_, cache_key_),
+          preprocessor_shell_constant(result), code_completer_constant(),
+          header_discoverer_constant(empty, empty),
+          metaprogram_tracer_constant(), cpp_validator_constant(result),
+          macro_discovery_constant(), preprocessor_tracer_constant(),
+          std::vector<data::feature>{data::feature::type_shell(),
+                                     data::feature::preprocessor_shell(),
+                                     data::feature::code_completer(),
+                                     data::feature::header_discoverer(),
+                                     data::feature::metaprogram_tracer(),
+                                     data::feature::cpp_validator(),
+                                     data::feature::macro_discovery(),
+                                     data::feature::preprocessor_tracer()});
+    });
+
+    evaluated->clear();
+    sh.line_available(exp_, displayer_);
+    return *evaluated;
+  }
+}
+
+TEST(shell_evaluation, successful_evaluation_compiles_once)
+{
+  in_memory_displayer d;
+
+  ASSERT_EQ(std::vector<std::string>{"::metashell::format<int>::type"},
+            evaluate("int", true, true, d));
+  ASSERT_TRUE(d.errors().empty());
+  ASSERT_EQ(std::vector<data::type>{data::type("int")}, d.types());
+}
+
+TEST(shell_evaluation, errors_of_the_metaprogram_are_displayed_without_format)
+{
+  in_memory_displayer d;
+
+  ASSERT_EQ(
+      (std::vector<std::string>{"::metashell::format<int>::type", "int"}),
+      evaluate("int", false, false, d));
+  ASSERT_EQ(std::vector<std::string>{"raw error"}, d.errors());
+}
+
+TEST(shell_evaluation, errors_of_format_are_displayed)
+{
+  in_memory_displayer d;
+
+  evaluate("int", true, false, d);
+
+  ASSERT_EQ(std::vector<std::string>{"format error"}, d.errors());
+}
+
+TEST(shell_evaluation, cached_result_is_displayed_without_compilation)
+{
+  just::temp::directory tmp;
+  data::config cfg = test_config();
+  cfg.cache_dir = tmp.path();
+
+  in_memory_displayer d1;
+  ASSERT_EQ(std::vector<std::string>{"::metashell::format<int>::type"},
+            evaluate("int", true, true, d1, cfg));
+
+  in_memory_displayer d2;
+  ASSERT_EQ(std::vector<std::string>{}, evaluate("int", true, true, d2, cfg));
+  ASSERT_EQ(std::vector<data::type>{data::type("int")}, d2.types());
+}
+
+TEST(shell_evaluation, cache_is_not_used_for_different_expressions)
+{
+  just::temp::directory tmp;
+  data::config cfg = test_config();
+  cfg.cache_dir = tmp.path();
+
+  in_memory_displayer d;
+  evaluate("int", true, true, d, cfg);
+
+  ASSERT_EQ(std::vector<std::string>{"::metashell::format<char>::type"},
+            evaluate("char", true, true, d, cfg));
+}
+
+TEST(shell_evaluation, cache_is_not_used_with_different_compiler_arguments)
+{
+  just::temp::directory tmp;
+  data::config cfg = test_config();
+  cfg.cache_dir = tmp.path();
+
+  in_memory_displayer d;
+  evaluate("int", true, true, d, cfg, nullptr, "-std=c++11");
+
+  ASSERT_EQ(std::vector<std::string>{"::metashell::format<int>::type"},
+            evaluate("int", true, true, d, cfg, nullptr, "-std=c++14"));
+}
+
+TEST(shell_evaluation, engine_is_built_once)
+{
+  in_memory_displayer d;
+  int engines_built = 0;
+
+  evaluate("int", true, true, d, test_config(), &engines_built);
+
+  ASSERT_EQ(1, engines_built);
+}
+
+TEST(shell_evaluation, error_building_the_engine_is_reported_by_first_command)
+{
+  shell sh(test_config(), "", "env.hpp", "",
+           [](const data::config&) -> std::unique_ptr<iface::engine> {
+             throw std::runtime_error("Engine not found");
+           });
+
+  in_memory_displayer d;
+  sh.line_available("int", d);
+
+  ASSERT_EQ(std::vector<std::string>{"Error: Engine not found"}, d.errors());
+}
+
+TEST(shell_evaluation, failing_engine_is_built_once)
+{
+  int engines_built = 0;
+  shell sh(test_config(), "", "env.hpp", "",
+           [&engines_built](const data::config&)
+               -> std::unique_ptr<iface::engine> {
+             ++engines_built;
+             throw std::runtime_error("Engine not found");
+           });
+
+  in_memory_displayer d;
+  sh.line_available("int", d);
+  sh.line_available("double", d);
+
+  ASSERT_EQ(1, engines_built);
+  ASSERT_EQ(std::vector<std::string>(2, "Error: Engine not found"), d.errors());
+}
+
+TEST(shell_evaluation, starting_the_shell_does_not_build_anything)
+{
+  just::temp::directory tmp;
+  int engines_built = 0;
+
+  shell sh(test_config(), tmp.path(), "env.hpp", "",
+           [&engines_built](const data::config&)
+               -> std::unique_ptr<iface::engine> {
+             ++engines_built;
+             throw std::runtime_error("Engine not built");
+           });
+
+  ASSERT_EQ(0, engines_built);
+  ASSERT_TRUE(boost::filesystem::is_empty(tmp.path()));
+}
+
+TEST(shell_evaluation, cached_result_is_displayed_without_using_the_engine)
+{
+  just::temp::directory tmp;
+  data::config cfg = test_config();
+  cfg.cache_dir = tmp.path();
+  cfg.active_shell_config().use_precompiled_headers = true;
+
+  in_memory_displayer d1;
+  evaluate("int", true, true, d1, cfg);
+
+  // Neither the precompiled header is generated, nor the type shell is used
+  in_memory_displayer d2;
+  ASSERT_EQ(std::vector<std::string>{}, evaluate("int", true, true, d2, cfg));
+  ASSERT_EQ(std::vector<data::type>{data::type("int")}, d2.types());
+}
+
+TEST(shell_evaluation, precompiled_header_is_generated_by_the_first_command)
+{
+  data::config cfg = test_config();
+  cfg.active_shell_config().use_precompiled_headers = true;
+
+  in_memory_displayer d;
+  ASSERT_EQ((std::vector<std::string>{"precompile env.hpp",
+                                      "::metashell::format<int>::type"}),
+            evaluate("int", true, true, d, cfg));
+}
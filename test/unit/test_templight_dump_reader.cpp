@@ -0,0 +1,150 @@
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <metashell/templight_dump_reader.hpp>
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+using namespace metashell;
+
+namespace
+{
+  std::vector<std::string> names_in(const std::string& dump_)
+  {
+    templight_dump_reader r(dump_.data(), dump_.data() + dump_.size());
+    std::vector<std::string> result;
+    while (r.next())
+    {
+      result.push_back(r.last_entry().name.to_string());
+    }
+    return result;
+  }
+
+  std::string name_in(const std::string& dump_)
+  {
+    const std::vector<std::string> names = names_in(dump_);
+    return names.size() == 1 ? names.front() : "<" + dump_ + ">";
+  }
+}
+
+TEST(templight_dump_reader, empty_buffer)
+{
+  ASSERT_EQ(std::vector<std::string>{}, names_in(""));
+  ASSERT_EQ(std::vector<std::string>{}, names_in("\n\n"));
+}
+
+TEST(templight_dump_reader, entry_displayed_by_clang)
+{
+  const std::string dump = "---\n"
+                           "name:            'foo<int>'\n"
+                           "kind:            TemplateInstantiation\n"
+                           "event:           Begin\n"
+                           "orig:            'foo.hpp:3:8'\n"
+                           "poi:             '<stdin>:11:1'\n";
+  templight_dump_reader r(dump.data(), dump.data() + dump.size());
+
+  ASSERT_TRUE(r.next());
+  const templight_dump_reader::entry& e = r.last_entry();
+  ASSERT_EQ("foo<int>", e.name);
+  ASSERT_EQ("TemplateInstantiation", e.kind);
+  ASSERT_EQ("Begin", e.event);
+  ASSERT_EQ("foo.hpp:3:8", e.orig);
+  ASSERT_EQ("<stdin>:11:1", e.poi);
+
+  ASSERT_FALSE(r.next());
+  ASSERT_FALSE(r.next());
+}
+
+TEST(templight_dump_reader, values_are_views_into_the_buffer)
+{
+  const std::string dump = "---\nname: 'foo<int>'\n";
+  templight_dump_reader r(dump.data(), dump.data() + dump.size());
+
+  ASSERT_TRUE(r.next());
+  const char* name = r.last_entry().name.data();
+  ASSERT_TRUE(dump.data() <= name && name < dump.data() + dump.size());
+}
+
+TEST(templight_dump_reader, multiple_documents)
+{
+  ASSERT_EQ((std::vector<std::string>{"a", "b", "c"}),
+            names_in("---\nname: a\n---\nname: b\n...\n---\nname: c\n"));
+}
+
+TEST(templight_dump_reader, missing_fields_are_empty)
+{
+  const std::string dump = "---\nname: a\nfoo: 'bar'\n";
+  templight_dump_reader r(dump.data(), dump.data() + dump.size());
+
+  ASSERT_TRUE(r.next());
+  ASSERT_EQ("a", r.last_entry().name);
+  ASSERT_EQ("", r.last_entry().kind);
+  ASSERT_EQ("", r.last_entry().poi);
+}
+
+TEST(templight_dump_reader, plain_scalars)
+{
+  ASSERT_EQ("foo", name_in("---\nname: foo\n"));
+  ASSERT_EQ("foo", name_in("---\nname:   foo   \n"));
+  ASSERT_EQ("foo bar", name_in("---\nname: foo\n  bar\n"));
+  ASSERT_EQ("", name_in("---\nname:\n"));
+}
+
+TEST(templight_dump_reader, single_quoted_scalars)
+{
+  ASSERT_EQ("", name_in("---\nname: ''\n"));
+  ASSERT_EQ("a'b", name_in("---\nname: 'a''b'\n"));
+  ASSERT_EQ("'", name_in("---\nname: ''''\n"));
+  ASSERT_EQ("a \"b\"", name_in("---\nname: 'a \"b\"'\n"));
+  ASSERT_EQ("foo<int, char>\nbar",
+            name_in("---\nname: 'foo<int, \n  char>  \n\n  bar'\n"));
+}
+
+TEST(templight_dump_reader, double_quoted_scalars)
+{
+  ASSERT_EQ("a\"b\\c", name_in("---\nname: \"a\\\"b\\\\c\"\n"));
+  ASSERT_EQ("a\tb\nc", name_in("---\nname: \"a\\tb\\nc\"\n"));
+  ASSERT_EQ("\x7f\xc3\xa9\xe2\x82\xac",
+            name_in("---\nname: \"\\x7f\\u00e9\\U000020AC\"\n"));
+  ASSERT_EQ("ab", name_in("---\nname: \"a\\\n   b\"\n"));
+  ASSERT_EQ("a b", name_in("---\nname: \"a\n   b\"\n"));
+}
+
+TEST(templight_dump_reader, fields_after_multi_line_values)
+{
+  const std::string dump = "---\nname: 'a\n  b'\nkind: K\n";
+  templight_dump_reader r(dump.data(), dump.data() + dump.size());
+
+  ASSERT_TRUE(r.next());
+  ASSERT_EQ("a b", r.last_entry().name);
+  ASSERT_EQ("K", r.last_entry().kind);
+}
+
+TEST(templight_dump_reader, windows_line_endings)
+{
+  const std::string dump = "---\r\nname: 'a'\r\nkind: K\r\n---\r\nname: b\r\n";
+  templight_dump_reader r(dump.data(), dump.data() + dump.size());
+
+  ASSERT_TRUE(r.next());
+  ASSERT_EQ("a", r.last_entry().name);
+  ASSERT_EQ("K", r.last_entry().kind);
+  ASSERT_TRUE(r.next());
+  ASSERT_EQ("b", r.last_entry().name);
+  ASSERT_FALSE(r.next());
+}
@@ -0,0 +1,262 @@
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <metashell/empty_environment.hpp>
+#include <metashell/type_shell_cached.hpp>
+
+#include <gtest/gtest.h>
+
+#include <just/temp.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <ctime>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+using namespace metashell;
+
+namespace
+{
+  // Counts the evaluations. The result is successful unless the expression
+  // is "error".
+  class counting_type_shell : public iface::type_shell
+  {
+  public:
+    int evaluations = 0;
+
+    virtual data::result eval(const iface::environment&,
+                              const boost::optional<data::cpp_code>& tmp_exp_,
+                              bool) override
+    {
+      ++evaluations;
+      const bool error = tmp_exp_ && tmp_exp_->value() == "error";
+      return data::result(!error, error ? "" : "int", error ? "error" : "",
+                          "");
+    }
+
+    virtual void generate_precompiled_header(const boost::filesystem::path&)
+        override
+    {
+    }
+
+    virtual std::string cache_key() override { return std::string(); }
+  };
+
+  class environment : public empty_environment
+  {
+  public:
+    explicit environment(const std::string& code_)
+      : empty_environment(""), _code(code_)
+    {
+    }
+
+    virtual data::cpp_code get_all() const override { return _code; }
+
+  private:
+    data::cpp_code _code;
+  };
+
+  data::resource_limits memory_limit(int megabytes_)
+  {
+    data::resource_limits limits;
+    limits.memory = megabytes_;
+    return limits;
+  }
+
+  type_shell_cached::included_headers
+  including(const boost::filesystem::path& header_)
+  {
+    return [header_](const data::cpp_code&) {
+      data::include_graph g;
+      g.add("", header_);
+      return g;
+    };
+  }
+
+  type_shell_cached::included_headers no_headers()
+  {
+    return [](const data::cpp_code&) { return data::include_graph(); };
+  }
+
+  void write(const boost::filesystem::path& path_, const std::string& s_)
+  {
+    std::ofstream(path_.string()) << s_;
+  }
+
+  const boost::optional<data::cpp_code> exp(data::cpp_code("int"));
+  const environment env("");
+}
+
+TEST(type_shell_cached, result_is_evaluated_once)
+{
+  just::temp::directory tmp;
+  eval_cache cache(tmp.path(), 1024 * 1024);
+  counting_type_shell ts;
+  type_shell_cached cached(
+      ts, cache, "engine", data::resource_limits(), no_headers());
+
+  ASSERT_EQ("int", cached.eval(env, exp, false).output);
+  ASSERT_EQ("int", cached.eval(env, exp, false).output);
+
+  ASSERT_EQ(1, ts.evaluations);
+}
+
+TEST(type_shell_cached, errors_are_not_cached)
+{
+  just::temp::directory tmp;
+  eval_cache cache(tmp.path(), 1024 * 1024);
+  counting_type_shell ts;
+  type_shell_cached cached(
+      ts, cache, "engine", data::resource_limits(), no_headers());
+
+  const boost::optional<data::cpp_code> error(data::cpp_code("error"));
+  ASSERT_FALSE(cached.eval(env, error, false).successful);
+  ASSERT_FALSE(cached.eval(env, error, false).successful);
+
+  ASSERT_EQ(2, ts.evaluations);
+}
+
+TEST(type_shell_cached, limits_are_part_of_the_key)
+{
+  just::temp::directory tmp;
+  eval_cache cache(tmp.path(), 1024 * 1024);
+  counting_type_shell ts;
+
+  type_shell_cached(ts, cache, "engine", memory_limit(100), no_headers())
+      .eval(env, exp, false);
+  type_shell_cached(ts, cache, "engine", memory_limit(200), no_headers())
+      .eval(env, exp, false);
+
+  ASSERT_EQ(2, ts.evaluations);
+}
+
+TEST(type_shell_cached, use_of_precompiled_headers_is_part_of_the_key)
+{
+  just::temp::directory tmp;
+  eval_cache cache(tmp.path(), 1024 * 1024);
+  counting_type_shell ts;
+  type_shell_cached cached(
+      ts, cache, "engine", data::resource_limits(), no_headers());
+
+  cached.eval(env, exp, false);
+  cached.eval(env, exp, true);
+
+  ASSERT_EQ(2, ts.evaluations);
+}
+
+TEST(type_shell_cached, changing_an_included_header_invalidates_the_result)
+{
+  just::temp::directory tmp;
+  const boost::filesystem::path dir(tmp.path());
+  const boost::filesystem::path header = dir / "foo.hpp";
+  write(header, "typedef int x;");
+  eval_cache cache(dir / "cache", 1024 * 1024);
+  counting_type_shell ts;
+  type_shell_cached cached(
+      ts, cache, "engine", data::resource_limits(), including(header));
+
+  const environment including_env("#include \"foo.hpp\"\n");
+  cached.eval(including_env, exp, false);
+  cached.eval(including_env, exp, false);
+  ASSERT_EQ(1, ts.evaluations);
+
+  write(header, "typedef double x;");
+  cached.eval(including_env, exp, false);
+  ASSERT_EQ(2, ts.evaluations);
+}
+
+TEST(type_shell_cached, headers_are_not_looked_up_without_include)
+{
+  just::temp::directory tmp;
+  eval_cache cache(tmp.path(), 1024 * 1024);
+  counting_type_shell ts;
+  type_shell_cached cached(
+      ts, cache, "engine", data::resource_limits(),
+      [](const data::cpp_code&) -> data::include_graph {
+        throw std::runtime_error("Headers looked up");
+      });
+
+  ASSERT_EQ("int", cached.eval(environment("typedef int x;"), exp, false)
+                       .output);
+}
+
+TEST(type_shell_cached, headers_are_not_looked_up_on_cache_hit)
+{
+  just::temp::directory tmp;
+  const boost::filesystem::path dir(tmp.path());
+  const boost::filesystem::path header = dir / "foo.hpp";
+  write(header, "typedef int x;");
+  eval_cache cache(dir / "cache", 1024 * 1024);
+  counting_type_shell ts;
+
+  int lookups = 0;
+  type_shell_cached cached(
+      ts, cache, "engine", data::resource_limits(),
+      [&lookups, &header](const data::cpp_code& code_) {
+        ++lookups;
+        return including(header)(code_);
+      });
+
+  const environment including_env("#include \"foo.hpp\"\n");
+  cached.eval(including_env, exp, false);
+  cached.eval(including_env, exp, false);
+
+  ASSERT_EQ(1, ts.evaluations);
+  ASSERT_EQ(1, lookups);
+}
+
+TEST(type_shell_cached, headers_are_not_looked_up_for_errors)
+{
+  just::temp::directory tmp;
+  eval_cache cache(tmp.path(), 1024 * 1024);
+  counting_type_shell ts;
+  type_shell_cached cached(
+      ts, cache, "engine", data::resource_limits(),
+      [](const data::cpp_code&) -> data::include_graph {
+        throw std::runtime_error("Headers looked up");
+      });
+
+  const boost::optional<data::cpp_code> error(data::cpp_code("error"));
+  ASSERT_FALSE(
+      cached.eval(environment("#include \"foo.hpp\"\n"), error, false)
+          .successful);
+}
+
+TEST(type_shell_cached, result_is_not_stored_when_a_header_is_modified)
+{
+  just::temp::directory tmp;
+  const boost::filesystem::path dir(tmp.path());
+  const boost::filesystem::path header = dir / "foo.hpp";
+  write(header, "typedef int x;");
+  eval_cache cache(dir / "cache", 1024 * 1024);
+  counting_type_shell ts;
+
+  // The header is modified after the compiler has been started
+  type_shell_cached cached(
+      ts, cache, "engine", data::resource_limits(),
+      [&header](const data::cpp_code& code_) {
+        boost::filesystem::last_write_time(header, std::time(nullptr) + 10);
+        return including(header)(code_);
+      });
+
+  const environment including_env("#include \"foo.hpp\"\n");
+  cached.eval(including_env, exp, false);
+  cached.eval(including_env, exp, false);
+
+  ASSERT_EQ(2, ts.evaluations);
+}
@@ -0,0 +1,407 @@
+// Metashell - Interactive C++ template metaprogramming shell
+// Copyright (C) 2018, Abel Sinkovics (abel@sinkovics.hu)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <metashell/cpp_validator_clang.hpp>
+#include <metashell/data/config.hpp>
+#include <metashell/header_file_environment.hpp>
+#include <metashell/make_unique.hpp>
+#include <metashell/process/cancel.hpp>
+#include <metashell/type_shell_clang.hpp>
+
+#include <gtest/gtest.h>
+
+#include <just/temp.hpp>
+
+#include <boost/algorithm/string/split.hpp>
+#include <boost/filesystem.hpp>
+
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+
+using namespace metashell;
+
+namespace
+{
+  std::string read_file(const std::string& fn_)
+  {
+    std::ifstream f(fn_);
+    return std::string(
+        std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+  }
+
+  // Builds the precompiled headers of an environment using a script
+  // recording its arguments instead of clang.
+  class pch_builder
+  {
+  public:
+    // The script reports that the code includes the headers in deps_.
+    explicit pch_builder(
+        const std::string& error_ = "",
+        const std::string& delay_ = "0",
+        std::uintmax_t max_cache_size_ =
+            std::numeric_limits<std::uintmax_t>::max(),
+        const std::string& deps_ = "")
+      : _clang(
+            "/bin/sh",
+            {"-c",
+             "echo \"$@\" >> " + log() + "; printf '" + error_ +
+                 "' 1>&2; sleep " + delay_ +
+                 "; while [ $# -gt 0 ]; do "
+                 "case \"$1\" in *.hpp) grep error \"$1\" 1>&2;; esac; "
+                 "if [ \"$1\" = \"-o\" ]; then echo pch > \"$2\"; fi; "
+                 "if [ \"$1\" = \"-MF\" ]; then "
+                 "echo \"pch: " + deps_ + "\" > \"$2\"; fi; "
+                 "shift; done",
+             "clang"},
+            nullptr),
+        _builder(std::make_shared<precompiled_header_builder>(
+            _clang, max_cache_size_, nullptr)),
+        _type_shell(_tmp.path(), "env.hpp", _clang, true, _builder, nullptr)
+    {
+    }
+
+    void start_generating(const std::string& env_)
+    {
+      {
+        std::ofstream f(env());
+        f << env_;
+      }
+      _type_shell.generate_precompiled_header(env());
+    }
+
+    void generate(const std::string& env_)
+    {
+      start_generating(env_);
+      wait();
+    }
+
+    void wait() { _type_shell.wait_for_precompiled_header(); }
+
+    std::vector<std::string> runs() const
+    {
+      std::vector<std::string> result;
+      const std::string content = read_file(log());
+      if (!content.empty())
+      {
+        const std::string lines = content.substr(0, content.size() - 1);
+        boost::algorithm::split(
+            result, lines, [](char c_) { return c_ == '\n'; });
+      }
+      return result;
+    }
+
+    data::result precompile(const std::string& env_)
+    {
+      return _builder->precompile(env(), env_);
+    }
+
+    std::string env() const { return _tmp.path() + "/env.hpp"; }
+
+    // The element of the chain built by a run (without extension)
+    std::string chunk(int run_) const
+    {
+      const std::string run = runs()[run_];
+      const std::string hpp = run.substr(run.rfind(' ') + 1);
+      return hpp.substr(0, hpp.size() - 4);
+    }
+
+    cpp_validator_clang validator()
+    {
+      return cpp_validator_clang(_tmp.path(), "env.hpp", _clang, _builder,
+                                 nullptr);
+    }
+
+    std::unique_ptr<header_file_environment> environment()
+    {
+      data::shell_config cfg;
+      cfg.use_precompiled_headers = true;
+      return metashell::make_unique<header_file_environment>(
+          &_type_shell, cfg, _tmp.path(), "env.hpp");
+    }
+
+  private:
+    just::temp::directory _tmp;
+    clang_binary _clang;
+    std::shared_ptr<precompiled_header_builder> _builder;
+    type_shell_clang _type_shell;
+
+    std::string log() const { return _tmp.path() + "/clang.log"; }
+  };
+}
+
+TEST(type_shell_clang, pch_is_built_from_the_environment)
+{
+  pch_builder b;
+  b.generate("int x;\n");
+
+  const std::string chunk = b.chunk(0);
+  ASSERT_EQ(std::vector<std::string>{"-iquote . -w -MD -MF " + chunk +
+                                     ".d -o " + chunk + ".pch " + chunk +
+                                     ".hpp"},
+            b.runs());
+  ASSERT_EQ(b.env() + ".", chunk.substr(0, b.env().size() + 1));
+  ASSERT_EQ("int x;\n", read_file(chunk + ".hpp"));
+  ASSERT_TRUE(boost::filesystem::exists(b.env() + ".pch"));
+}
+
+TEST(type_shell_clang, extension_of_the_environment_is_precompiled_on_top)
+{
+  pch_builder b;
+  b.generate("int x;\n");
+  b.generate("int x;\nint y;\n");
+
+  const std::string chunk = b.chunk(1);
+  ASSERT_EQ(2u, b.runs().size());
+  ASSERT_EQ("-iquote . -w -include-pch " + b.chunk(0) + ".pch -MD -MF " +
+                chunk + ".d -o " + chunk + ".pch " + chunk + ".hpp",
+            b.runs()[1]);
+  ASSERT_EQ("int y;\n", read_file(chunk + ".hpp"));
+}
+
+TEST(type_shell_clang, changed_environment_is_precompiled_again)
+{
+  pch_builder b;
+  b.generate("int x;\n");
+  b.generate("int y;\n");
+
+  ASSERT_EQ(2u, b.runs().size());
+  ASSERT_EQ(std::string::npos, b.runs()[1].find("-include-pch"));
+  ASSERT_EQ("int y;\n", read_file(b.chunk(1) + ".hpp"));
+}
+
+TEST(type_shell_clang, unchanged_environment_is_not_precompiled_again)
+{
+  pch_builder b;
+  b.generate("int x;\n");
+  b.generate("int x;\n");
+
+  ASSERT_EQ(1u, b.runs().size());
+}
+
+TEST(type_shell_clang, long_chain_is_compacted)
+{
+  pch_builder b;
+  std::string env;
+  for (int i = 0; i != 9; ++i)
+  {
+    env += "int x" + std::to_string(i) + ";\n";
+    b.generate(env);
+  }
+
+  ASSERT_EQ(9u, b.runs().size());
+  ASSERT_NE(std::string::npos, b.runs()[7].find("-include-pch"));
+  ASSERT_EQ(std::string::npos, b.runs()[8].find("-include-pch"));
+  ASSERT_EQ(env, read_file(b.chunk(8) + ".hpp"));
+}
+
+TEST(type_shell_clang, chain_is_rebuilt_after_error)
+{
+  pch_builder b("error");
+  b.generate("int x;\n");
+  b.generate("int x;\nint y;\n");
+
+  ASSERT_EQ(std::string::npos, b.runs()[1].find("-include-pch"));
+  ASSERT_FALSE(boost::filesystem::exists(b.env() + ".pch"));
+}
+
+TEST(type_shell_clang, old_pch_is_not_used_until_the_new_one_is_ready)
+{
+  pch_builder b("", "1");
+  b.generate("int x;\n");
+  ASSERT_TRUE(boost::filesystem::exists(b.env() + ".pch"));
+
+  b.start_generating("int x;\nint y;\n");
+  ASSERT_FALSE(boost::filesystem::exists(b.env() + ".pch"));
+}
+
+TEST(type_shell_clang, cancelled_build_is_started_again)
+{
+  pch_builder b("", "1");
+  b.start_generating("int x;\n");
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  process::cancel_running_processes();
+  b.wait();
+
+  ASSERT_TRUE(boost::filesystem::exists(b.env() + ".pch"));
+}
+
+TEST(type_shell_clang, pch_of_earlier_environment_is_reused)
+{
+  pch_builder b;
+  b.generate("int x;\n");
+  b.generate("int y;\n");
+  b.generate("int x;\n");
+
+  ASSERT_EQ(2u, b.runs().size());
+  ASSERT_EQ("pch\n", read_file(b.env() + ".pch"));
+}
+
+TEST(type_shell_clang, pch_including_unchanged_header_is_reused)
+{
+  just::temp::directory tmp;
+  const std::string header = tmp.path() + "/foo.hpp";
+  std::ofstream(header) << "int z;\n";
+
+  pch_builder b("", "0", std::numeric_limits<std::uintmax_t>::max(), header);
+  b.generate("#include \"foo.hpp\"\nint x;\n");
+  b.generate("int y;\n");
+  b.generate("#include \"foo.hpp\"\nint x;\n");
+
+  ASSERT_EQ(2u, b.runs().size());
+}
+
+TEST(type_shell_clang, pch_including_changed_header_is_rebuilt)
+{
+  just::temp::directory tmp;
+  // The space in the name is escaped in the dependency file
+  const std::string header = tmp.path() + "/foo bar.hpp";
+  std::ofstream(header) << "int z;\n";
+
+  pch_builder b("", "0", std::numeric_limits<std::uintmax_t>::max(),
+                tmp.path() + "/foo\\ bar.hpp");
+  b.generate("#include \"foo bar.hpp\"\nint x;\n");
+  b.generate("int y;\n");
+  std::ofstream(header) << "int z;\nint w;\n";
+  b.generate("#include \"foo bar.hpp\"\nint x;\n");
+
+  ASSERT_EQ(3u, b.runs().size());
+  ASSERT_EQ(std::string::npos, b.runs()[2].find("-include-pch"));
+}
+
+TEST(type_shell_clang, pch_of_earlier_extension_is_reused)
+{
+  pch_builder b;
+  b.generate("int x;\n");
+  b.generate("int x;\nint y;\n");
+  b.generate("int x;\n");
+  b.generate("int x;\nint y;\n");
+  b.generate("int x;\nint y;\nint z;\n");
+
+  ASSERT_EQ(3u, b.runs().size());
+  ASSERT_NE(std::string::npos,
+            b.runs()[2].find("-include-pch " + b.chunk(1) + ".pch"));
+}
+
+TEST(type_shell_clang, earlier_pch_is_reused_without_waiting_for_the_builder)
+{
+  pch_builder b("", "1");
+  b.generate("int x;\n");
+  b.generate("int y;\n");
+
+  b.start_generating("int x;\n");
+  ASSERT_TRUE(boost::filesystem::exists(b.env() + ".pch"));
+}
+
+TEST(type_shell_clang, size_of_kept_pchs_is_limited)
+{
+  pch_builder b("", "0", 0);
+  b.generate("int x;\n");
+  const std::string x = b.chunk(0);
+  b.generate("int y;\n");
+
+  ASSERT_FALSE(boost::filesystem::exists(x + ".pch"));
+  ASSERT_FALSE(boost::filesystem::exists(x + ".hpp"));
+  ASSERT_TRUE(boost::filesystem::exists(b.chunk(1) + ".pch"));
+
+  b.generate("int x;\n");
+  ASSERT_EQ(3u, b.runs().size());
+}
+
+TEST(type_shell_clang, validated_extension_is_precompiled_on_top)
+{
+  pch_builder b;
+  b.generate("int x;\n");
+
+  const data::result r = b.precompile("int x;\nint y;\n");
+
+  const std::string chunk = b.chunk(1);
+  ASSERT_TRUE(r.successful);
+  ASSERT_EQ("-iquote . -include-pch " + b.chunk(0) + ".pch -MD -MF " +
+                chunk + ".d -o " + chunk + ".pch " + chunk + ".hpp",
+            b.runs()[1]);
+  ASSERT_TRUE(boost::filesystem::exists(b.env() + ".pch"));
+
+  b.generate("int x;\nint y;\n");
+  ASSERT_EQ(2u, b.runs().size());
+}
+
+TEST(type_shell_clang, invalid_extension_keeps_the_old_pch)
+{
+  pch_builder b;
+  b.generate("int x;\n");
+
+  const data::result r = b.precompile("int x;\nerror;\n");
+
+  ASSERT_FALSE(r.successful);
+  ASSERT_EQ("error;\n", r.error);
+  ASSERT_TRUE(boost::filesystem::exists(b.env() + ".pch"));
+  ASSERT_FALSE(boost::filesystem::exists(b.chunk(1) + ".hpp"));
+
+  b.generate("int x;\nint y;\n");
+  ASSERT_EQ(3u, b.runs().size());
+  ASSERT_NE(std::string::npos,
+            b.runs()[2].find("-include-pch " + b.chunk(0) + ".pch"));
+}
+
+TEST(type_shell_clang, invalid_replacement_keeps_the_chunks_of_the_old_pch)
+{
+  pch_builder b;
+  b.generate("int x;\n");
+
+  ASSERT_FALSE(b.precompile("error;\n").successful);
+  ASSERT_EQ("int x;\n", read_file(b.chunk(0) + ".hpp"));
+  ASSERT_TRUE(boost::filesystem::exists(b.chunk(0) + ".pch"));
+}
+
+TEST(cpp_validator_clang, declaration_is_validated_and_precompiled_together)
+{
+  pch_builder b;
+  const std::unique_ptr<header_file_environment> env = b.environment();
+  cpp_validator_clang validator = b.validator();
+
+  const data::result r = validator.validate_and_append(
+      data::cpp_code("int x;"), data::config(), *env, true);
+
+  ASSERT_TRUE(r.successful);
+  ASSERT_EQ(data::cpp_code("int x;\n"), env->get_all());
+  ASSERT_EQ(2u, b.runs().size());
+  ASSERT_EQ(std::string::npos, b.runs()[1].find(" -w "));
+}
+
+TEST(cpp_validator_clang, invalid_declaration_is_not_appended)
+{
+  pch_builder b;
+  const std::unique_ptr<header_file_environment> env = b.environment();
+  cpp_validator_clang validator = b.validator();
+
+  const data::result r = validator.validate_and_append(
+      data::cpp_code("error;"), data::config(), *env, true);
+
+  ASSERT_FALSE(r.successful);
+  ASSERT_EQ("error;\n", r.error);
+  ASSERT_EQ(data::cpp_code(), env->get_all());
+  ASSERT_TRUE(boost::filesystem::exists(b.env() + ".pch"));
+}
+
+#endif